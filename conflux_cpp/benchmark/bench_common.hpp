@@ -0,0 +1,131 @@
+/*
+ * Conflux C++ Library - Benchmark Helpers
+ *
+ * Message types and timestamp patterns shared by the benchmarks.
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#ifndef CONFLUX_BENCH_COMMON_HPP
+#define CONFLUX_BENCH_COMMON_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace conflux {
+namespace bench {
+
+/// Minimal stand-in for a ROS message with a header stamp and a payload.
+struct Message {
+    using SharedPtr = std::shared_ptr<Message>;
+    using ConstSharedPtr = std::shared_ptr<const Message>;
+
+    struct {
+        struct {
+            int32_t sec = 0;
+            uint32_t nanosec = 0;
+        } stamp;
+    } header;
+
+    std::vector<uint8_t> payload;
+};
+
+/// A message arrival in a replayed sequence.
+struct Arrival {
+    size_t stream_index;
+    int64_t timestamp_ns;
+};
+
+constexpr int64_t kMillisecond = 1000000;
+
+/// Topic names "/stream_0" .. "/stream_{count - 1}".
+inline std::vector<std::string> topic_names(size_t count) {
+    std::vector<std::string> topics;
+    topics.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        topics.push_back("/stream_" + std::to_string(i));
+    }
+    return topics;
+}
+
+/// All streams at the same rate with a fixed offset per stream.
+inline std::vector<Arrival> uniform_pattern(size_t streams, size_t steps, int64_t period_ns) {
+    std::vector<Arrival> arrivals;
+    arrivals.reserve(streams * steps);
+    for (size_t step = 0; step < steps; ++step) {
+        for (size_t i = 0; i < streams; ++i) {
+            int64_t offset = static_cast<int64_t>(i) * (period_ns / 100);
+            arrivals.push_back({i, static_cast<int64_t>(step) * period_ns + offset});
+        }
+    }
+    return arrivals;
+}
+
+/// All streams at the same rate with uniform jitter, in arrival order.
+inline std::vector<Arrival> jittered_pattern(size_t streams, size_t steps, int64_t period_ns,
+                                             int64_t jitter_ns) {
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int64_t> jitter(-jitter_ns, jitter_ns);
+
+    std::vector<Arrival> arrivals;
+    arrivals.reserve(streams * steps);
+    for (size_t i = 0; i < streams; ++i) {
+        int64_t last = -1;
+        for (size_t step = 0; step < steps; ++step) {
+            int64_t ts = (static_cast<int64_t>(step) + 1) * period_ns + jitter(rng);
+            // Keep each stream strictly increasing
+            ts = std::max(ts, last + 1);
+            arrivals.push_back({i, ts});
+            last = ts;
+        }
+    }
+    std::stable_sort(arrivals.begin(), arrivals.end(), [](const Arrival& a, const Arrival& b) {
+        return a.timestamp_ns < b.timestamp_ns;
+    });
+    return arrivals;
+}
+
+/// Camera at 30 Hz (+/-2 ms), lidar at 10 Hz (+/-5 ms) and GPS at 1 Hz
+/// (+/-10 ms), matching the sensor simulation in the core's realistic
+/// timing tests.
+inline std::vector<Arrival> realistic_pattern(int64_t duration_ns) {
+    struct Sensor {
+        int64_t period_ns;
+        int64_t jitter_ns;
+    };
+    const Sensor sensors[] = {
+        {33330000, 2 * kMillisecond},
+        {100 * kMillisecond, 5 * kMillisecond},
+        {1000 * kMillisecond, 10 * kMillisecond},
+    };
+
+    std::mt19937_64 rng(42);
+    std::vector<Arrival> arrivals;
+    for (size_t i = 0; i < 3; ++i) {
+        std::uniform_int_distribution<int64_t> jitter(-sensors[i].jitter_ns, sensors[i].jitter_ns);
+        int64_t last = -1;
+        for (int64_t t = sensors[i].jitter_ns; t < duration_ns; t += sensors[i].period_ns) {
+            int64_t ts = std::max(t + jitter(rng), last + 1);
+            arrivals.push_back({i, ts});
+            last = ts;
+        }
+    }
+    std::stable_sort(arrivals.begin(), arrivals.end(), [](const Arrival& a, const Arrival& b) {
+        return a.timestamp_ns < b.timestamp_ns;
+    });
+    return arrivals;
+}
+
+/// Time covered by a pattern, used to shift it when replaying it again.
+inline int64_t pattern_span(const std::vector<Arrival>& arrivals) {
+    return arrivals.empty() ? 0 : arrivals.back().timestamp_ns + kMillisecond;
+}
+
+}  // namespace bench
+}  // namespace conflux
+
+#endif  // CONFLUX_BENCH_COMMON_HPP
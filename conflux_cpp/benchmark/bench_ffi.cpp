@@ -0,0 +1,134 @@
+/*
+ * Conflux C++ Library - FFI Benchmarks
+ *
+ * Throughput of the raw C API, without the C++ wrapper's payload storage.
+ * Comparing against the synchronizer benchmarks separates the cost of the
+ * Rust core from the cost of the wrapper.
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#include "bench_common.hpp"
+
+#include "conflux_ffi.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+using conflux::bench::kMillisecond;
+
+constexpr int64_t kPeriodNs = 10 * kMillisecond;
+
+/// Owns a raw synchronizer over `streams` generated topic names.
+class RawSynchronizer {
+public:
+    explicit RawSynchronizer(size_t streams) : topics_(conflux::bench::topic_names(streams)) {
+        std::vector<const char*> keys;
+        for (const auto& topic : topics_) {
+            keys.push_back(topic.c_str());
+        }
+
+        ConfluxConfig config{};
+        config.window_size_ms = 50;
+        config.buffer_size = 64;
+        config.drop_policy = ConfluxDropPolicy_RejectNew;
+        config.staleness = ConfluxStalenessPreset_Disabled;
+        sync_ = conflux_synchronizer_new(&config, keys.data(), keys.size());
+    }
+
+    ~RawSynchronizer() { conflux_synchronizer_free(sync_); }
+
+    RawSynchronizer(const RawSynchronizer&) = delete;
+    RawSynchronizer& operator=(const RawSynchronizer&) = delete;
+
+    ConfluxSynchronizer* get() const { return sync_; }
+    const std::vector<std::string>& topics() const { return topics_; }
+
+private:
+    std::vector<std::string> topics_;
+    ConfluxSynchronizer* sync_ = nullptr;
+};
+
+void count_member(const char*, int64_t, void* user_data, void* context) {
+    benchmark::DoNotOptimize(user_data);
+    ++*static_cast<size_t*>(context);
+}
+
+void count_indexed_member(uintptr_t, int64_t, void* user_data, void* context) {
+    benchmark::DoNotOptimize(user_data);
+    ++*static_cast<size_t*>(context);
+}
+
+}  // namespace
+
+/// Push by key name and poll with key names, as the original API did.
+static void BM_FfiPushPollByName(benchmark::State& state) {
+    size_t streams = static_cast<size_t>(state.range(0));
+    RawSynchronizer sync(streams);
+
+    size_t members = 0;
+    int64_t ts = 0;
+    for (auto _ : state) {
+        ts += kPeriodNs;
+        for (size_t i = 0; i < streams; ++i) {
+            conflux_push_message(sync.get(), sync.topics()[i].c_str(), ts, nullptr);
+        }
+        while (conflux_poll(sync.get(), count_member, &members) == 1) {
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(streams));
+}
+BENCHMARK(BM_FfiPushPollByName)->RangeMultiplier(2)->Range(2, 32);
+
+/// Push and poll by stream index, skipping the key lookups.
+static void BM_FfiPushPollByIndex(benchmark::State& state) {
+    size_t streams = static_cast<size_t>(state.range(0));
+    RawSynchronizer sync(streams);
+
+    size_t members = 0;
+    int64_t ts = 0;
+    for (auto _ : state) {
+        ts += kPeriodNs;
+        for (size_t i = 0; i < streams; ++i) {
+            conflux_push_message_by_index(sync.get(), i, ts, nullptr);
+        }
+        while (conflux_poll_indexed(sync.get(), count_indexed_member, &members) == 1) {
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(streams));
+}
+BENCHMARK(BM_FfiPushPollByIndex)->RangeMultiplier(2)->Range(2, 32);
+
+/// Push by stream index and fetch groups with one batched poll.
+static void BM_FfiPushPollBatch(benchmark::State& state) {
+    constexpr size_t kMaxGroups = 64;
+    size_t streams = static_cast<size_t>(state.range(0));
+    RawSynchronizer sync(streams);
+    std::vector<ConfluxGroupMember> batch(kMaxGroups * streams);
+
+    size_t groups = 0;
+    int64_t ts = 0;
+    for (auto _ : state) {
+        // Buffer several groups so each poll returns more than one
+        for (size_t step = 0; step < 16; ++step) {
+            ts += kPeriodNs;
+            for (size_t i = 0; i < streams; ++i) {
+                conflux_push_message_by_index(sync.get(), i, ts, nullptr);
+            }
+        }
+        intptr_t count = conflux_poll_batch(sync.get(), batch.data(), kMaxGroups);
+        benchmark::DoNotOptimize(batch.data());
+        groups += static_cast<size_t>(count > 0 ? count : 0);
+    }
+
+    state.SetItemsProcessed(state.iterations() * 16 * static_cast<int64_t>(streams));
+    state.counters["groups"] = benchmark::Counter(static_cast<double>(groups),
+                                                  benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_FfiPushPollBatch)->RangeMultiplier(2)->Range(2, 32);
@@ -0,0 +1,230 @@
+/*
+ * Conflux C++ Library - Synchronizer Benchmarks
+ *
+ * Throughput of the C++ wrappers: push, matching and group delivery.
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#include "bench_common.hpp"
+
+#include "conflux/synchronizer.hpp"
+#include "conflux/typed_synchronizer.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+namespace {
+
+using conflux::bench::Arrival;
+using conflux::bench::kMillisecond;
+using conflux::bench::Message;
+
+constexpr int64_t kPeriodNs = 10 * kMillisecond;
+
+std::unique_ptr<conflux::Synchronizer> make_synchronizer(size_t streams,
+                                                         conflux::Config config,
+                                                         size_t* groups) {
+    auto sync = std::make_unique<conflux::Synchronizer>(config);
+    for (const auto& topic : conflux::bench::topic_names(streams)) {
+        sync->add_topic(topic);
+    }
+    sync->on_synchronized([groups](const conflux::SyncGroup& group) {
+        benchmark::DoNotOptimize(group.size());
+        ++*groups;
+    });
+    return sync;
+}
+
+/// Replay an arrival pattern repeatedly, one message per iteration.
+void replay(benchmark::State& state, const std::vector<Arrival>& arrivals, size_t streams) {
+    conflux::Config config;
+    config.eager_dispatch = true;
+
+    size_t groups = 0;
+    auto sync = make_synchronizer(streams, config, &groups);
+    auto message = std::make_shared<const Message>();
+
+    int64_t span = conflux::bench::pattern_span(arrivals);
+    int64_t base = 0;
+    size_t next = 0;
+    for (auto _ : state) {
+        const Arrival& arrival = arrivals[next];
+        sync->push_message(arrival.stream_index, base + arrival.timestamp_ns, std::any(message));
+        if (++next == arrivals.size()) {
+            next = 0;
+            base += span;
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["groups"] = benchmark::Counter(static_cast<double>(groups),
+                                                  benchmark::Counter::kIsRate);
+}
+
+}  // namespace
+
+/// Push one message per stream, then dispatch the completed group.
+static void BM_SynchronizerPushPoll(benchmark::State& state) {
+    size_t streams = static_cast<size_t>(state.range(0));
+
+    size_t groups = 0;
+    auto sync = make_synchronizer(streams, conflux::Config(), &groups);
+    auto message = std::make_shared<const Message>();
+
+    int64_t ts = 0;
+    for (auto _ : state) {
+        ts += kPeriodNs;
+        for (size_t i = 0; i < streams; ++i) {
+            sync->push_message(i, ts + static_cast<int64_t>(i), std::any(message));
+        }
+        sync->spin_once();
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(streams));
+    state.counters["groups"] = benchmark::Counter(static_cast<double>(groups),
+                                                  benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_SynchronizerPushPoll)->RangeMultiplier(2)->Range(2, 32);
+
+/// Same as BM_SynchronizerPushPoll, with groups matched on every push.
+static void BM_SynchronizerEagerPush(benchmark::State& state) {
+    size_t streams = static_cast<size_t>(state.range(0));
+    replay(state, conflux::bench::uniform_pattern(streams, 1024, kPeriodNs), streams);
+}
+BENCHMARK(BM_SynchronizerEagerPush)->RangeMultiplier(2)->Range(2, 32);
+
+/// Streams at the same rate with +/-2 ms of jitter.
+static void BM_SynchronizerJittered(benchmark::State& state) {
+    size_t streams = static_cast<size_t>(state.range(0));
+    replay(state, conflux::bench::jittered_pattern(streams, 1024, kPeriodNs, 2 * kMillisecond),
+           streams);
+}
+BENCHMARK(BM_SynchronizerJittered)->RangeMultiplier(2)->Range(2, 32);
+
+/// Camera, lidar and GPS at their native rates with jitter.
+static void BM_SynchronizerRealistic(benchmark::State& state) {
+    replay(state, conflux::bench::realistic_pattern(60000 * kMillisecond), 3);
+}
+BENCHMARK(BM_SynchronizerRealistic);
+
+/// Payload size should not matter: messages are held by shared pointer.
+static void BM_SynchronizerPayload(benchmark::State& state) {
+    constexpr size_t kStreams = 2;
+
+    size_t groups = 0;
+    auto sync = make_synchronizer(kStreams, conflux::Config(), &groups);
+    auto payload = std::make_shared<Message>();
+    payload->payload.resize(static_cast<size_t>(state.range(0)));
+    std::shared_ptr<const Message> message = payload;
+
+    int64_t ts = 0;
+    for (auto _ : state) {
+        ts += kPeriodNs;
+        for (size_t i = 0; i < kStreams; ++i) {
+            sync->push_message(i, ts, std::any(message));
+        }
+        sync->spin_once();
+    }
+
+    state.SetItemsProcessed(state.iterations() * kStreams);
+}
+BENCHMARK(BM_SynchronizerPayload)->Arg(0)->Arg(1 << 10)->Arg(64 << 10)->Arg(1 << 20)->Arg(8 << 20);
+
+/// Drain a backlog of ready groups, as when replaying a bag offline.
+static void BM_SynchronizerDrainBacklog(benchmark::State& state) {
+    constexpr size_t kStreams = 4;
+    constexpr size_t kBacklog = 1024;
+    size_t batch = static_cast<size_t>(state.range(0));
+
+    conflux::Config config;
+    config.buffer_size = kBacklog + 2;
+
+    size_t groups = 0;
+    auto sync = make_synchronizer(kStreams, config, &groups);
+    auto message = std::make_shared<const Message>();
+
+    int64_t ts = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (size_t step = 0; step < kBacklog; ++step) {
+            ts += kPeriodNs;
+            for (size_t i = 0; i < kStreams; ++i) {
+                sync->push_message(i, ts, std::any(message));
+            }
+        }
+        state.ResumeTiming();
+
+        while (sync->spin_some(batch) > 0) {
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(groups));
+}
+BENCHMARK(BM_SynchronizerDrainBacklog)->Arg(1)->Arg(16)->Arg(256);
+
+/// Compile-time typed front end over the same core.
+static void BM_TypedSynchronizerPushPoll(benchmark::State& state) {
+    using Typed = conflux::TypedSynchronizer<Message, Message, Message, Message>;
+
+    Typed sync({"/stream_0", "/stream_1", "/stream_2", "/stream_3"});
+    size_t groups = 0;
+    sync.on_synchronized([&groups](const Message& a, const Message& b, const Message& c,
+                                   const Message& d) {
+        benchmark::DoNotOptimize(&a);
+        benchmark::DoNotOptimize(&b);
+        benchmark::DoNotOptimize(&c);
+        benchmark::DoNotOptimize(&d);
+        ++groups;
+    });
+    auto message = std::make_shared<const Message>();
+
+    int64_t ts = 0;
+    for (auto _ : state) {
+        ts += kPeriodNs;
+        sync.push<0>(ts, message);
+        sync.push<1>(ts + 1, message);
+        sync.push<2>(ts + 2, message);
+        sync.push<3>(ts + 3, message);
+        sync.spin_once();
+    }
+
+    state.SetItemsProcessed(state.iterations() * 4);
+}
+BENCHMARK(BM_TypedSynchronizerPushPoll);
+
+namespace {
+
+std::unique_ptr<conflux::Synchronizer> mt_sync;
+size_t mt_groups = 0;
+
+}  // namespace
+
+/// Each thread pushes to its own stream; whichever push finds the matcher
+/// idle drains all streams and delivers the groups.
+static void BM_SynchronizerMultiThreadPush(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        conflux::Config config;
+        config.eager_dispatch = true;
+        config.drop_policy = conflux::DropPolicy::DropOldest;
+
+        mt_groups = 0;
+        mt_sync = make_synchronizer(static_cast<size_t>(state.threads()), config, &mt_groups);
+    }
+
+    auto message = std::make_shared<const Message>();
+    size_t stream = static_cast<size_t>(state.thread_index());
+    int64_t ts = 0;
+    for (auto _ : state) {
+        ts += kPeriodNs;
+        mt_sync->push_message(stream, ts, std::any(message));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        mt_sync.reset();
+    }
+}
+BENCHMARK(BM_SynchronizerMultiThreadPush)->ThreadRange(2, 8)->UseRealTime();
@@ -18,21 +18,25 @@
 class SyncProcessorNode : public rclcpp::Node {
 public:
     SyncProcessorNode() : Node("sync_processor") {
-        // Configure synchronizer with 50ms window
+        // Configure synchronizer with 50ms window. Groups are dispatched
+        // as soon as their last member arrives, so no polling timer is needed.
         conflux::Config config;
         config.window_size = std::chrono::milliseconds(50);
         config.buffer_size = 64;
+        config.eager_dispatch = true;
 
         sync_ = std::make_unique<conflux::Synchronizer>(config);
 
-        // Add topics to synchronize
-        sync_->add_subscription<sensor_msgs::msg::Image>(shared_from_this(), "/camera/image");
-        sync_->add_subscription<sensor_msgs::msg::PointCloud2>(shared_from_this(), "/lidar/points");
+        // Add topics to synchronize, keeping their stream indices
+        image_index_ = sync_->add_subscription<sensor_msgs::msg::Image>(shared_from_this(),
+                                                                         "/camera/image");
+        points_index_ = sync_->add_subscription<sensor_msgs::msg::PointCloud2>(shared_from_this(),
+                                                                               "/lidar/points");
 
         // Register callback for synchronized groups
         sync_->on_synchronized([this](const conflux::SyncGroup& group) {
-            auto image = group.get<sensor_msgs::msg::Image>("/camera/image");
-            auto points = group.get<sensor_msgs::msg::PointCloud2>("/lidar/points");
+            auto image = group.get<sensor_msgs::msg::Image>(image_index_);
+            auto points = group.get<sensor_msgs::msg::PointCloud2>(points_index_);
 
             if (image && points) {
                 RCLCPP_INFO(this->get_logger(), "Synchronized: image=%d.%09u, points=%d.%09u",
@@ -42,9 +46,6 @@ public:
                 process(image, points);
             }
         });
-
-        // Create timer to poll for synchronized groups
-        timer_ = create_wall_timer(std::chrono::milliseconds(10), [this]() { sync_->spin_once(); });
     }
 
 private:
@@ -56,7 +57,8 @@ private:
     }
 
     std::unique_ptr<conflux::Synchronizer> sync_;
-    rclcpp::TimerBase::SharedPtr timer_;
+    size_t image_index_ = 0;
+    size_t points_index_ = 0;
 };
 
 int main(int argc, char** argv) {
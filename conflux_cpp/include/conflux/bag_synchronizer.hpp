@@ -0,0 +1,152 @@
+/*
+ * Conflux C++ Library - Bag Synchronizer
+ *
+ * Synchronizes messages read from a rosbag2 bag while they are still
+ * serialized. Built into the conflux_cpp_bag library when rosbag2_cpp is
+ * available.
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#ifndef CONFLUX_BAG_SYNCHRONIZER_HPP
+#define CONFLUX_BAG_SYNCHRONIZER_HPP
+
+#include "conflux/stats.hpp"
+#include "conflux/types.hpp"
+#include "conflux/visibility.h"
+
+#include "rmw/rmw.h"
+#include "rosbag2_storage/serialized_bag_message.hpp"
+#include "rosbag2_storage/storage_options.hpp"
+#include "rosidl_typesupport_cpp/message_type_support.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace conflux {
+
+/// A serialized message as read from a bag.
+using BagMessage = rosbag2_storage::SerializedBagMessage;
+
+/// Synchronizes the topics of a rosbag2 bag without deserializing them.
+///
+/// Each message's timestamp is read from the `header.stamp` at the start
+/// of its CDR bytes, and only a shared pointer to the serialized message
+/// is buffered. Groups hold `std::shared_ptr<const BagMessage>` members,
+/// so only messages that actually form a group need to be deserialized,
+/// with deserialize<MsgT>(). Every registered topic must have a
+/// std_msgs/Header as its first field and be stored as CDR.
+///
+/// Groups are delivered on the reading thread as soon as they complete, so
+/// the bag is read as fast as groups are consumed. A fast topic can still
+/// fill its buffer before a slower topic's next message is read. With
+/// DropPolicy::DropOldest its oldest messages then make room; with
+/// DropPolicy::RejectNew the new message is skipped. Either way playback
+/// keeps going, and a buffer_size covering the slowest topic's period
+/// avoids the loss. Staleness runs on wall time and should be left disabled.
+///
+/// Example usage:
+/// ```cpp
+/// conflux::BagSynchronizer sync(config);
+/// size_t image = sync.add_topic("/camera/image");
+/// size_t points = sync.add_topic("/lidar/points");
+///
+/// sync.on_synchronized([&](const conflux::SyncGroup& group) {
+///     auto msg = conflux::deserialize<sensor_msgs::msg::Image>(group, image);
+///     // Process the group
+/// });
+///
+/// sync.open("drive_0042");
+/// sync.play();
+/// ```
+class CONFLUX_EXPORT BagSynchronizer {
+public:
+    /// Create a synchronizer for bag playback.
+    ///
+    /// Config::eager_dispatch is forced on, since there is no executor to
+    /// call spin_once().
+    explicit BagSynchronizer(const Config& config);
+
+    /// Destructor.
+    ~BagSynchronizer();
+
+    // Non-copyable
+    BagSynchronizer(const BagSynchronizer&) = delete;
+    BagSynchronizer& operator=(const BagSynchronizer&) = delete;
+
+    // Movable
+    BagSynchronizer(BagSynchronizer&&) noexcept;
+    BagSynchronizer& operator=(BagSynchronizer&&) noexcept;
+
+    /// Add a bag topic to synchronize. Other topics in the bag are skipped
+    /// by the storage filter without being read.
+    ///
+    /// @param topic The topic name as recorded in the bag
+    /// @return The topic's stream index, for use with SyncGroup accessors
+    size_t add_topic(const std::string& topic);
+
+    /// Register a callback for synchronized groups, finalizing the topics.
+    void on_synchronized(SyncCallback callback);
+
+    /// Open a bag by URI with the default storage options.
+    ///
+    /// Throws std::runtime_error if a registered topic is missing from the
+    /// bag or is not stored as CDR.
+    void open(const std::string& uri);
+
+    /// Open a bag with explicit storage options.
+    void open(const rosbag2_storage::StorageOptions& storage_options);
+
+    /// Read the next message of a registered topic and synchronize it.
+    ///
+    /// @return False once the bag is exhausted
+    bool play_next();
+
+    /// Read the bag to the end.
+    ///
+    /// @return The number of messages read
+    size_t play();
+
+    /// Get the number of messages skipped because no stamp could be read or
+    /// the synchronizer rejected them, e.g. for a full buffer.
+    uint64_t skipped() const;
+
+    /// Get a snapshot of the per-stream counters and group histograms.
+    SyncStats stats() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+/// Deserialize a member of a group produced by a BagSynchronizer.
+///
+/// The message is deserialized straight from the bag's buffer.
+///
+/// @tparam MsgT The message type recorded on the member's topic
+/// @param group The synchronized group
+/// @param index The member's stream index
+/// @return The message, or nullptr if the member is absent or is not a
+///         bag message; throws std::runtime_error if deserialization fails
+template <typename MsgT>
+std::shared_ptr<MsgT> deserialize(const SyncGroup& group, size_t index) {
+    const BagMessage* serialized = group.get<BagMessage>(index);
+    if (!serialized || !serialized->serialized_data) {
+        return nullptr;
+    }
+
+    auto message = std::make_shared<MsgT>();
+    rmw_ret_t ret = rmw_deserialize(serialized->serialized_data.get(),
+                                    rosidl_typesupport_cpp::get_message_type_support_handle<MsgT>(),
+                                    message.get());
+    if (ret != RMW_RET_OK) {
+        throw std::runtime_error("Failed to deserialize message from " + serialized->topic_name);
+    }
+    return message;
+}
+
+}  // namespace conflux
+
+#endif  // CONFLUX_BAG_SYNCHRONIZER_HPP
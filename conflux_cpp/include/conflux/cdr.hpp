@@ -0,0 +1,71 @@
+/*
+ * Conflux C++ Library - CDR Stamp Parser
+ *
+ * Reads header stamps straight from CDR-serialized ROS2 messages, so
+ * serialized messages can be synchronized without deserializing them.
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#ifndef CONFLUX_CDR_HPP
+#define CONFLUX_CDR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace conflux {
+namespace cdr {
+
+/// Size of the encapsulation header that starts every serialized message.
+constexpr size_t kEncapsulationSize = 4;
+
+/// Read a 32-bit unsigned integer in the given byte order.
+inline uint32_t read_u32(const uint8_t* data, bool little_endian) {
+    if (little_endian) {
+        return static_cast<uint32_t>(data[0]) | static_cast<uint32_t>(data[1]) << 8 |
+               static_cast<uint32_t>(data[2]) << 16 | static_cast<uint32_t>(data[3]) << 24;
+    }
+    return static_cast<uint32_t>(data[3]) | static_cast<uint32_t>(data[2]) << 8 |
+           static_cast<uint32_t>(data[1]) << 16 | static_cast<uint32_t>(data[0]) << 24;
+}
+
+/// Read `header.stamp` of a serialized message whose first field is a
+/// std_msgs/Header.
+///
+/// The stamp's `sec` and `nanosec` are the first two fields of the
+/// message, so they sit right after the encapsulation header at 4-byte
+/// aligned offsets and nothing else needs to be parsed. Only plain CDR
+/// and XCDR2 encodings, as written by the ROS2 middlewares, are accepted.
+/// The parser cannot tell whether the message really starts with a
+/// header; for other types the result is meaningless.
+///
+/// @param data The serialized message, including the encapsulation header
+/// @param size The number of bytes in data
+/// @return The stamp in nanoseconds, or std::nullopt if the buffer is too
+///         short, uses another encoding, or holds an invalid nanosec
+inline std::optional<int64_t> header_stamp_ns(const uint8_t* data, size_t size) {
+    if (!data || size < kEncapsulationSize + 8) {
+        return std::nullopt;
+    }
+
+    // Encapsulation identifiers: CDR_BE 0x0000, CDR_LE 0x0001,
+    // CDR2_BE 0x0006, CDR2_LE 0x0007
+    uint8_t kind = data[1];
+    if (data[0] != 0 || (kind != 0x00 && kind != 0x01 && kind != 0x06 && kind != 0x07)) {
+        return std::nullopt;
+    }
+    bool little_endian = (kind & 0x01) != 0;
+
+    auto sec = static_cast<int32_t>(read_u32(data + kEncapsulationSize, little_endian));
+    uint32_t nanosec = read_u32(data + kEncapsulationSize + 4, little_endian);
+    if (nanosec >= 1000000000u) {
+        return std::nullopt;
+    }
+    return static_cast<int64_t>(sec) * 1000000000LL + static_cast<int64_t>(nanosec);
+}
+
+}  // namespace cdr
+}  // namespace conflux
+
+#endif  // CONFLUX_CDR_HPP
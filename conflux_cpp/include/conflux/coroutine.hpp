@@ -0,0 +1,188 @@
+/*
+ * Conflux C++ Library - Coroutine Support
+ *
+ * Awaitable access to synchronized groups for C++20 coroutines. The
+ * library itself is built as C++17; this header is only usable from
+ * translation units compiled with coroutine support and is empty otherwise.
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#ifndef CONFLUX_COROUTINE_HPP
+#define CONFLUX_COROUTINE_HPP
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include "conflux/synchronizer.hpp"
+#include "conflux/types.hpp"
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace conflux {
+
+/// Delivers a synchronizer's groups to a coroutine.
+///
+/// The channel registers itself as the synchronizer's on_synchronized()
+/// callback, so it replaces any callback of the user's own. A coroutine
+/// suspended in `co_await channel.next_group()` is resumed directly on the
+/// thread that completed the group: the subscription's thread with
+/// Config::eager_dispatch, the worker after Synchronizer::start(), or the
+/// caller of spin_once(). The coroutine then runs inside the callback until
+/// it suspends again, so it should hand heavy work to its executor, e.g.
+/// with `co_await asio::post(executor, asio::use_awaitable)`.
+///
+/// Groups completed while no coroutine waits are queued, up to the
+/// capacity; beyond that the oldest queued group is discarded. Only one
+/// coroutine may wait at a time.
+///
+/// Example usage:
+/// ```cpp
+/// conflux::GroupChannel channel(sync);
+///
+/// asio::awaitable<void> consume(conflux::GroupChannel& channel) {
+///     while (auto group = co_await channel.next_group()) {
+///         auto image = group->get<sensor_msgs::msg::Image>("/camera/image");
+///         // Process synchronized messages
+///     }
+/// }
+/// ```
+class GroupChannel {
+public:
+    /// Register the channel with the synchronizer.
+    ///
+    /// @param sync The synchronizer; on_synchronized() is called here
+    /// @param capacity Number of groups queued while no coroutine waits
+    explicit GroupChannel(Synchronizer& sync, size_t capacity = 16)
+        : state_(std::make_shared<State>(capacity)) {
+        sync.on_synchronized([state = state_](const SyncGroup& group) { state->deliver(group); });
+    }
+
+    /// Destructor. Closes the channel.
+    ~GroupChannel() { close(); }
+
+    GroupChannel(const GroupChannel&) = delete;
+    GroupChannel& operator=(const GroupChannel&) = delete;
+
+    /// Awaitable for the next group.
+    ///
+    /// Completes immediately if a group is queued. Yields std::nullopt once
+    /// the channel is closed and its queue is empty, so
+    /// `while (auto group = co_await channel.next_group())` consumes every
+    /// group like an async generator.
+    auto next_group() { return Awaiter{state_}; }
+
+    /// Stop accepting groups and resume a waiting coroutine with
+    /// std::nullopt. Groups already queued can still be awaited.
+    void close() { state_->close(); }
+
+    /// Number of groups discarded from a full queue.
+    uint64_t dropped() const { return state_->dropped(); }
+
+private:
+    /// Shared with the synchronizer's callback, which may outlive the
+    /// channel.
+    class State {
+    public:
+        explicit State(size_t capacity) : capacity_(capacity > 0 ? capacity : 1) {}
+
+        void deliver(const SyncGroup& group) {
+            std::coroutine_handle<> waiter;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (closed_) {
+                    return;
+                }
+                if (waiter_) {
+                    result_->emplace(group);
+                    waiter = std::exchange(waiter_, nullptr);
+                } else {
+                    if (queue_.size() == capacity_) {
+                        queue_.pop_front();
+                        ++dropped_;
+                    }
+                    queue_.push_back(group);
+                }
+            }
+            if (waiter) {
+                waiter.resume();
+            }
+        }
+
+        void close() {
+            std::coroutine_handle<> waiter;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                closed_ = true;
+                waiter = std::exchange(waiter_, nullptr);
+            }
+            if (waiter) {
+                waiter.resume();
+            }
+        }
+
+        /// Take a queued group, or register the coroutine to be resumed
+        /// with the next one. Returns false if the coroutine need not wait.
+        bool wait(std::coroutine_handle<> handle, std::optional<SyncGroup>& result) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!queue_.empty()) {
+                result.emplace(std::move(queue_.front()));
+                queue_.pop_front();
+                return false;
+            }
+            if (closed_) {
+                return false;
+            }
+            waiter_ = handle;
+            result_ = &result;
+            return true;
+        }
+
+        uint64_t dropped() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return dropped_;
+        }
+
+    private:
+        size_t capacity_;
+        mutable std::mutex mutex_;
+        std::deque<SyncGroup> queue_;
+        std::coroutine_handle<> waiter_;
+        std::optional<SyncGroup>* result_ = nullptr;
+        uint64_t dropped_ = 0;
+        bool closed_ = false;
+    };
+
+    /// Result of next_group(). The group is filled in by whoever resumes
+    /// the coroutine, before resuming it.
+    class Awaiter {
+    public:
+        explicit Awaiter(std::shared_ptr<State> state) : state_(std::move(state)) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            return state_->wait(handle, result_);
+        }
+
+        std::optional<SyncGroup> await_resume() { return std::move(result_); }
+
+    private:
+        std::shared_ptr<State> state_;
+        std::optional<SyncGroup> result_;
+    };
+
+    std::shared_ptr<State> state_;
+};
+
+}  // namespace conflux
+
+#endif  // defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#endif  // CONFLUX_COROUTINE_HPP
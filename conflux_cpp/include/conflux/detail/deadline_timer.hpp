@@ -0,0 +1,113 @@
+/*
+ * Conflux C++ Library - Deadline Timer
+ *
+ * One-shot rclcpp wall timer re-armed to the earliest pending deadline.
+ * Internal to the library; not part of the public API.
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#ifndef CONFLUX_DETAIL_DEADLINE_TIMER_HPP
+#define CONFLUX_DETAIL_DEADLINE_TIMER_HPP
+
+#include "rclcpp/rclcpp.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <utility>
+
+namespace conflux {
+namespace detail {
+
+/// Fires a callback once at the earliest requested deadline.
+///
+/// rclcpp timers are periodic, so the timer is cancelled as soon as it
+/// fires and a new one is created for the next deadline. Arming with a
+/// deadline that is not earlier than the one already armed is a no-op, so
+/// calling arm() on every push does not churn timers.
+///
+/// The timer fires on an executor thread while arm() may run on any push
+/// thread, so the timer state is guarded by a mutex of its own. The mutex
+/// is released before the callback runs, which may arm the timer again.
+class DeadlineTimer {
+public:
+    explicit DeadlineTimer(std::function<void()> callback) : callback_(std::move(callback)) {}
+
+    ~DeadlineTimer() { cancel(); }
+
+    DeadlineTimer(const DeadlineTimer&) = delete;
+    DeadlineTimer& operator=(const DeadlineTimer&) = delete;
+
+    /// Set the node that owns the timers. The first node set is kept.
+    void set_node(const rclcpp::Node::SharedPtr& node) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (node_.expired()) {
+            node_ = node;
+        }
+    }
+
+    /// Fire after `delay` unless an earlier deadline is already armed.
+    void arm(std::chrono::nanoseconds delay) {
+        auto deadline = std::chrono::steady_clock::now() + delay;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (timer_ && deadline_ <= deadline + kSlack) {
+            return;
+        }
+
+        auto node = node_.lock();
+        if (!node) {
+            return;
+        }
+
+        cancel_locked();
+        deadline_ = deadline;
+        uint64_t generation = generation_;
+        timer_ = node->create_wall_timer(delay, [this, generation]() { fire(generation); });
+    }
+
+    /// Disarm the timer.
+    void cancel() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancel_locked();
+    }
+
+private:
+    /// Disarm, then run the callback unless the timer was cancelled or
+    /// re-armed while this firing was already under way.
+    void fire(uint64_t generation) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (generation != generation_) {
+                return;
+            }
+            cancel_locked();
+        }
+        callback_();
+    }
+
+    void cancel_locked() {
+        if (timer_) {
+            timer_->cancel();
+            timer_.reset();
+        }
+        ++generation_;
+    }
+
+    /// Deadlines this close to the armed one are not worth a new timer.
+    /// Matches the finest staleness precision gap.
+    static constexpr std::chrono::microseconds kSlack{100};
+
+    std::function<void()> callback_;
+    std::mutex mutex_;
+    rclcpp::Node::WeakPtr node_;
+    rclcpp::TimerBase::SharedPtr timer_;
+    std::chrono::steady_clock::time_point deadline_;
+    uint64_t generation_ = 0;
+};
+
+}  // namespace detail
+}  // namespace conflux
+
+#endif  // CONFLUX_DETAIL_DEADLINE_TIMER_HPP
@@ -0,0 +1,185 @@
+/*
+ * Conflux C++ Library - Message Memory
+ *
+ * Allocation and ownership of messages received by subscriptions.
+ * Internal to the library; not part of the public API.
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#ifndef CONFLUX_DETAIL_MESSAGE_MEMORY_HPP
+#define CONFLUX_DETAIL_MESSAGE_MEMORY_HPP
+
+#include "conflux/types.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace conflux {
+namespace detail {
+
+/// Allocator handed to rclcpp for a subscription's messages.
+///
+/// Draws from a memory resource it shares ownership of. rclcpp keeps a
+/// copy of the allocator in every message's control block, so the resource
+/// lives until the last message is gone, even if a user keeps one after
+/// the synchronizer is destroyed. A resource from Config::memory_resource
+/// is not owned. Default-constructed allocators, which rclcpp requires but
+/// does not use once an allocator is set, draw from the global heap.
+template <typename T>
+class MessageAllocator {
+public:
+    using value_type = T;
+
+    MessageAllocator()
+        : resource_(std::shared_ptr<std::pmr::memory_resource>(),
+                    std::pmr::new_delete_resource()) {}
+
+    explicit MessageAllocator(std::shared_ptr<std::pmr::memory_resource> resource)
+        : resource_(std::move(resource)) {}
+
+    template <typename U>
+    MessageAllocator(const MessageAllocator<U>& other)
+        : resource_(other.resource()) {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(resource_->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* pointer, size_t count) {
+        resource_->deallocate(pointer, count * sizeof(T), alignof(T));
+    }
+
+    const std::shared_ptr<std::pmr::memory_resource>& resource() const { return resource_; }
+
+    template <typename U>
+    bool operator==(const MessageAllocator<U>& other) const {
+        return resource_->is_equal(*other.resource());
+    }
+
+    template <typename U>
+    bool operator!=(const MessageAllocator<U>& other) const {
+        return !(*this == other);
+    }
+
+private:
+    std::shared_ptr<std::pmr::memory_resource> resource_;
+};
+
+/// Pre-faulted pool for one subscription's messages (MemoryPreset::Pooled).
+///
+/// The whole arena is allocated and written once, up front, and blocks are
+/// carved from it by a synchronized pool resource, so messages freed in any
+/// order go back to their pool instead of the general heap. Requests the
+/// arena cannot satisfy fall back to the global heap.
+class MessagePool : public std::pmr::memory_resource {
+public:
+    /// @param block_size Size of one message with its control block
+    /// @param block_count Number of messages alive at once
+    MessagePool(size_t block_size, size_t block_count)
+        : arena_buffer_(arena_size(block_size, block_count)),
+          arena_(arena_buffer_.data(), arena_buffer_.size()),
+          pool_(pool_options(block_size, block_count), &arena_) {}
+
+private:
+    /// The pool rounds blocks up to a power of two and grows its chunks
+    /// geometrically, so leave room for four times the blocks in use, plus
+    /// the pool's own bookkeeping.
+    static size_t arena_size(size_t block_size, size_t block_count) {
+        return 4 * block_size * block_count + 4096;
+    }
+
+    static std::pmr::pool_options pool_options(size_t block_size, size_t block_count) {
+        std::pmr::pool_options options;
+        options.max_blocks_per_chunk = block_count;
+        options.largest_required_pool_block = block_size;
+        return options;
+    }
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        return pool_.allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override {
+        pool_.deallocate(pointer, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::vector<std::byte> arena_buffer_;
+    std::pmr::monotonic_buffer_resource arena_;
+    std::pmr::synchronized_pool_resource pool_;
+};
+
+/// Allocator for a subscription's messages of the given size, or nullptr
+/// to keep rclcpp's default allocator.
+///
+/// A pooled subscription holds up to twice buffer_size messages at once:
+/// its ring and buffer each hold up to buffer_size, and a few more are
+/// being received or delivered.
+inline std::shared_ptr<MessageAllocator<void>> make_message_allocator(const Config& config,
+                                                                     size_t message_size) {
+    if (config.memory_resource) {
+        return std::make_shared<MessageAllocator<void>>(std::shared_ptr<std::pmr::memory_resource>(
+            std::shared_ptr<std::pmr::memory_resource>(), config.memory_resource));
+    }
+    if (config.memory == MemoryPreset::Pooled) {
+        // Control block of std::allocate_shared, holding a copy of the
+        // allocator as well as the counts
+        constexpr size_t kControlBlockSize = 64;
+        size_t block_size = message_size + kControlBlockSize;
+        size_t block_count = 2 * config.buffer_size + 8;
+        return std::make_shared<MessageAllocator<void>>(
+            std::make_shared<MessagePool>(block_size, block_count));
+    }
+    return nullptr;
+}
+
+/// How a subscription callback takes ownership of its messages.
+///
+/// With a middleware that loans messages, e.g. a shared-memory RMW, rclcpp
+/// hands the callback a pointer into the loan and returns the loan as soon
+/// as the callback returns, so that pointer must not be buffered. Messages
+/// of such a subscription are copied, from its allocator if it has one;
+/// all others are kept as they are, so a shared pointer from intra-process
+/// delivery is never copied. Until the subscription exists and set_loaned()
+/// has run, messages are copied too: a node already spinning on another
+/// thread may deliver the first ones before create_subscription() returns.
+class MessageSource {
+public:
+    explicit MessageSource(std::shared_ptr<MessageAllocator<void>> allocator)
+        : allocator_(std::move(allocator)) {}
+
+    /// The subscription's allocator, or nullptr for rclcpp's default one.
+    const std::shared_ptr<MessageAllocator<void>>& allocator() const { return allocator_; }
+
+    /// Set once the subscription exists and can be asked whether it loans.
+    /// Messages are treated as loaned until then.
+    void set_loaned(bool loaned) { loaned_.store(loaned, std::memory_order_release); }
+
+    /// A pointer to the message that stays valid after the callback.
+    template <typename MsgT>
+    std::shared_ptr<const MsgT> own(std::shared_ptr<const MsgT> message) const {
+        if (!loaned_.load(std::memory_order_acquire)) {
+            return message;
+        }
+        if (allocator_) {
+            return std::allocate_shared<MsgT>(MessageAllocator<MsgT>(*allocator_), *message);
+        }
+        return std::make_shared<MsgT>(*message);
+    }
+
+private:
+    std::shared_ptr<MessageAllocator<void>> allocator_;
+    std::atomic<bool> loaned_{true};
+};
+
+}  // namespace detail
+}  // namespace conflux
+
+#endif  // CONFLUX_DETAIL_MESSAGE_MEMORY_HPP
@@ -0,0 +1,190 @@
+/*
+ * Conflux C++ Library - Slot Pool
+ *
+ * Fixed-capacity storage for messages in flight through the core. Internal to
+ * the library; not part of the public API.
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#ifndef CONFLUX_DETAIL_SLOT_POOL_HPP
+#define CONFLUX_DETAIL_SLOT_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+namespace conflux {
+namespace detail {
+
+/// Identifies a slot in a stream's pool, packed into the opaque `user_data`
+/// pointer handed to the core.
+///
+/// Layout (low to high bits): 24-bit slot index, 24-bit generation, 16-bit
+/// stream index. The generation changes every time a slot is released, so a
+/// stale handle never resolves to a newer message stored in the same slot.
+struct SlotHandle {
+    static constexpr uint64_t kSlotBits = 24;
+    static constexpr uint64_t kGenerationBits = 24;
+    static constexpr uint64_t kStreamBits = 16;
+    static constexpr uint64_t kSlotMask = (uint64_t{1} << kSlotBits) - 1;
+    static constexpr uint64_t kGenerationMask = (uint64_t{1} << kGenerationBits) - 1;
+    static constexpr uint64_t kStreamMask = (uint64_t{1} << kStreamBits) - 1;
+
+    // The packed handle travels through the core as a pointer, so it has to
+    // fit one whole
+    static_assert(sizeof(void*) >= sizeof(uint64_t), "SlotHandle requires 64-bit pointers");
+
+    uint32_t stream = 0;
+    uint32_t slot = 0;
+    uint32_t generation = 0;
+
+    void* to_user_data() const {
+        uint64_t packed = (uint64_t{slot} & kSlotMask) |
+                          ((uint64_t{generation} & kGenerationMask) << kSlotBits) |
+                          ((uint64_t{stream} & kStreamMask) << (kSlotBits + kGenerationBits));
+        return reinterpret_cast<void*>(static_cast<uintptr_t>(packed));
+    }
+
+    static SlotHandle from_user_data(void* user_data) {
+        auto packed = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(user_data));
+        SlotHandle handle;
+        handle.slot = static_cast<uint32_t>(packed & kSlotMask);
+        handle.generation = static_cast<uint32_t>((packed >> kSlotBits) & kGenerationMask);
+        handle.stream =
+            static_cast<uint32_t>((packed >> (kSlotBits + kGenerationBits)) & kStreamMask);
+        return handle;
+    }
+};
+
+/// Fixed-capacity pool of message slots for a single stream.
+///
+/// All slots are allocated up front. Free slots are kept on a lock-free
+/// stack whose head carries an ABA tag, so acquire() and release() never
+/// allocate or block. A slot's payload belongs to whoever holds its handle:
+/// the producer between acquire() and handing the handle to the core, and
+/// the consumer between the core returning it and release().
+template <typename T>
+class SlotPool {
+public:
+    explicit SlotPool(uint32_t stream, size_t capacity)
+        : stream_(stream),
+          capacity_(static_cast<uint32_t>(capacity)),
+          slots_(std::make_unique<Slot[]>(capacity)) {
+        // Chain all slots into the free list
+        for (uint32_t i = 0; i < capacity_; ++i) {
+            slots_[i].next.store(i + 1 < capacity_ ? i + 1 : kNil, std::memory_order_relaxed);
+        }
+        head_.store(pack_head(0, capacity_ > 0 ? 0 : kNil), std::memory_order_release);
+    }
+
+    SlotPool(const SlotPool&) = delete;
+    SlotPool& operator=(const SlotPool&) = delete;
+
+    /// Take a free slot and move the payload into it.
+    /// Returns std::nullopt, leaving the payload as it was, if every slot is
+    /// in use.
+    std::optional<SlotHandle> acquire(T&& payload) {
+        uint64_t head = head_.load(std::memory_order_acquire);
+        uint32_t index;
+        while (true) {
+            index = head_index(head);
+            if (index == kNil) {
+                return std::nullopt;
+            }
+            uint32_t next = slots_[index].next.load(std::memory_order_relaxed);
+            if (head_.compare_exchange_weak(head, pack_head(head_tag(head) + 1, next),
+                                            std::memory_order_acquire,
+                                            std::memory_order_acquire)) {
+                break;
+            }
+        }
+
+        Slot& slot = slots_[index];
+        slot.payload = std::move(payload);
+
+        SlotHandle handle;
+        handle.stream = stream_;
+        handle.slot = index;
+        handle.generation =
+            slot.generation.load(std::memory_order_relaxed) & SlotHandle::kGenerationMask;
+        return handle;
+    }
+
+    /// Access the payload of a held slot.
+    /// Returns nullptr if the handle is stale or out of range.
+    T* get(const SlotHandle& handle) {
+        if (handle.slot >= capacity_) {
+            return nullptr;
+        }
+        Slot& slot = slots_[handle.slot];
+        if ((slot.generation.load(std::memory_order_relaxed) & SlotHandle::kGenerationMask) !=
+            handle.generation) {
+            return nullptr;
+        }
+        return &slot.payload;
+    }
+
+    /// Move the payload out of a held slot and return the slot to the pool.
+    /// Returns std::nullopt if the handle is stale or out of range.
+    std::optional<T> take(const SlotHandle& handle) {
+        T* payload = get(handle);
+        if (!payload) {
+            return std::nullopt;
+        }
+        std::optional<T> result(std::move(*payload));
+        release(handle);
+        return result;
+    }
+
+    /// Destroy the payload of a held slot and return the slot to the pool.
+    void release(const SlotHandle& handle) {
+        if (!get(handle)) {
+            return;
+        }
+
+        Slot& slot = slots_[handle.slot];
+        slot.payload = T{};
+        slot.generation.fetch_add(1, std::memory_order_relaxed);
+
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        while (true) {
+            slot.next.store(head_index(head), std::memory_order_relaxed);
+            if (head_.compare_exchange_weak(head, pack_head(head_tag(head) + 1, handle.slot),
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+                break;
+            }
+        }
+    }
+
+    /// Total number of slots.
+    size_t capacity() const { return capacity_; }
+
+private:
+    static constexpr uint32_t kNil = UINT32_MAX;
+
+    struct Slot {
+        T payload{};
+        std::atomic<uint32_t> generation{0};
+        std::atomic<uint32_t> next{kNil};
+    };
+
+    static uint64_t pack_head(uint32_t tag, uint32_t index) {
+        return (uint64_t{tag} << 32) | uint64_t{index};
+    }
+    static uint32_t head_index(uint64_t head) { return static_cast<uint32_t>(head); }
+    static uint32_t head_tag(uint64_t head) { return static_cast<uint32_t>(head >> 32); }
+
+    uint32_t stream_;
+    uint32_t capacity_;
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<uint64_t> head_{0};
+};
+
+}  // namespace detail
+}  // namespace conflux
+
+#endif  // CONFLUX_DETAIL_SLOT_POOL_HPP
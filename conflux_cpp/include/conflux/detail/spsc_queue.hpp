@@ -0,0 +1,103 @@
+/*
+ * Conflux C++ Library - SPSC Queue
+ *
+ * Bounded single-producer single-consumer ring buffer. Internal to the
+ * library; not part of the public API.
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#ifndef CONFLUX_DETAIL_SPSC_QUEUE_HPP
+#define CONFLUX_DETAIL_SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace conflux {
+namespace detail {
+
+/// Bounded lock-free ring buffer for one producer and one consumer.
+///
+/// The producer only writes `tail_` and the consumer only writes `head_`,
+/// each on its own cache line, and each side caches the other's index so
+/// the shared line is only read when the cached value says the ring looks
+/// full or empty. The capacity is rounded up to a power of two.
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity)
+        : mask_(round_up_pow2(capacity) - 1), slots_(std::make_unique<T[]>(mask_ + 1)) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /// Append a value. Returns false if the ring is full. Producer only.
+    bool try_push(const T& value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ > mask_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ > mask_) {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Get the oldest value, or nullptr if the ring is empty. Consumer only.
+    const T* front() {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) {
+                return nullptr;
+            }
+        }
+        return &slots_[head & mask_];
+    }
+
+    /// Remove the value returned by front(). Consumer only.
+    void pop() {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /// Number of values that can be popped right now. Consumer only.
+    size_t size() {
+        tail_cache_ = tail_.load(std::memory_order_acquire);
+        return tail_cache_ - head_.load(std::memory_order_relaxed);
+    }
+
+    /// Check whether the ring looks empty. Safe from any thread, but the
+    /// answer may be stale by the time it is used.
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    /// Maximum number of values the ring holds.
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    static size_t round_up_pow2(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t mask_;
+    const std::unique_ptr<T[]> slots_;
+
+    alignas(64) std::atomic<size_t> head_{0};
+    size_t tail_cache_ = 0;
+
+    alignas(64) std::atomic<size_t> tail_{0};
+    size_t head_cache_ = 0;
+};
+
+}  // namespace detail
+}  // namespace conflux
+
+#endif  // CONFLUX_DETAIL_SPSC_QUEUE_HPP
@@ -0,0 +1,83 @@
+/*
+ * Conflux C++ Library - Sync Core
+ *
+ * Stream-indexed access to the matching core for header-only front ends.
+ * Internal to the library; not part of the public API.
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#ifndef CONFLUX_DETAIL_SYNC_CORE_HPP
+#define CONFLUX_DETAIL_SYNC_CORE_HPP
+
+#include "conflux/types.hpp"
+#include "conflux/visibility.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace conflux {
+namespace detail {
+
+/// Thin owner of a core synchronizer, addressed by stream index.
+///
+/// The core only sees opaque `user_data` pointers; the front end owns the
+/// messages they refer to and is told through the drop callback when the
+/// core discards one without emitting it.
+class CONFLUX_EXPORT SyncCore {
+public:
+    /// One member of a group returned by poll_batch().
+    struct Member {
+        size_t stream_index = 0;
+        int64_t timestamp_ns = 0;
+        void* user_data = nullptr;
+    };
+
+    /// Called with the `user_data` of every message discarded by the core.
+    using DropCallback = void (*)(void* user_data, void* context);
+
+    /// Create a core for the given topics. Each topic's stream index is its
+    /// position in `topics`. Throws std::runtime_error on failure.
+    SyncCore(const Config& config, const std::vector<std::string>& topics,
+             DropCallback on_drop, void* context);
+
+    ~SyncCore();
+
+    SyncCore(const SyncCore&) = delete;
+    SyncCore& operator=(const SyncCore&) = delete;
+
+    /// Push a message to a stream. Returns false if it was rejected, in
+    /// which case the caller still owns `user_data`.
+    bool push(size_t stream_index, int64_t timestamp_ns, void* user_data);
+
+    /// Fetch up to max_groups ready groups into `members`, which must hold
+    /// max_groups * stream_count() records; group g occupies records
+    /// [g * stream_count(), (g + 1) * stream_count()), ordered by stream index.
+    /// Returns the number of groups written.
+    size_t poll_batch(Member* members, size_t max_groups);
+
+    /// Get the nanoseconds until the next staleness deadline, or -1 if none.
+    int64_t next_expiration_ns() const;
+
+    /// Remove stale messages, reporting them to the drop callback.
+    /// Returns the number of messages removed.
+    size_t process_expired();
+
+    /// Get the number of streams.
+    size_t stream_count() const;
+
+    /// Check if all buffers have at least 2 messages.
+    bool is_ready() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace detail
+}  // namespace conflux
+
+#endif  // CONFLUX_DETAIL_SYNC_CORE_HPP
@@ -0,0 +1,69 @@
+/*
+ * Conflux C++ Library - Serialized Relay
+ *
+ * Republishes synchronized groups of serialized messages.
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#ifndef CONFLUX_SERIALIZED_RELAY_HPP
+#define CONFLUX_SERIALIZED_RELAY_HPP
+
+#include "conflux/types.hpp"
+#include "conflux/visibility.h"
+
+#include "rclcpp/rclcpp.hpp"
+
+#include <string>
+#include <vector>
+
+namespace conflux {
+
+/// Fans synchronized groups out to one GenericPublisher per stream.
+///
+/// Members subscribed with Synchronizer::add_serialized_subscription() are
+/// republished as the SerializedMessage they arrived as, so a relay never
+/// deserializes or re-serializes a message.
+///
+/// Example usage:
+/// ```cpp
+/// size_t image = sync.add_serialized_subscription(node, "/camera/image",
+///                                                 "sensor_msgs/msg/Image");
+///
+/// conflux::SerializedRelay relay(node);
+/// relay.add_output(image, "/synced/image", "sensor_msgs/msg/Image");
+///
+/// sync.on_synchronized([&relay](const conflux::SyncGroup& group) {
+///     relay.publish(group);
+/// });
+/// ```
+class CONFLUX_EXPORT SerializedRelay {
+public:
+    /// Create a relay publishing on the given node.
+    explicit SerializedRelay(rclcpp::Node::SharedPtr node);
+
+    /// Republish a stream's members on a topic.
+    ///
+    /// @param stream_index The stream index returned by the synchronizer
+    /// @param topic The topic to publish on
+    /// @param type_name The message type, which must match the stream's
+    /// @param qos QoS profile for the publisher (default: SensorDataQoS)
+    void add_output(size_t stream_index, const std::string& topic, const std::string& type_name,
+                    const rclcpp::QoS& qos = rclcpp::SensorDataQoS());
+
+    /// Publish every member of a group that has an output, in stream order.
+    /// Members that are absent or not serialized are skipped.
+    ///
+    /// @return The number of messages published
+    size_t publish(const SyncGroup& group) const;
+
+private:
+    rclcpp::Node::SharedPtr node_;
+
+    /// Publisher per stream index; null for streams without an output.
+    std::vector<rclcpp::GenericPublisher::SharedPtr> publishers_;
+};
+
+}  // namespace conflux
+
+#endif  // CONFLUX_SERIALIZED_RELAY_HPP
@@ -0,0 +1,166 @@
+/*
+ * Conflux C++ Library - Statistics
+ *
+ * Snapshot types returned by Synchronizer::stats() and
+ * Synchronizer::feedback().
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#ifndef CONFLUX_STATS_HPP
+#define CONFLUX_STATS_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace conflux {
+
+/// Histogram of durations with power-of-two buckets.
+///
+/// Bucket b counts durations in [2^b, 2^(b+1)) nanoseconds; bucket 0 also
+/// counts zero, and the last bucket counts everything above its lower bound.
+struct Histogram {
+    /// Number of buckets, covering durations up to about 18 minutes.
+    static constexpr size_t kBucketCount = 40;
+
+    std::array<uint64_t, kBucketCount> buckets{};
+    uint64_t count = 0;
+    std::chrono::nanoseconds sum{0};
+    std::chrono::nanoseconds max{0};
+
+    /// Get the bucket a duration is counted in.
+    static size_t bucket_of(std::chrono::nanoseconds value) {
+        auto ns = static_cast<uint64_t>(value.count() > 0 ? value.count() : 0);
+        size_t bucket = 0;
+        while (ns > 1 && bucket + 1 < kBucketCount) {
+            ns >>= 1;
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    /// Get the mean duration, or zero if nothing was recorded.
+    std::chrono::nanoseconds mean() const {
+        return count > 0 ? sum / static_cast<int64_t>(count) : std::chrono::nanoseconds{0};
+    }
+
+    /// Get an upper bound for the given quantile (0.0 to 1.0).
+    ///
+    /// The result is the upper edge of the bucket holding the quantile,
+    /// capped at the largest recorded duration, so it overestimates by at
+    /// most a factor of two.
+    std::chrono::nanoseconds percentile(double quantile) const {
+        if (count == 0) {
+            return std::chrono::nanoseconds{0};
+        }
+
+        auto rank = static_cast<uint64_t>(quantile * static_cast<double>(count));
+        uint64_t seen = 0;
+        for (size_t b = 0; b < kBucketCount; ++b) {
+            seen += buckets[b];
+            if (seen > rank || seen == count) {
+                auto upper = std::chrono::nanoseconds((int64_t{2} << b) - 1);
+                return upper < max ? upper : max;
+            }
+        }
+        return max;
+    }
+};
+
+/// Counters for one stream.
+///
+/// Every message pushed to a stream is counted as accepted or as rejected
+/// with a reason. An accepted message is later either emitted in a group or
+/// evicted with a reason; until then it counts toward buffer_depth.
+struct StreamStats {
+    /// Topic name of the stream.
+    std::string topic;
+
+    /// Messages accepted into the stream's buffer.
+    uint64_t accepted = 0;
+
+    /// Accepted messages that were matched into a group.
+    uint64_t emitted = 0;
+
+    /// Messages rejected because the buffer was full (RejectNew).
+    uint64_t rejected_buffer_full = 0;
+    /// Messages rejected for being older than the last emitted group.
+    uint64_t rejected_late = 0;
+    /// Messages rejected for not being newer than the stream's last message.
+    uint64_t rejected_out_of_order = 0;
+
+    /// Buffered messages dropped for falling before a match's time window.
+    uint64_t evicted_window = 0;
+    /// Buffered messages dropped to make room for newer ones (DropOldest).
+    uint64_t evicted_overflow = 0;
+    /// Buffered messages dropped by staleness detection.
+    uint64_t evicted_stale = 0;
+    /// Buffered messages dropped when their own timeout expired.
+    uint64_t evicted_expired = 0;
+    /// Buffered messages dropped because no group could be formed.
+    uint64_t evicted_unmatched = 0;
+
+    /// Messages currently buffered.
+    size_t buffer_depth = 0;
+    /// Largest number of messages buffered at once.
+    size_t peak_buffer_depth = 0;
+
+    /// Get the total number of rejected messages.
+    uint64_t rejected() const {
+        return rejected_buffer_full + rejected_late + rejected_out_of_order;
+    }
+
+    /// Get the total number of evicted messages.
+    uint64_t evicted() const {
+        return evicted_window + evicted_overflow + evicted_stale + evicted_expired +
+               evicted_unmatched;
+    }
+};
+
+/// Rate-control hints for one stream, see Synchronizer::feedback().
+struct StreamFeedback {
+    /// Topic name of the stream.
+    std::string topic;
+
+    /// The stream's buffer is full: its next message is rejected
+    /// (RejectNew) or evicts the oldest buffered one (DropOldest).
+    bool buffer_full = false;
+
+    /// New messages must be stamped after this to be accepted; negative if
+    /// any timestamp is. Set by the last emitted group or the stream's
+    /// newest message, whichever is later.
+    std::chrono::nanoseconds needed_after{-1};
+
+    /// Messages currently buffered.
+    size_t buffered = 0;
+};
+
+/// Snapshot of a synchronizer's counters and histograms.
+struct SyncStats {
+    /// Per-stream counters, indexed by stream.
+    std::vector<StreamStats> streams;
+
+    /// Groups delivered to the callback or the output queue.
+    uint64_t groups = 0;
+
+    /// Groups discarded from a full output queue (OutputPolicy::DropOldest)
+    /// or before reaching a callback thread (DispatchOrder::LatestOnly).
+    /// These are also counted in groups.
+    uint64_t groups_dropped = 0;
+
+    /// Time from the arrival of a group's earliest member until the group
+    /// is delivered to the callback, in wall-clock time.
+    Histogram latency;
+
+    /// Difference between the newest and oldest member timestamps of each
+    /// delivered group.
+    Histogram skew;
+};
+
+}  // namespace conflux
+
+#endif  // CONFLUX_STATS_HPP
@@ -0,0 +1,177 @@
+/*
+ * Conflux C++ Library - Sync Engine
+ *
+ * Hosts many independent synchronizer instances behind one ready queue and
+ * a shared pool of worker threads.
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#ifndef CONFLUX_SYNC_ENGINE_HPP
+#define CONFLUX_SYNC_ENGINE_HPP
+
+#include "conflux/stats.hpp"
+#include "conflux/types.hpp"
+#include "conflux/visibility.h"
+
+#include <any>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace conflux {
+
+/// Identifies an instance hosted by a SyncEngine.
+using InstanceId = uint32_t;
+
+/// Callback type for groups produced by a SyncEngine.
+using EngineCallback = std::function<void(InstanceId instance, const SyncGroup& group)>;
+
+/// Options for a SyncEngine.
+struct CONFLUX_EXPORT EngineOptions {
+    /// Number of worker threads started by SyncEngine::start() (default: 1).
+    size_t worker_count{1};
+
+    /// Maximum number of instances the engine can host (default: 1024).
+    ///
+    /// The instance table and the ready queue are allocated once at this
+    /// size, so adding instances never moves the ones already running.
+    size_t max_instances{1024};
+
+    /// Maximum number of groups delivered for one instance each time it is
+    /// scheduled (default: 64).
+    ///
+    /// An instance with more ready groups goes to the back of the ready
+    /// queue, so a burst on one instance cannot hold up the others.
+    size_t max_groups_per_turn{64};
+};
+
+/// Runs many independent synchronizers on shared threads.
+///
+/// Each instance has its own topics, Config and matching core, and behaves
+/// like a Synchronizer without subscriptions. Pushes queue their message
+/// in the instance's per-stream ring and put the instance on the engine's
+/// ready queue, unless it is already there. Workers take instances off the
+/// queue one at a time, move their rings into the core, and deliver ready
+/// groups tagged with the instance id. Instances that received nothing are
+/// never looked at, and since an instance is only ever on the queue once,
+/// it is matched by one thread at a time without a lock of its own.
+///
+/// Staleness is not tracked by timers per instance; call process_expired()
+/// from a single periodic timer instead. Config::eager_dispatch is ignored.
+///
+/// Example usage:
+/// ```cpp
+/// conflux::SyncEngine engine;
+///
+/// std::vector<conflux::InstanceId> vehicles;
+/// for (int v = 0; v < 300; ++v) {
+///     vehicles.push_back(engine.add_instance(config, {"/gps", "/can", "/imu"}));
+/// }
+///
+/// engine.on_synchronized([](conflux::InstanceId vehicle, const conflux::SyncGroup& group) {
+///     // Process the vehicle's group
+/// });
+/// engine.start();
+///
+/// engine.push_message(vehicles[v], 0, stamp_ns, std::any(gps_msg));
+/// ```
+class CONFLUX_EXPORT SyncEngine {
+public:
+    /// Create an engine. No threads are started until start().
+    explicit SyncEngine(const EngineOptions& options = EngineOptions());
+
+    /// Destructor. Stops the workers.
+    ~SyncEngine();
+
+    // Non-copyable
+    SyncEngine(const SyncEngine&) = delete;
+    SyncEngine& operator=(const SyncEngine&) = delete;
+
+    // Movable
+    SyncEngine(SyncEngine&&) noexcept;
+    SyncEngine& operator=(SyncEngine&&) noexcept;
+
+    /// Add an instance synchronizing the given topics.
+    ///
+    /// May be called at any time, also while workers are running. Instances
+    /// live as long as the engine. Throws std::runtime_error if the
+    /// configuration is invalid or EngineOptions::max_instances is reached.
+    ///
+    /// @param config Configuration of the instance
+    /// @param topics Topic names; each one's stream index is its position
+    /// @return The id tagging the instance's groups
+    InstanceId add_instance(const Config& config, const std::vector<std::string>& topics);
+
+    /// Mark a stream of an instance as optional, see
+    /// Synchronizer::set_optional(). Must be called before the first push
+    /// to the instance. Throws std::out_of_range for an unknown instance or
+    /// stream and std::runtime_error if the stream must stay required.
+    void set_optional(InstanceId instance, size_t stream_index, std::chrono::nanoseconds deadline);
+
+    /// Register the callback for groups of every instance.
+    ///
+    /// The callback runs on whichever thread matched the instance: a worker
+    /// or the caller of run_once(). With more than one worker, groups of
+    /// different instances are delivered concurrently, while the groups of
+    /// one instance are always delivered in order and never concurrently.
+    /// The callback must not throw and must not push to the engine. Must be
+    /// called before start().
+    void on_synchronized(EngineCallback callback);
+
+    /// Push a message to a stream of an instance. Safe from any thread.
+    /// Messages for unknown instances or streams are dropped.
+    ///
+    /// @param instance The id returned by add_instance()
+    /// @param stream_index The stream's position in the instance's topics
+    /// @param timestamp_ns The message timestamp in nanoseconds
+    /// @param message The message, typically a `std::shared_ptr<const T>`
+    void push_message(InstanceId instance, size_t stream_index, int64_t timestamp_ns,
+                      std::any message);
+
+    /// Match every instance that is ready so far on the calling thread.
+    ///
+    /// For engines run without start(), e.g. from an executor timer. May
+    /// also be called while workers are running, in which case it helps
+    /// them drain the ready queue.
+    ///
+    /// @return The number of groups delivered
+    size_t run_once();
+
+    /// Start EngineOptions::worker_count worker threads. Throws
+    /// std::runtime_error if already running.
+    void start();
+
+    /// Stop the workers and wait for them to exit. Instances still on the
+    /// ready queue stay there for run_once() or the next start(). Called by
+    /// the destructor.
+    void stop();
+
+    /// Check if the workers are running.
+    bool running() const;
+
+    /// Schedule stale message expiry on every instance with staleness
+    /// detection enabled. The expiry itself runs when the instance is next
+    /// matched, so no instance is touched by two threads at once.
+    void process_expired();
+
+    /// Get the number of instances.
+    size_t instance_count() const;
+
+    /// Get a snapshot of an instance's per-stream counters and group
+    /// histograms. Safe from any thread. Throws std::out_of_range for an
+    /// unknown instance.
+    SyncStats stats(InstanceId instance) const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace conflux
+
+#endif  // CONFLUX_SYNC_ENGINE_HPP
@@ -9,6 +9,9 @@
 #ifndef CONFLUX_SYNCHRONIZER_HPP
 #define CONFLUX_SYNCHRONIZER_HPP
 
+#include "conflux/detail/message_memory.hpp"
+#include "conflux/stats.hpp"
+#include "conflux/timestamp.hpp"
 #include "conflux/types.hpp"
 #include "conflux/visibility.h"
 
@@ -51,6 +54,13 @@ namespace conflux {
 ///     // Process synchronized messages
 /// });
 /// ```
+///
+/// Subscription callbacks may run on a MultiThreadedExecutor. Each stream
+/// queues its messages in its own ring, and whichever push finds the
+/// matcher idle drains all rings into the core, so callbacks for different
+/// topics run in parallel and only the matching itself is serialized.
+/// Groups are delivered on the thread that drains (eager dispatch) or that
+/// calls spin_once()/spin_some(), one group at a time.
 class CONFLUX_EXPORT Synchronizer {
 public:
     /// Create a new synchronizer with the given configuration.
@@ -70,64 +80,274 @@ public:
     /// Add a topic to synchronize.
     ///
     /// Creates a subscription for the given topic and registers it with
-    /// the synchronizer. The message type must have a `header` field with
-    /// a `stamp` member for timestamp extraction.
+    /// the synchronizer. Messages are timestamped by the extractor, by
+    /// default their `header.stamp`; see conflux/timestamp.hpp for the
+    /// receive time, fixed offsets, and custom extractors.
+    ///
+    /// Messages are kept as the `ConstSharedPtr` handed over by rclcpp, so
+    /// with intra-process communication the payload is never copied. Use
+    /// SyncGroup::get_shared<MsgT>() to keep a message beyond the callback.
+    /// The exception is a subscription that loans its messages from a
+    /// shared-memory middleware: rclcpp returns the loan as soon as the
+    /// subscription callback returns, so these messages are copied out of
+    /// the loan before they are buffered. Messages delivered while this
+    /// call is still creating the subscription are copied as well.
     ///
     /// @tparam MsgT The ROS2 message type
+    /// @tparam Extractor Timestamp extractor type (default: HeaderStamp)
     /// @param node The ROS2 node to create the subscription on
     /// @param topic The topic name to subscribe to
     /// @param qos QoS profile for the subscription (default: SensorDataQoS)
-    template <typename MsgT>
-    void add_subscription(rclcpp::Node::SharedPtr node, const std::string& topic,
-                          const rclcpp::QoS& qos = rclcpp::SensorDataQoS()) {
+    /// @param extractor Timestamp extractor, e.g. `conflux::ReceiveTime()`
+    /// @return The topic's stream index, for use with SyncGroup::get<MsgT>(index)
+    template <typename MsgT, typename Extractor = HeaderStamp>
+    size_t add_subscription(rclcpp::Node::SharedPtr node, const std::string& topic,
+                          const rclcpp::QoS& qos = rclcpp::SensorDataQoS(),
+                          Extractor extractor = Extractor()) {
         // Store topic for later initialization
-        add_topic(topic);
+        size_t stream_index = add_topic(topic);
+        set_node(node);
 
         // Create subscription
-        auto callback = [this, topic](typename MsgT::SharedPtr msg) {
-            // Extract timestamp from header
-            int64_t timestamp_ns = static_cast<int64_t>(msg->header.stamp.sec) * 1000000000LL +
-                                   static_cast<int64_t>(msg->header.stamp.nanosec);
+        auto source = std::make_shared<detail::MessageSource>(message_allocator(sizeof(MsgT)));
+        auto callback = [this, stream_index, extractor, source](
+                            typename MsgT::ConstSharedPtr msg, const rclcpp::MessageInfo& info) {
+            int64_t timestamp_ns = detail::extract_timestamp(extractor, *msg, info);
 
-            // Store message and push to synchronizer
-            push_message(topic, timestamp_ns, std::any(std::move(*msg)));
+            // Store the shared pointer, or a copy of a loan, and push to
+            // synchronizer
+            push_message(stream_index, timestamp_ns,
+                         std::any(source->own<MsgT>(std::move(msg))));
         };
 
-        auto sub = node->create_subscription<MsgT>(topic, qos, callback);
+        // Allocate messages as configured by Config::memory
+        rclcpp::SubscriptionBase::SharedPtr sub;
+        if (source->allocator()) {
+            rclcpp::SubscriptionOptionsWithAllocator<detail::MessageAllocator<void>> options;
+            options.allocator = source->allocator();
+            sub = node->create_subscription<MsgT>(topic, qos, callback, options);
+        } else {
+            sub = node->create_subscription<MsgT>(topic, qos, callback);
+        }
+        source->set_loaned(sub->can_loan_messages());
         subscriptions_.push_back(sub);
+        return stream_index;
     }
 
+    /// Add a topic whose messages are kept serialized.
+    ///
+    /// Creates an rclcpp::GenericSubscription, so the message type is only
+    /// needed at runtime and nothing is deserialized. The timestamp is read
+    /// from the `header.stamp` at the start of the CDR bytes (see
+    /// cdr::header_stamp_ns()), so the type must start with a
+    /// std_msgs/Header; messages whose stamp cannot be read are dropped.
+    /// Members are `std::shared_ptr<const rclcpp::SerializedMessage>`, e.g.
+    /// for republishing with a SerializedRelay.
+    ///
+    /// @param node The ROS2 node to create the subscription on
+    /// @param topic The topic name to subscribe to
+    /// @param type_name The message type, e.g. "sensor_msgs/msg/Image"
+    /// @param qos QoS profile for the subscription (default: SensorDataQoS)
+    /// @return The topic's stream index
+    size_t add_serialized_subscription(rclcpp::Node::SharedPtr node, const std::string& topic,
+                                       const std::string& type_name,
+                                       const rclcpp::QoS& qos = rclcpp::SensorDataQoS());
+
     /// Register a callback for synchronized message groups.
     ///
     /// The callback will be invoked each time a synchronized group is
     /// available. This also finalizes the synchronizer - no more topics
-    /// can be added after this call.
+    /// can be added after this call. To await groups from a C++20
+    /// coroutine instead, see GroupChannel in conflux/coroutine.hpp.
     ///
     /// @param callback Function to call with synchronized message groups
     void on_synchronized(SyncCallback callback);
 
+    /// Allocate everything the push, match and dispatch path needs, so
+    /// that steady-state operation performs no heap allocation.
+    ///
+    /// Meant for a lifecycle node's on_configure(), once the subscriptions
+    /// and the callback are registered: it finalizes the synchronizer, which
+    /// sizes the slot pools, rings, matcher buffers and group storage for
+    /// buffer_size messages per stream. start(), typically called from
+    /// on_activate(), sizes the output queue or callback threads' slots the
+    /// same way, and stop() belongs in on_deactivate(). Messages themselves
+    /// are allocated by rclcpp before they reach the synchronizer;
+    /// MemoryPreset::Pooled keeps the message objects, though not their
+    /// dynamically sized fields, off the global heap.
+    ///
+    /// When the library is built with CONFLUX_RT_CHECK, any heap allocation
+    /// on the synchronizer's push, match and dispatch path afterwards
+    /// aborts the process. The user callback is exempt. Throws
+    /// std::runtime_error if staleness is enabled, as expiry re-arms an
+    /// rclcpp timer, which allocates.
+    void preallocate();
+
     /// Process pending messages and invoke callbacks.
     ///
     /// Call this method periodically (e.g., from a timer) to check for
-    /// synchronized groups and invoke the registered callback.
+    /// synchronized groups and invoke the registered callback. Not needed
+    /// when Config::eager_dispatch is enabled.
     void spin_once();
 
+    /// Deliver at most max_groups ready groups and return how many were
+    /// delivered.
+    ///
+    /// Ready groups are fetched from the matcher in batches, which keeps
+    /// per-group overhead low when many groups complete at once, e.g.
+    /// when replaying a bag. Returns 0 when called from inside the
+    /// synchronized callback.
+    size_t spin_some(size_t max_groups);
+
+    /// Run the matcher on a dedicated thread until stop() is called.
+    ///
+    /// Pushes only queue their message and wake the worker, which matches
+    /// and delivers every ready group, so matching latency no longer depends
+    /// on what else the executor is busy with and no spin_once() timer is
+    /// needed. Depending on the options, groups go to the on_synchronized()
+    /// callback on the worker thread or on a pool of callback threads, or to
+    /// a bounded queue drained with pop_group(). The callback must not
+    /// throw. stop() waits for the callback threads to run the groups
+    /// already handed to them. Throws std::runtime_error if already running
+    /// or if the options are inconsistent.
+    ///
+    /// @param options Output queue, callback threads and their policies
+    void start(const WorkerOptions& options = WorkerOptions());
+
+    /// Stop the worker thread and wait for it to exit. Called by the
+    /// destructor.
+    ///
+    /// Messages pushed meanwhile are still matched into the output queue,
+    /// which is then closed; groups still queued can be popped until the
+    /// next start() discards them as SyncStats::groups_dropped. Groups
+    /// matched afterwards go to the on_synchronized() callback, if any, or
+    /// stay buffered until the next start().
+    void stop();
+
+    /// Check if the worker thread is running.
+    bool running() const;
+
+    /// Take the oldest group from the output queue, waiting up to timeout.
+    ///
+    /// Only one thread may pop at a time. The group's storage is reused, so
+    /// popping into the same group avoids allocations.
+    ///
+    /// @param group Receives the group's members
+    /// @param timeout How long to wait for a group (default: do not wait)
+    /// @return True if a group was taken; false on timeout, after stop(),
+    ///         or when start() was given no output queue
+    bool pop_group(SyncGroup& group,
+                   std::chrono::nanoseconds timeout = std::chrono::nanoseconds::zero());
+
+    /// Add a topic without creating a subscription.
+    ///
+    /// Messages for the topic are fed with push_message(), e.g. from a bag
+    /// reader or a custom transport.
+    ///
+    /// @param topic The topic name
+    /// @return The topic's stream index
+    size_t add_topic(const std::string& topic);
+
+    /// Mark a stream as optional.
+    ///
+    /// Groups stop waiting for an optional stream that has no message near
+    /// them once the newest buffered message on any stream is `deadline`
+    /// past the group, and are delivered without it; SyncGroup::has()
+    /// reports the member as missing. A sensor that drops out then no longer
+    /// stalls every group while the other buffers fill up. The deadline is
+    /// measured in message time, so bag replay behaves like live data. At
+    /// least one stream, and the pivot of MatchPolicy::Pivot, must stay
+    /// required. Must be called before on_synchronized().
+    ///
+    /// @param stream_index The index returned by add_topic() or add_subscription()
+    /// @param deadline How far the other streams may run ahead of a group
+    ///        before it is delivered without this stream
+    void set_optional(size_t stream_index, std::chrono::nanoseconds deadline);
+
+    /// Push a message to the stream at the given index.
+    ///
+    /// @param stream_index The index returned by add_topic() or add_subscription()
+    /// @param timestamp_ns The message timestamp in nanoseconds
+    /// @param message The message, typically a `std::shared_ptr<const T>`
+    void push_message(size_t stream_index, int64_t timestamp_ns, std::any message);
+
+    /// Push a message, waiting for buffer space instead of dropping it.
+    ///
+    /// Meant for offline pipelines such as bag replay, which can produce
+    /// messages faster than they are matched. With DropPolicy::RejectNew a
+    /// full buffer makes this wait until matching or eviction frees a slot:
+    /// ready groups are delivered on the calling thread unless a worker is
+    /// running, in which case the worker frees the space. Other drop
+    /// policies never wait. Must not be called from the on_synchronized()
+    /// callback.
+    ///
+    /// @param stream_index The index returned by add_topic() or add_subscription()
+    /// @param timestamp_ns The message timestamp in nanoseconds
+    /// @param message The message, typically a `std::shared_ptr<const T>`
+    /// @param timeout How long to wait for space (default: forever)
+    /// @return True if the message was accepted; false on timeout or if it
+    ///         was rejected as late or out of order
+    bool push_blocking(size_t stream_index, int64_t timestamp_ns, std::any message,
+                       std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max());
+
     /// Get the number of registered topics.
     size_t topic_count() const;
 
     /// Check if the synchronizer is ready (all buffers have messages).
     bool is_ready() const;
 
+    /// Get a snapshot of the per-stream counters and group histograms.
+    ///
+    /// Counters are kept in lock-free atomics, so this may be called from
+    /// any thread, e.g. a diagnostics timer, while messages are pushed.
+    SyncStats stats() const;
+
+    /// Get rate-control hints for every stream, indexed by stream.
+    ///
+    /// Lets a driver skip capturing messages that would be discarded, e.g.
+    /// frames for a stream whose buffer is full because it runs ahead of
+    /// the others, or frames stamped before needed_after. Messages still on
+    /// their way to the matcher are not counted yet. Safe from any thread.
+    std::vector<StreamFeedback> feedback() const;
+
+    /// Serialize the matching state into a compact binary blob.
+    ///
+    /// The snapshot holds the commit timestamp, each stream's last
+    /// timestamp and the buffered messages of serialized subscriptions (see
+    /// add_serialized_subscription()) with their CDR bytes. Other buffered
+    /// messages are left out, as their type is not known here. The blob
+    /// has no pointers, so it can be copied as is, e.g. into a shared
+    /// memory segment read by a standby process. Throws std::runtime_error
+    /// if called before on_synchronized().
+    std::vector<uint8_t> snapshot() const;
+
+    /// Restore a snapshot taken by an identically configured synchronizer.
+    ///
+    /// Buffers the snapshot's messages again and raises the commit and last
+    /// timestamps, so messages the previous instance had already emitted or
+    /// passed are rejected as late or out of order instead of forming
+    /// duplicate groups. Must be called after on_synchronized() and before
+    /// the first push. Throws std::runtime_error if the snapshot is
+    /// malformed, its topics differ, or messages were already pushed.
+    ///
+    /// @param data The snapshot bytes
+    /// @param size The number of bytes in data
+    void restore(const uint8_t* data, size_t size);
+
+    /// Restore a snapshot, see restore(const uint8_t*, size_t).
+    void restore(const std::vector<uint8_t>& snapshot);
+
 private:
-    /// Add a topic to the synchronizer (before finalization).
-    void add_topic(const std::string& topic);
+    /// Set the node used for staleness timers. The first node set is kept.
+    void set_node(const rclcpp::Node::SharedPtr& node);
+
+    /// Allocator for a subscription's messages, or nullptr for rclcpp's
+    /// default one.
+    std::shared_ptr<detail::MessageAllocator<void>> message_allocator(size_t message_size) const;
 
     /// Finalize the synchronizer (called by on_synchronized).
     void finalize();
 
-    /// Push a message to the synchronizer.
-    void push_message(const std::string& topic, int64_t timestamp_ns, std::any message);
-
     class Impl;
     std::unique_ptr<Impl> impl_;
     std::vector<rclcpp::SubscriptionBase::SharedPtr> subscriptions_;
@@ -0,0 +1,100 @@
+/*
+ * Conflux C++ Library - Timestamp Extractors
+ *
+ * Functors that pick the timestamp a subscribed message is synchronized by.
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#ifndef CONFLUX_TIMESTAMP_HPP
+#define CONFLUX_TIMESTAMP_HPP
+
+#include "rclcpp/rclcpp.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <type_traits>
+
+namespace conflux {
+
+// An extractor is any copyable functor returning the timestamp in
+// nanoseconds, called as `extractor(const MsgT&, const rclcpp::MessageInfo&)`
+// or, if it does not accept the message info, `extractor(const MsgT&)`. It
+// is a template parameter of the subscription, so the call is inlined.
+
+/// Use the message's `header.stamp` (the default).
+struct HeaderStamp {
+    template <typename MsgT>
+    int64_t operator()(const MsgT& msg) const {
+        return static_cast<int64_t>(msg.header.stamp.sec) * 1000000000LL +
+               static_cast<int64_t>(msg.header.stamp.nanosec);
+    }
+};
+
+/// Use the time the middleware received the message, for headerless types.
+///
+/// The receive time is taken from the system clock of the subscriber, so
+/// it includes transport latency and does not follow simulated time.
+struct ReceiveTime {
+    template <typename MsgT>
+    int64_t operator()(const MsgT&, const rclcpp::MessageInfo& info) const {
+        return static_cast<int64_t>(info.get_rmw_message_info().received_timestamp);
+    }
+};
+
+/// Use the time the publisher handed the message to the middleware.
+///
+/// Not every middleware fills this in; unsupported ones report zero.
+struct SourceTime {
+    template <typename MsgT>
+    int64_t operator()(const MsgT&, const rclcpp::MessageInfo& info) const {
+        return static_cast<int64_t>(info.get_rmw_message_info().source_timestamp);
+    }
+};
+
+namespace detail {
+
+/// Call an extractor with the message info if it accepts it.
+template <typename Extractor, typename MsgT>
+int64_t extract_timestamp(const Extractor& extractor, const MsgT& msg,
+                          const rclcpp::MessageInfo& info) {
+    if constexpr (std::is_invocable_r_v<int64_t, const Extractor&, const MsgT&,
+                                        const rclcpp::MessageInfo&>) {
+        return extractor(msg, info);
+    } else {
+        static_assert(std::is_invocable_r_v<int64_t, const Extractor&, const MsgT&>,
+                      "Extractor must accept (const MsgT&) or (const MsgT&, const MessageInfo&)");
+        return extractor(msg);
+    }
+}
+
+}  // namespace detail
+
+/// Shift the timestamps of another extractor by a fixed offset.
+///
+/// Corrects streams whose stamps are off by a known constant, e.g. a
+/// driver stamping frames at readout instead of exposure, so that a much
+/// smaller window_size matches them.
+template <typename Extractor>
+struct OffsetStamp {
+    Extractor extractor;
+    /// Added to every extracted timestamp; positive for stamps that lag.
+    std::chrono::nanoseconds offset;
+
+    template <typename MsgT>
+    int64_t operator()(const MsgT& msg, const rclcpp::MessageInfo& info) const {
+        return detail::extract_timestamp(extractor, msg, info) + offset.count();
+    }
+};
+
+/// Make an extractor that adds `offset` to the timestamps of `extractor`
+/// (default: the header stamp).
+template <typename Extractor = HeaderStamp>
+OffsetStamp<Extractor> with_offset(std::chrono::nanoseconds offset,
+                                   Extractor extractor = Extractor()) {
+    return OffsetStamp<Extractor>{std::move(extractor), offset};
+}
+
+}  // namespace conflux
+
+#endif  // CONFLUX_TIMESTAMP_HPP
@@ -0,0 +1,357 @@
+/*
+ * Conflux C++ Library - Typed Synchronizer
+ *
+ * Multi-stream message synchronization with stream types fixed at compile
+ * time.
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#ifndef CONFLUX_TYPED_SYNCHRONIZER_HPP
+#define CONFLUX_TYPED_SYNCHRONIZER_HPP
+
+#include "conflux/detail/deadline_timer.hpp"
+#include "conflux/detail/message_memory.hpp"
+#include "conflux/detail/slot_pool.hpp"
+#include "conflux/detail/sync_core.hpp"
+#include "conflux/timestamp.hpp"
+#include "conflux/types.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace conflux {
+
+/// Multi-stream message synchronizer with one message type per stream.
+///
+/// Works like Synchronizer, but the streams and their types are template
+/// parameters, so messages are kept in a typed pool per stream instead of
+/// std::any and groups are delivered as typed arguments. A stream is
+/// identified by its position in `MsgTs`. Unless the subscribing
+/// constructor is given timestamp extractors, each message type must have a
+/// `header` field with a `stamp` member.
+///
+/// Example usage:
+/// ```cpp
+/// using Sync = conflux::TypedSynchronizer<sensor_msgs::msg::Image, sensor_msgs::msg::Imu>;
+///
+/// Sync sync(node, {"/camera/image", "/imu"}, config);
+///
+/// sync.on_synchronized([](const sensor_msgs::msg::Image& image,
+///                         const sensor_msgs::msg::Imu& imu) {
+///     // Process synchronized messages
+/// });
+/// ```
+///
+/// The callback may instead take a `const std::tuple<MsgTs::ConstSharedPtr...>&`
+/// to keep the messages beyond the call.
+///
+/// Unlike Synchronizer, pushes are not synchronized; use a single-threaded
+/// executor or a mutually exclusive callback group for the subscriptions.
+template <typename... MsgTs>
+class TypedSynchronizer {
+    static_assert(sizeof...(MsgTs) > 0, "TypedSynchronizer needs at least one stream");
+
+public:
+    /// Number of synchronized streams.
+    static constexpr size_t kStreamCount = sizeof...(MsgTs);
+
+    /// Topic names, indexed by stream.
+    using Topics = std::array<std::string, kStreamCount>;
+
+    /// Message type of the stream at index I.
+    template <size_t I>
+    using MessageAt = std::tuple_element_t<I, std::tuple<MsgTs...>>;
+
+    /// Shared pointers to the members of a group, indexed by stream.
+    using SharedGroup = std::tuple<typename MsgTs::ConstSharedPtr...>;
+
+    /// Create a synchronizer without subscriptions. Messages are fed with
+    /// push().
+    explicit TypedSynchronizer(const Topics& topics, const Config& config = Config())
+        : config_(config),
+          topics_(topics),
+          pools_(make_pools(checked_capacity(config), Indices{})),
+          core_(config, std::vector<std::string>(topics.begin(), topics.end()),
+                &TypedSynchronizer::on_drop, this),
+          expiry_timer_([this]() { process_expired(); }) {}
+
+    /// Create a synchronizer and subscribe to each topic on the node.
+    ///
+    /// @param node The ROS2 node to create the subscriptions on
+    /// @param topics The topic name of each stream
+    /// @param config Synchronizer configuration
+    /// @param qos QoS profile for the subscriptions (default: SensorDataQoS)
+    TypedSynchronizer(rclcpp::Node::SharedPtr node, const Topics& topics,
+                      const Config& config = Config(),
+                      const rclcpp::QoS& qos = rclcpp::SensorDataQoS())
+        : TypedSynchronizer(std::move(node), topics, config, qos,
+                            std::tuple<HeaderStampFor<MsgTs>...>()) {}
+
+    /// Create a synchronizer and subscribe to each topic on the node, with
+    /// a timestamp extractor per stream.
+    ///
+    /// Example, for a headerless second stream:
+    /// ```cpp
+    /// Sync sync(node, {"/camera/image", "/count"}, config, rclcpp::SensorDataQoS(),
+    ///           std::make_tuple(conflux::HeaderStamp(), conflux::ReceiveTime()));
+    /// ```
+    ///
+    /// @param node The ROS2 node to create the subscriptions on
+    /// @param topics The topic name of each stream
+    /// @param config Synchronizer configuration
+    /// @param qos QoS profile for the subscriptions
+    /// @param extractors Timestamp extractor of each stream, e.g.
+    ///        `conflux::ReceiveTime()`
+    template <typename... Extractors>
+    TypedSynchronizer(rclcpp::Node::SharedPtr node, const Topics& topics, const Config& config,
+                      const rclcpp::QoS& qos, std::tuple<Extractors...> extractors)
+        : TypedSynchronizer(topics, config) {
+        static_assert(sizeof...(Extractors) == kStreamCount,
+                      "TypedSynchronizer needs one extractor per stream");
+        expiry_timer_.set_node(node);
+        subscribe(node, qos, std::move(extractors), Indices{});
+    }
+
+    // Subscriptions and the core refer back to this instance
+    TypedSynchronizer(const TypedSynchronizer&) = delete;
+    TypedSynchronizer& operator=(const TypedSynchronizer&) = delete;
+
+    /// Register a callback for synchronized message groups.
+    ///
+    /// The callback is invoked either as `callback(const MsgTs&...)` or as
+    /// `callback(const SharedGroup&)`, whichever it accepts.
+    template <typename Callback>
+    void on_synchronized(Callback callback) {
+        if constexpr (std::is_invocable_v<Callback&, const MsgTs&...>) {
+            callback_ = [callback = std::move(callback)](const SharedGroup& group) mutable {
+                std::apply([&](const auto&... members) { callback(*members...); }, group);
+            };
+        } else {
+            static_assert(std::is_invocable_v<Callback&, const SharedGroup&>,
+                          "Callback must accept (const MsgTs&...) or (const SharedGroup&)");
+            callback_ = std::move(callback);
+        }
+    }
+
+    /// Push a message to stream I, using the timestamp in its header.
+    template <size_t I>
+    void push(typename MessageAt<I>::ConstSharedPtr msg) {
+        int64_t timestamp_ns = HeaderStamp()(*msg);
+        push<I>(timestamp_ns, std::move(msg));
+    }
+
+    /// Push a message to stream I with an explicit timestamp.
+    template <size_t I>
+    void push(int64_t timestamp_ns, typename MessageAt<I>::ConstSharedPtr msg) {
+        static_assert(I < kStreamCount, "Stream index out of range");
+
+        auto& pool = *std::get<I>(pools_);
+
+        // Store the message; a full pool means the stream's buffer is full
+        auto handle = pool.acquire(std::move(msg));
+        if (!handle) {
+            return;
+        }
+
+        if (!core_.push(I, timestamp_ns, handle->to_user_data())) {
+            pool.release(*handle);
+            return;
+        }
+
+        // The newly pushed message may have completed a group
+        if (config_.eager_dispatch) {
+            spin_once();
+        }
+
+        schedule_expiry();
+    }
+
+    /// Process pending messages and invoke the callback for every ready
+    /// group. Not needed when Config::eager_dispatch is enabled.
+    void spin_once() {
+        if (!callback_ || dispatching_) {
+            return;
+        }
+
+        DispatchGuard guard(dispatching_);
+        while (dispatch_batch(kBatchSize) == kBatchSize) {
+        }
+    }
+
+    /// Deliver at most max_groups ready groups and return how many were
+    /// delivered. Returns 0 when called from inside the callback.
+    size_t spin_some(size_t max_groups) {
+        if (!callback_ || dispatching_ || max_groups == 0) {
+            return 0;
+        }
+
+        DispatchGuard guard(dispatching_);
+        return dispatch_batch(max_groups);
+    }
+
+    /// Get the topic name of each stream.
+    const Topics& topics() const { return topics_; }
+
+    /// Check if the synchronizer is ready (all buffers have messages).
+    bool is_ready() const { return core_.is_ready(); }
+
+private:
+    using Indices = std::index_sequence_for<MsgTs...>;
+
+    /// The default extractor, once per stream.
+    template <typename>
+    using HeaderStampFor = HeaderStamp;
+    using Pools = std::tuple<std::unique_ptr<detail::SlotPool<typename MsgTs::ConstSharedPtr>>...>;
+
+    /// Number of groups fetched per poll by spin_once().
+    static constexpr size_t kBatchSize = 64;
+
+    /// Marks the synchronizer as dispatching for the guard's lifetime.
+    struct DispatchGuard {
+        explicit DispatchGuard(bool& flag) : flag(flag) { flag = true; }
+        ~DispatchGuard() { flag = false; }
+        bool& flag;
+    };
+
+    /// Pool capacity for the configured buffer size. The extra slot holds a
+    /// message being pushed while the oldest one is still buffered.
+    static size_t checked_capacity(const Config& config) {
+        if (config.buffer_size + 1 > detail::SlotHandle::kSlotMask + 1) {
+            throw std::runtime_error("buffer_size too large");
+        }
+        return config.buffer_size + 1;
+    }
+
+    template <size_t... Is>
+    static Pools make_pools(size_t capacity, std::index_sequence<Is...>) {
+        return Pools(std::make_unique<detail::SlotPool<typename MsgTs::ConstSharedPtr>>(
+            static_cast<uint32_t>(Is), capacity)...);
+    }
+
+    template <typename Extractors, size_t... Is>
+    void subscribe(const rclcpp::Node::SharedPtr& node, const rclcpp::QoS& qos,
+                   Extractors extractors, std::index_sequence<Is...>) {
+        (subscribe_stream<Is>(node, qos, std::move(std::get<Is>(extractors))), ...);
+    }
+
+    template <size_t I, typename Extractor>
+    void subscribe_stream(const rclcpp::Node::SharedPtr& node, const rclcpp::QoS& qos,
+                          Extractor extractor) {
+        using MsgT = MessageAt<I>;
+        auto source = std::make_shared<detail::MessageSource>(
+            detail::make_message_allocator(config_, sizeof(MsgT)));
+        auto callback = [this, source, extractor](typename MsgT::ConstSharedPtr msg,
+                                                  const rclcpp::MessageInfo& info) {
+            int64_t timestamp_ns = detail::extract_timestamp(extractor, *msg, info);
+            this->template push<I>(timestamp_ns, source->own<MsgT>(std::move(msg)));
+        };
+        rclcpp::SubscriptionBase::SharedPtr sub;
+        if (source->allocator()) {
+            rclcpp::SubscriptionOptionsWithAllocator<detail::MessageAllocator<void>> options;
+            options.allocator = source->allocator();
+            sub = node->create_subscription<MsgT>(topics_[I], qos, callback, options);
+        } else {
+            sub = node->create_subscription<MsgT>(topics_[I], qos, callback);
+        }
+        source->set_loaned(sub->can_loan_messages());
+        subscriptions_.push_back(sub);
+    }
+
+    /// Arm the expiry timer to the next staleness deadline, if any.
+    void schedule_expiry() {
+        if (config_.staleness == StalenessPreset::Disabled) {
+            return;
+        }
+        int64_t delay_ns = core_.next_expiration_ns();
+        if (delay_ns >= 0) {
+            expiry_timer_.arm(std::chrono::nanoseconds(delay_ns));
+        }
+    }
+
+    /// Remove stale messages, then re-arm for the next deadline.
+    void process_expired() {
+        if (core_.process_expired() > 0 && config_.eager_dispatch) {
+            // Dropping a stale message may unblock a group
+            spin_once();
+        }
+        schedule_expiry();
+    }
+
+    /// Return a slot whose message will not be delivered.
+    template <size_t... Is>
+    void release(const detail::SlotHandle& handle, std::index_sequence<Is...>) {
+        ((handle.stream == Is ? std::get<Is>(pools_)->release(handle) : void()), ...);
+    }
+
+    static void on_drop(void* user_data, void* context) {
+        auto* self = static_cast<TypedSynchronizer*>(context);
+        self->release(detail::SlotHandle::from_user_data(user_data), Indices{});
+    }
+
+    /// Move the members of one group out of their pools.
+    template <size_t... Is>
+    std::optional<SharedGroup> take_group(const detail::SyncCore::Member* members,
+                                          std::index_sequence<Is...>) {
+        using detail::SlotHandle;
+        std::tuple<std::optional<typename MsgTs::ConstSharedPtr>...> taken{
+            std::get<Is>(pools_)->take(SlotHandle::from_user_data(members[Is].user_data))...};
+        if (!(std::get<Is>(taken) && ...)) {
+            return std::nullopt;
+        }
+        return SharedGroup(std::move(*std::get<Is>(taken))...);
+    }
+
+    /// Fetch up to max_groups ready groups and invoke the callback for each.
+    size_t dispatch_batch(size_t max_groups) {
+        if (batch_.size() < max_groups * kStreamCount) {
+            batch_.resize(max_groups * kStreamCount);
+        }
+
+        size_t count = core_.poll_batch(batch_.data(), max_groups);
+
+        size_t next = 0;
+        try {
+            for (; next < count; ++next) {
+                auto group = take_group(&batch_[next * kStreamCount], Indices{});
+                if (group) {
+                    callback_(*group);
+                }
+            }
+        } catch (...) {
+            // Release the members of groups that will not be delivered
+            for (size_t i = (next + 1) * kStreamCount; i < count * kStreamCount; ++i) {
+                release(detail::SlotHandle::from_user_data(batch_[i].user_data), Indices{});
+            }
+            throw;
+        }
+
+        return count;
+    }
+
+    Config config_;
+    Topics topics_;
+    Pools pools_;
+    detail::SyncCore core_;
+    std::function<void(const SharedGroup&)> callback_;
+    std::vector<detail::SyncCore::Member> batch_;
+    bool dispatching_ = false;
+    detail::DeadlineTimer expiry_timer_;
+    std::vector<rclcpp::SubscriptionBase::SharedPtr> subscriptions_;
+};
+
+}  // namespace conflux
+
+#endif  // CONFLUX_TYPED_SYNCHRONIZER_HPP
@@ -13,30 +13,234 @@
 #include <chrono>
 #include <functional>
 #include <memory>
+#include <memory_resource>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 namespace conflux {
 
+/// Policy for handling buffer overflow when pushing new messages.
+enum class DropPolicy {
+    /// Reject new messages when the buffer is full.
+    /// Preserves existing data. Suitable for offline/rosbag processing.
+    RejectNew,
+
+    /// Drop the oldest message to make room for the new one.
+    /// Always accepts new data. Suitable for realtime processing.
+    DropOldest,
+};
+
+/// Staleness detection preset.
+enum class StalenessPreset {
+    /// No staleness detection.
+    Disabled,
+    /// Balanced defaults.
+    Default,
+    /// Sub-millisecond precision for high-rate streams.
+    HighFrequency,
+    /// Millisecond precision for low-rate streams.
+    LowFrequency,
+    /// Relaxed precision for offline processing.
+    BatchProcessing,
+};
+
+/// Algorithm used to form groups.
+///
+/// With Window, a group is only emitted once every buffer holds a message a
+/// full window past the oldest front, so every group waits out the window.
+/// The other policies emit as soon as the best group can no longer change,
+/// which for sparse or periodic streams is typically one sample period.
+/// The window still bounds every group's spread.
+enum class MatchPolicy {
+    /// Group messages that fit within the time window (the default).
+    Window,
+
+    /// Pick one message per stream minimizing the group's spread, once every
+    /// stream holds a message at or after the latest front message.
+    Approximate,
+
+    /// Pair each message of Config::pivot_stream with the nearest message of
+    /// every other stream, once each of them has a message at or after it.
+    /// Pivot messages with no partner within the window are evicted as
+    /// unmatched.
+    Pivot,
+};
+
+/// Policy for a full output queue (see Synchronizer::start()).
+enum class OutputPolicy {
+    /// Wait for the consumer to make room. Matching pauses meanwhile, so
+    /// the input buffers fill and their drop policy applies.
+    Block,
+
+    /// Discard the oldest queued group to make room for the new one.
+    DropOldest,
+};
+
+/// Where messages received by typed subscriptions are allocated.
+enum class MemoryPreset {
+    /// rclcpp's default allocator, i.e. the global heap.
+    Default,
+    /// A pre-faulted pool per subscription, sized for twice buffer_size
+    /// message objects, which come and go in any order without fragmenting
+    /// the heap. Their dynamically sized fields, such as an image's data,
+    /// still use the global heap, so the footprint is not bounded.
+    Pooled,
+};
+
+/// Order in which groups are handed to callback threads (see
+/// WorkerOptions::callback_threads).
+enum class DispatchOrder {
+    /// Deliver every group, handed out in the order they were matched.
+    /// Each callback thread runs its groups in that order, but groups on
+    /// different threads overlap and may finish out of order. When every
+    /// thread has a backlog, matching pauses as with OutputPolicy::Block.
+    InOrder,
+
+    /// Keep at most one waiting group per callback thread, discarding the
+    /// oldest waiting group for a new one, so a free thread always gets the
+    /// freshest data. Discarded groups count as SyncStats::groups_dropped.
+    LatestOnly,
+};
+
+/// Options for running the matcher on a dedicated thread.
+struct CONFLUX_EXPORT WorkerOptions {
+    /// Capacity of the output queue (default: 0).
+    ///
+    /// With 0, groups are delivered to the on_synchronized() callback on the
+    /// worker thread. Otherwise they are queued for Synchronizer::pop_group().
+    size_t output_capacity{0};
+
+    /// Policy when the output queue is full (default: Block).
+    OutputPolicy output_policy{OutputPolicy::Block};
+
+    /// Number of threads running the on_synchronized() callback
+    /// (default: 0).
+    ///
+    /// With 0, the callback runs on the worker thread, so a slow callback
+    /// holds up matching. Otherwise groups are handed to a pool of this
+    /// many threads, each with its own queue; an idle thread steals the
+    /// oldest group from a busy one. The callback may then run on several
+    /// threads at once. Cannot be combined with output_capacity.
+    size_t callback_threads{0};
+
+    /// Order in which groups reach the callback threads (default: InOrder).
+    DispatchOrder dispatch_order{DispatchOrder::InOrder};
+};
+
 /// Configuration for the synchronizer.
 struct CONFLUX_EXPORT Config {
     /// Time window for grouping messages (default: 50ms).
-    std::chrono::milliseconds window_size{50};
+    ///
+    /// Nanosecond resolution, so windows of a few milliseconds or less can be
+    /// expressed; assigning std::chrono::milliseconds works as before. A zero
+    /// window is treated as infinite.
+    std::chrono::nanoseconds window_size{std::chrono::milliseconds(50)};
+
+    /// Match messages without a time window (default: false).
+    ///
+    /// When enabled, window_size is ignored and messages are never dropped
+    /// for falling outside the window.
+    bool infinite_window{false};
 
     /// Maximum number of messages to buffer per stream (default: 64).
     size_t buffer_size{64};
+
+    /// Policy for handling buffer overflow (default: RejectNew).
+    DropPolicy drop_policy{DropPolicy::RejectNew};
+
+    /// Expire messages that stay buffered too long (default: Disabled).
+    ///
+    /// Staleness is measured in wall-clock time from when a message is
+    /// pushed, so a stalled stream no longer pins the other streams' messages
+    /// until their buffers fill. Expiry runs from a one-shot timer on the
+    /// subscriptions' node, armed to the next deadline.
+    StalenessPreset staleness{StalenessPreset::Disabled};
+
+    /// How long a message may stay buffered before it is stale
+    /// (default: 0, meaning window_size, or 60 s for an infinite window).
+    std::chrono::nanoseconds staleness_timeout{0};
+
+    /// Allocation of messages received by typed subscriptions
+    /// (default: Default).
+    ///
+    /// Only the message objects themselves are allocated this way: their
+    /// dynamically sized fields, such as an image's data, use the allocator
+    /// of the message type. Ignored when memory_resource is set.
+    MemoryPreset memory{MemoryPreset::Default};
+
+    /// Memory resource for messages received by typed subscriptions
+    /// (default: none).
+    ///
+    /// Takes precedence over the memory preset. The resource is not owned
+    /// and must outlive every message allocated from it, including those a
+    /// callback keeps. It must be thread-safe, e.g. a
+    /// std::pmr::synchronized_pool_resource: messages are allocated on the
+    /// executor's threads and freed on whichever thread drops the last
+    /// reference.
+    std::pmr::memory_resource* memory_resource{nullptr};
+
+    /// Algorithm used to form groups (default: Window).
+    MatchPolicy match_policy{MatchPolicy::Window};
+
+    /// Stream index of the reference stream for MatchPolicy::Pivot
+    /// (default: 0, the first registered topic).
+    size_t pivot_stream{0};
+
+    /// Dispatch groups from the push path as soon as they complete
+    /// (default: false).
+    ///
+    /// When enabled, every accepted message immediately triggers matching
+    /// and the callback runs on the subscription's thread, so no polling
+    /// timer is needed. When disabled, groups are only delivered by
+    /// Synchronizer::spin_once().
+    bool eager_dispatch{false};
 };
 
+namespace detail {
+class MatchingCore;
+}  // namespace detail
+
 /// A synchronized group of messages from multiple streams.
 ///
-/// Each message is stored with its original type using std::any.
-/// Use get<T>() to retrieve messages with type safety.
+/// Members are stored in a flat array indexed by stream, in the order the
+/// topics were registered, so lookups by index are O(1) and filling a group
+/// allocates nothing. The synchronizer reuses one group across callbacks;
+/// copy it to keep it beyond the callback.
+///
+/// Each message is stored type-erased in std::any. Subscriptions store the
+/// `std::shared_ptr<const T>` delivered by rclcpp, so no payload is copied
+/// between the subscription callback and the group callback.
+/// Use get<T>() or get_shared<T>() to retrieve messages with type safety.
 class CONFLUX_EXPORT SyncGroup {
 public:
-    /// Get the timestamp of this synchronized group.
+    /// Get the timestamp of this synchronized group, which is the timestamp
+    /// of its earliest member.
     std::chrono::nanoseconds timestamp() const { return timestamp_; }
 
+    /// Get the timestamp of the member at a stream index.
+    ///
+    /// @return The member's timestamp, or zero if the member is absent
+    std::chrono::nanoseconds timestamp(size_t index) const {
+        return has(index) ? members_[index].timestamp : std::chrono::nanoseconds{0};
+    }
+
+    /// Get a message by stream index.
+    ///
+    /// @tparam T The message type (e.g., sensor_msgs::msg::Image)
+    /// @param index The stream index, in topic registration order
+    /// @return Pointer to the message, or nullptr if absent or wrong type
+    template <typename T>
+    const T* get(size_t index) const {
+        if (!has(index)) {
+            return nullptr;
+        }
+        const std::any& message = members_[index].message;
+        if (auto* shared = std::any_cast<std::shared_ptr<const T>>(&message)) {
+            return shared->get();
+        }
+        return std::any_cast<T>(&message);
+    }
+
     /// Get a message by topic name.
     ///
     /// @tparam T The message type (e.g., sensor_msgs::msg::Image)
@@ -44,34 +248,119 @@ public:
     /// @return Pointer to the message, or nullptr if not found or wrong type
     template <typename T>
     const T* get(const std::string& topic) const {
-        auto it = messages_.find(topic);
-        if (it == messages_.end()) {
+        return get<T>(index_of(topic));
+    }
+
+    /// Get a shared pointer to a message by stream index.
+    ///
+    /// The returned pointer shares ownership with the message delivered by
+    /// the subscription, so it can outlive the group without a copy.
+    ///
+    /// @tparam T The message type (e.g., sensor_msgs::msg::Image)
+    /// @param index The stream index, in topic registration order
+    /// @return Shared pointer to the message, or nullptr if absent, wrong
+    ///         type, or the message was pushed by value
+    template <typename T>
+    std::shared_ptr<const T> get_shared(size_t index) const {
+        if (!has(index)) {
             return nullptr;
         }
-        return std::any_cast<T>(&it->second);
+        if (auto* shared = std::any_cast<std::shared_ptr<const T>>(&members_[index].message)) {
+            return *shared;
+        }
+        return nullptr;
+    }
+
+    /// Get a shared pointer to a message by topic name.
+    ///
+    /// @tparam T The message type (e.g., sensor_msgs::msg::Image)
+    /// @param topic The topic name
+    /// @return Shared pointer to the message, or nullptr if not found, wrong
+    ///         type, or the message was pushed by value
+    template <typename T>
+    std::shared_ptr<const T> get_shared(const std::string& topic) const {
+        return get_shared<T>(index_of(topic));
     }
 
+    /// Check if the member at a stream index is present in this group.
+    bool has(size_t index) const { return index < members_.size() && members_[index].present; }
+
     /// Check if a topic exists in this group.
-    bool has(const std::string& topic) const { return messages_.find(topic) != messages_.end(); }
-
-    /// Get all topic names in this group.
-    std::vector<std::string> topics() const {
-        std::vector<std::string> result;
-        result.reserve(messages_.size());
-        for (const auto& [topic, _] : messages_) {
-            result.push_back(topic);
+    bool has(const std::string& topic) const { return has(index_of(topic)); }
+
+    /// Get the stream index of a topic, or npos if it is not registered.
+    size_t index_of(const std::string& topic) const {
+        if (topics_) {
+            for (size_t i = 0; i < topics_->size(); ++i) {
+                if ((*topics_)[i] == topic) {
+                    return i;
+                }
+            }
         }
-        return result;
+        return npos;
+    }
+
+    /// Get all registered topic names, indexed by stream.
+    const std::vector<std::string>& topics() const {
+        static const std::vector<std::string> empty;
+        return topics_ ? *topics_ : empty;
     }
 
     /// Get the number of messages in this group.
-    size_t size() const { return messages_.size(); }
+    size_t size() const { return size_; }
+
+    /// Index returned by index_of() for unknown topics.
+    static constexpr size_t npos = static_cast<size_t>(-1);
 
 private:
     friend class Synchronizer;
+    friend class detail::MatchingCore;
+
+    struct Member {
+        std::any message;
+        std::chrono::nanoseconds timestamp{0};
+        bool present = false;
+    };
+
+    /// Store the message of a member that is not yet present.
+    void set(size_t index, std::chrono::nanoseconds timestamp, std::any message) {
+        Member& member = members_[index];
+        member.message = std::move(message);
+        member.timestamp = timestamp;
+        member.present = true;
+        if (size_ == 0 || timestamp < timestamp_) {
+            timestamp_ = timestamp;
+        }
+        ++size_;
+    }
+
+    /// Move the members of another group into this one, reusing this
+    /// group's storage, and leave the other group empty.
+    void take(SyncGroup& other) {
+        topics_ = other.topics_;
+        members_.resize(other.members_.size());
+        for (size_t i = 0; i < members_.size(); ++i) {
+            members_[i] = std::move(other.members_[i]);
+        }
+        timestamp_ = other.timestamp_;
+        size_ = other.size_;
+        other.clear();
+    }
+
+    /// Release all members, keeping the storage for reuse.
+    void clear() {
+        for (Member& member : members_) {
+            member.message.reset();
+            member.present = false;
+        }
+        timestamp_ = std::chrono::nanoseconds{0};
+        size_ = 0;
+    }
 
-    std::chrono::nanoseconds timestamp_;
-    std::unordered_map<std::string, std::any> messages_;
+    std::shared_ptr<const std::vector<std::string>> topics_;
+    std::vector<Member> members_;
+    std::chrono::nanoseconds timestamp_{0};
+    size_t size_ = 0;
 };
 
 /// Callback type for synchronized message groups.
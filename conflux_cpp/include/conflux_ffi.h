@@ -18,6 +18,12 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+/**
+ * Stream index written by `conflux_poll_batch` for a stream missing from a
+ * partial group.
+ */
+#define CONFLUX_ABSENT_MEMBER UINTPTR_MAX
+
 /**
  * Policy for handling buffer overflow when pushing new messages.
  */
@@ -34,6 +40,82 @@ typedef enum ConfluxDropPolicy {
     ConfluxDropPolicy_DropOldest = 1,
 } ConfluxDropPolicy;
 
+/**
+ * Algorithm used to form groups.
+ */
+typedef enum ConfluxMatchPolicy {
+    /**
+     * Group messages that fit within the time window, once the buffers
+     * span a full window.
+     */
+    ConfluxMatchPolicy_Window = 0,
+    /**
+     * Pick one message per stream with minimal spread, as soon as every
+     * stream has a message at or after the latest front message.
+     */
+    ConfluxMatchPolicy_Approximate = 1,
+    /**
+     * Pair each message of the stream at `pivot_index` with the nearest
+     * message of every other stream, as soon as it is bracketed.
+     */
+    ConfluxMatchPolicy_Pivot = 2,
+} ConfluxMatchPolicy;
+
+/**
+ * Staleness detection preset.
+ *
+ * Stale messages are expired by wall-clock time; the caller drives expiry
+ * with `conflux_next_expiration_ns` and `conflux_process_expired`.
+ */
+typedef enum ConfluxStalenessPreset {
+    /**
+     * No staleness detection.
+     */
+    ConfluxStalenessPreset_Disabled = 0,
+    /**
+     * Balanced defaults.
+     */
+    ConfluxStalenessPreset_Default = 1,
+    /**
+     * Sub-millisecond precision for high-rate streams.
+     */
+    ConfluxStalenessPreset_HighFrequency = 2,
+    /**
+     * Millisecond precision for low-rate streams.
+     */
+    ConfluxStalenessPreset_LowFrequency = 3,
+    /**
+     * Relaxed precision for offline processing.
+     */
+    ConfluxStalenessPreset_BatchProcessing = 4,
+} ConfluxStalenessPreset;
+
+/**
+ * Reason a buffered message was discarded without being emitted.
+ */
+typedef enum ConfluxDropReason {
+    /**
+     * Fell before the time window of a match.
+     */
+    ConfluxDropReason_Window = 0,
+    /**
+     * Evicted by `DropOldest` to make room for a newer message.
+     */
+    ConfluxDropReason_Overflow = 1,
+    /**
+     * Expired by the staleness detector.
+     */
+    ConfluxDropReason_Stale = 2,
+    /**
+     * Expired by its own timeout.
+     */
+    ConfluxDropReason_Expired = 3,
+    /**
+     * Dropped because no group could be formed.
+     */
+    ConfluxDropReason_Unmatched = 4,
+} ConfluxDropReason;
+
 /**
  * Result codes for FFI operations.
  */
@@ -62,6 +144,15 @@ typedef enum ConfluxResult {
      * Internal error.
      */
     ConfluxResult_InternalError = 5,
+    /**
+     * Message timestamp is before the last emitted group, message rejected.
+     */
+    ConfluxResult_LateMessage = 6,
+    /**
+     * Message timestamp is not after the stream's newest message, message
+     * rejected.
+     */
+    ConfluxResult_OutOfOrder = 7,
 } ConfluxResult;
 
 /**
@@ -69,6 +160,8 @@ typedef enum ConfluxResult {
  *
  * The synchronizer manages multiple message streams and outputs
  * synchronized groups when messages fall within the configured time window.
+ * Streams are identified by their index in the `keys` array given at
+ * creation; the name-based functions resolve names to these indices.
  */
 typedef struct ConfluxSynchronizer ConfluxSynchronizer;
 
@@ -78,7 +171,8 @@ typedef struct ConfluxSynchronizer ConfluxSynchronizer;
 typedef struct ConfluxConfig {
     /**
      * Time window in milliseconds for grouping messages.
-     * Use 0 for infinite window (no time-based dropping).
+     * Use 0 for infinite window (no time-based dropping) when
+     * `window_size_ns` is also 0.
      */
     uint64_t window_size_ms;
     /**
@@ -89,8 +183,70 @@ typedef struct ConfluxConfig {
      * Policy for handling buffer overflow.
      */
     enum ConfluxDropPolicy drop_policy;
+    /**
+     * Time window in nanoseconds for grouping messages.
+     * Overrides `window_size_ms` when nonzero.
+     */
+    uint64_t window_size_ns;
+    /**
+     * Staleness detection preset.
+     */
+    enum ConfluxStalenessPreset staleness;
+    /**
+     * Time in nanoseconds a message may stay buffered before it is stale.
+     * Use 0 to use the time window, or 60 seconds for an infinite window.
+     */
+    uint64_t staleness_timeout_ns;
+    /**
+     * Algorithm used to form groups.
+     */
+    enum ConfluxMatchPolicy match_policy;
+    /**
+     * Stream index of the reference stream for `ConfluxMatchPolicy::Pivot`.
+     */
+    uintptr_t pivot_index;
 } ConfluxConfig;
 
+/**
+ * One member of a synchronized group, as written by `conflux_poll_batch`.
+ */
+typedef struct ConfluxGroupMember {
+    /**
+     * Stream index of the member.
+     */
+    uintptr_t stream_index;
+    /**
+     * Message timestamp in nanoseconds.
+     */
+    int64_t timestamp_ns;
+    /**
+     * The user data pointer passed when pushing.
+     */
+    void* user_data;
+} ConfluxGroupMember;
+
+/**
+ * Rate-control feedback for one stream, as written by
+ * `conflux_get_feedback`.
+ */
+typedef struct ConfluxStreamFeedback {
+    /**
+     * The stream's buffer is full: a new message is rejected with
+     * `RejectNew`, or evicts the oldest one with `DropOldest`.
+     */
+    bool buffer_full;
+    /**
+     * New messages must be stamped after this to be accepted, in
+     * nanoseconds; -1 if any timestamp is. Set by the last emitted group or
+     * the stream's newest message, whichever is later.
+     */
+    int64_t needed_after_ns;
+    /**
+     * Number of messages buffered for the stream.
+     */
+    uintptr_t buffered;
+} ConfluxStreamFeedback;
+
 #ifdef __cplusplus
 extern "C" {
 #endif  // __cplusplus
@@ -98,6 +254,10 @@ extern "C" {
 /**
  * Create a new synchronizer with the given configuration and keys.
  *
+ * Each key is assigned the stream index of its position in `keys`, starting
+ * at 0. The indices are stable for the lifetime of the synchronizer and can
+ * be used with `conflux_push_message_by_index` and `conflux_poll_indexed`.
+ *
  * # Safety
  *
  * - `keys` must be an array of `key_count` valid null-terminated C strings.
@@ -130,11 +290,61 @@ void conflux_synchronizer_free(struct ConfluxSynchronizer* sync);
  *
  * - `ConfluxResult::Ok` if the message was accepted.
  * - `ConfluxResult::BufferFull` if the buffer for this key is full.
+ * - `ConfluxResult::LateMessage` if the timestamp is before the last
+ *   emitted group.
+ * - `ConfluxResult::OutOfOrder` if the timestamp is not after the newest
+ *   message of the key.
  * - `ConfluxResult::KeyNotFound` if the key was not provided at creation.
  */
 enum ConfluxResult conflux_push_message(struct ConfluxSynchronizer* sync, const char* key,
                                         int64_t timestamp_ns, void* user_data);
 
+/**
+ * Push a message to the stream at the given index.
+ *
+ * Equivalent to `conflux_push_message` without the key lookup.
+ *
+ * # Safety
+ *
+ * - `sync` must be a valid pointer from `conflux_synchronizer_new`.
+ * - `user_data` is an opaque pointer that will be returned in synchronized groups.
+ *
+ * # Returns
+ *
+ * - `ConfluxResult::Ok` if the message was accepted.
+ * - `ConfluxResult::BufferFull` if the buffer for this stream is full.
+ * - `ConfluxResult::LateMessage` if the timestamp is before the last
+ *   emitted group.
+ * - `ConfluxResult::OutOfOrder` if the timestamp is not after the newest
+ *   message of the stream.
+ * - `ConfluxResult::KeyNotFound` if `index` is not less than the key count.
+ */
+enum ConfluxResult conflux_push_message_by_index(struct ConfluxSynchronizer* sync, uintptr_t index,
+                                                 int64_t timestamp_ns, void* user_data);
+
+/**
+ * Mark the stream at the given index as optional.
+ *
+ * Groups no longer wait indefinitely for an optional stream: once the
+ * newest buffered message on any stream is `deadline_ns` past a group
+ * without a usable message from it, the group is emitted without that
+ * member. Poll functions then simply omit the stream; `conflux_poll_batch`
+ * marks it with `CONFLUX_ABSENT_MEMBER`. Call this before pushing messages.
+ *
+ * # Safety
+ *
+ * - `sync` must be a valid pointer from `conflux_synchronizer_new`.
+ *
+ * # Returns
+ *
+ * - `ConfluxResult::Ok` if the stream is now optional.
+ * - `ConfluxResult::KeyNotFound` if `index` is not less than the key count.
+ * - `ConfluxResult::InvalidArgument` if the stream is the pivot of
+ *   `ConfluxMatchPolicy::Pivot` or the last required stream.
+ */
+enum ConfluxResult conflux_set_optional(struct ConfluxSynchronizer* sync, uintptr_t index,
+                                        uint64_t deadline_ns);
+
 /**
  * Poll for a synchronized group of messages.
  *
@@ -166,6 +376,124 @@ int32_t conflux_poll(struct ConfluxSynchronizer* sync,
                                       void* context),
                      void* context);
 
+/**
+ * Poll for a synchronized group of messages, reporting stream indices.
+ *
+ * Equivalent to `conflux_poll`, but the callback receives the stream index
+ * instead of the key name.
+ *
+ * # Safety
+ *
+ * - `sync` must be a valid pointer from `conflux_synchronizer_new`.
+ * - `callback` will be called with each member of the synchronized group.
+ * - `context` is passed through to the callback.
+ *
+ * # Callback
+ *
+ * The callback receives:
+ * - `index`: The stream index of the member
+ * - `timestamp_ns`: Message timestamp in nanoseconds
+ * - `user_data`: The user data pointer passed when pushing
+ * - `context`: The context pointer passed to this function
+ *
+ * # Returns
+ *
+ * - 1 if a synchronized group was found and callback was invoked.
+ * - 0 if no synchronized group is available.
+ * - -1 on error.
+ */
+int32_t conflux_poll_indexed(struct ConfluxSynchronizer* sync,
+                             void (*callback)(uintptr_t index, int64_t timestamp_ns,
+                                              void* user_data, void* context),
+                             void* context);
+
+/**
+ * Poll for up to `max_groups` synchronized groups in one call.
+ *
+ * Groups are written to `members` in the order they are matched. Group `g`
+ * occupies records `g * key_count` through `(g + 1) * key_count - 1`, with
+ * each member stored at the offset of its stream index. Records of
+ * optional streams missing from a group have `stream_index` set to
+ * `CONFLUX_ABSENT_MEMBER` and a null `user_data`.
+ *
+ * # Safety
+ *
+ * - `sync` must be a valid pointer from `conflux_synchronizer_new`.
+ * - `members` must point to at least `max_groups * key_count` writable
+ *   records, where `key_count` is the value of `conflux_key_count`.
+ *
+ * # Returns
+ *
+ * - The number of groups written, between 0 and `max_groups`.
+ * - -1 on error.
+ */
+intptr_t conflux_poll_batch(struct ConfluxSynchronizer* sync, struct ConfluxGroupMember* members,
+                            uintptr_t max_groups);
+
+/**
+ * Register a callback for messages discarded without being emitted.
+ *
+ * Once set, every message evicted from a buffer (window drops during
+ * matching, `DropOldest` overflow, or expiration) is reported exactly once,
+ * so the caller can release whatever `user_data` refers to. Messages
+ * rejected by `conflux_push_message` are not reported; the caller learns
+ * about them from its return value. Pass a null callback to disable
+ * reporting.
+ *
+ * # Safety
+ *
+ * - `sync` must be a valid pointer from `conflux_synchronizer_new`.
+ * - `context` is passed through to the callback and must stay valid while
+ *   the callback is registered.
+ *
+ * # Callback
+ *
+ * The callback receives:
+ * - `timestamp_ns`: Message timestamp in nanoseconds
+ * - `user_data`: The user data pointer passed to `conflux_push_message`
+ * - `reason`: Why the message was discarded
+ * - `context`: The context pointer passed to this function
+ *
+ * The callback is invoked from within `conflux_push_message` and
+ * `conflux_poll` and must not call back into the synchronizer.
+ */
+enum ConfluxResult conflux_set_drop_callback(struct ConfluxSynchronizer* sync,
+                                             void (*callback)(int64_t timestamp_ns, void* user_data,
+                                                              enum ConfluxDropReason reason,
+                                                              void* context),
+                                             void* context);
+
+/**
+ * Get the time until the next staleness deadline.
+ *
+ * # Safety
+ *
+ * `sync` must be a valid pointer from `conflux_synchronizer_new`.
+ *
+ * # Returns
+ *
+ * - Nanoseconds until `conflux_process_expired` should be called, or 0 if
+ *   the deadline has already passed.
+ * - -1 if staleness detection is disabled or no message is tracked.
+ */
+int64_t conflux_next_expiration_ns(const struct ConfluxSynchronizer* sync);
+
+/**
+ * Remove messages whose staleness deadline has passed.
+ *
+ * Removed messages are reported to the drop callback with
+ * `ConfluxDropReason::Stale`.
+ *
+ * # Safety
+ *
+ * `sync` must be a valid pointer from `conflux_synchronizer_new`.
+ *
+ * # Returns
+ *
+ * The number of messages removed.
+ */
+uintptr_t conflux_process_expired(struct ConfluxSynchronizer* sync);
+
 /**
  * Get the number of keys registered with the synchronizer.
  *
@@ -175,6 +503,20 @@ int32_t conflux_poll(struct ConfluxSynchronizer* sync,
  */
 uintptr_t conflux_key_count(const struct ConfluxSynchronizer* sync);
 
+/**
+ * Get the stream index of a key.
+ *
+ * # Safety
+ *
+ * - `sync` must be a valid pointer from `conflux_synchronizer_new`.
+ * - `key` must be a valid null-terminated C string.
+ *
+ * # Returns
+ *
+ * The stream index, or -1 if the key is not found.
+ */
+intptr_t conflux_key_index(const struct ConfluxSynchronizer* sync, const char* key);
+
 /**
  * Check if the synchronizer is ready (all buffers have at least 2 messages).
  *
@@ -207,6 +549,81 @@ bool conflux_is_empty(const struct ConfluxSynchronizer* sync);
  */
 uintptr_t conflux_buffer_len(const struct ConfluxSynchronizer* sync, const char* key);
 
+/**
+ * Get rate-control feedback for every stream.
+ *
+ * Lets producers skip capturing messages that would be rejected, e.g. for
+ * a stream running ahead of the others whose buffer is full.
+ *
+ * # Safety
+ *
+ * - `sync` must be a valid pointer from `conflux_synchronizer_new`.
+ * - `feedback` must point to an array of at least `max_streams` elements.
+ *
+ * # Returns
+ *
+ * The number of streams written, in stream index order.
+ */
+uintptr_t conflux_get_feedback(const struct ConfluxSynchronizer* sync,
+                               struct ConfluxStreamFeedback* feedback,
+                               uintptr_t max_streams);
+
+/**
+ * Get the commit timestamp: messages stamped at or before it are
+ * rejected as late.
+ *
+ * # Safety
+ *
+ * `sync` must be a valid pointer from `conflux_synchronizer_new`.
+ *
+ * # Returns
+ *
+ * The commit timestamp in nanoseconds, or -1 if no group has been emitted.
+ */
+int64_t conflux_commit_timestamp_ns(const struct ConfluxSynchronizer* sync);
+
+/**
+ * Copy the messages buffered for a stream, oldest first, without
+ * removing them.
+ *
+ * # Safety
+ *
+ * - `sync` must be a valid pointer from `conflux_synchronizer_new`.
+ * - `members` must point to an array of at least `max_members` elements.
+ *
+ * # Returns
+ *
+ * The number of messages written, or 0 if the stream index is invalid.
+ */
+uintptr_t conflux_peek_buffer(const struct ConfluxSynchronizer* sync,
+                              uintptr_t stream_index,
+                              struct ConfluxGroupMember* members,
+                              uintptr_t max_members);
+
+/**
+ * Raise the commit timestamp and the streams' last timestamps, e.g. when
+ * restoring a snapshot.
+ *
+ * Later pushes behave as if the last emitted group had the given commit
+ * timestamp and each stream's newest message the given last timestamp.
+ * Values already past the given ones are kept.
+ *
+ * # Safety
+ *
+ * - `sync` must be a valid pointer from `conflux_synchronizer_new`.
+ * - `last_timestamps_ns` must point to an array of `count` elements,
+ *   indexed by stream; -1 leaves a stream as it is.
+ *
+ * # Returns
+ *
+ * `ConfluxResult::Ok`, or `ConfluxResult::InvalidArgument` if `count` is
+ * not the number of streams.
+ */
+enum ConfluxResult conflux_restore_watermarks(struct ConfluxSynchronizer* sync,
+                                              int64_t commit_timestamp_ns,
+                                              const int64_t* last_timestamps_ns,
+                                              uintptr_t count);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
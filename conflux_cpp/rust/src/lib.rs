@@ -3,13 +3,16 @@
 //! This module provides a C-compatible interface to the conflux-core
 //! synchronization algorithm for use in C++ ROS2 nodes.
 
-use conflux_core::{DropPolicy as CoreDropPolicy, WithTimestamp, buffer::Buffer, state::State};
+use conflux_core::{
+    DropPolicy as CoreDropPolicy, EvictionReason, MatchPolicy, PushError, StalenessConfig,
+    StalenessDetector, WithTimestamp, buffer::Buffer, matcher::IndexedMatcher, state::State,
+};
 use indexmap::IndexMap;
 use std::{
-    ffi::{CStr, c_char, c_void},
+    ffi::{CStr, CString, c_char, c_void},
     ptr,
     sync::Arc,
-    time::Duration,
+    time::{Duration, Instant},
 };
 use tokio::sync::Notify;
 
@@ -17,9 +20,89 @@ use tokio::sync::Notify;
 ///
 /// The synchronizer manages multiple message streams and outputs
 /// synchronized groups when messages fall within the configured time window.
+/// Streams are identified by their index in the `keys` array given at
+/// creation; the name-based functions resolve names to these indices.
 pub struct ConfluxSynchronizer {
-    state: State<String, FfiMessage>,
+    matcher: IndexedMatcher<usize, FfiMessage>,
+    /// Members of the last matched group, reused across polls.
+    group: Vec<Option<FfiMessage>>,
     keys: Vec<String>,
+    key_cstrings: Vec<CString>,
+    staleness_timeout: Option<Duration>,
+    drop_callback: Option<DropCallback>,
+    drop_context: *mut c_void,
+}
+
+/// Callback signature for reporting discarded messages.
+type DropCallback = extern "C" fn(
+    timestamp_ns: i64,
+    user_data: *mut c_void,
+    reason: ConfluxDropReason,
+    context: *mut c_void,
+);
+
+impl ConfluxSynchronizer {
+    /// Look up the stream index of a key name.
+    ///
+    /// # Safety
+    ///
+    /// `key` must be a valid null-terminated C string.
+    unsafe fn key_index(&self, key: *const c_char) -> Option<usize> {
+        let key = unsafe { CStr::from_ptr(key) };
+        self.key_cstrings.iter().position(|k| k.as_c_str() == key)
+    }
+
+    /// Push a message to the stream at `index`.
+    fn push_index(
+        &mut self,
+        index: usize,
+        timestamp_ns: i64,
+        user_data: *mut c_void,
+    ) -> ConfluxResult {
+        if index >= self.keys.len() {
+            return ConfluxResult::KeyNotFound;
+        }
+
+        let timestamp = if timestamp_ns >= 0 {
+            Duration::from_nanos(timestamp_ns as u64)
+        } else {
+            return ConfluxResult::InvalidArgument;
+        };
+
+        let message = FfiMessage {
+            timestamp,
+            user_data,
+            timeout: self.staleness_timeout,
+        };
+
+        let result = match self.matcher.push(index, message) {
+            Ok(()) => ConfluxResult::Ok,
+            Err(PushError::BufferFull(_)) => ConfluxResult::BufferFull,
+            Err(PushError::LateMessage(_)) => ConfluxResult::LateMessage,
+            Err(PushError::OutOfOrder(_)) => ConfluxResult::OutOfOrder,
+            Err(PushError::UnknownKey(_)) => ConfluxResult::KeyNotFound,
+            Err(PushError::Timeout(_)) => ConfluxResult::InternalError,
+        };
+
+        self.flush_evictions();
+        result
+    }
+
+    /// Report messages evicted by the last operation to the drop callback.
+    fn flush_evictions(&mut self) {
+        let (callback, context) = (self.drop_callback, self.drop_context);
+        for eviction in self.matcher.drain_evictions() {
+            if let Some(cb) = callback {
+                let timestamp_ns = eviction.item.timestamp.as_nanos() as i64;
+                cb(
+                    timestamp_ns,
+                    eviction.item.user_data,
+                    eviction.reason.into(),
+                    context,
+                );
+            }
+        }
+    }
 }
 
 /// Internal message wrapper that implements WithTimestamp.
@@ -27,6 +110,7 @@ pub struct ConfluxSynchronizer {
 struct FfiMessage {
     timestamp: Duration,
     user_data: *mut c_void,
+    timeout: Option<Duration>,
 }
 
 // Safety: user_data is managed by the C++ side
@@ -36,6 +120,10 @@ impl WithTimestamp for FfiMessage {
     fn timestamp(&self) -> Duration {
         self.timestamp
     }
+
+    fn timeout(&self) -> Option<Duration> {
+        self.timeout
+    }
 }
 
 /// Policy for handling buffer overflow when pushing new messages.
@@ -61,16 +149,132 @@ impl From<ConfluxDropPolicy> for CoreDropPolicy {
     }
 }
 
+/// Algorithm used to form groups.
+#[repr(C)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum ConfluxMatchPolicy {
+    /// Group messages that fit within the time window, once the buffers
+    /// span a full window.
+    #[default]
+    Window = 0,
+    /// Pick one message per stream with minimal spread, as soon as every
+    /// stream has a message at or after the latest front message.
+    Approximate = 1,
+    /// Pair each message of the stream at `pivot_index` with the nearest
+    /// message of every other stream, as soon as it is bracketed.
+    Pivot = 2,
+}
+
+/// Staleness detection preset.
+///
+/// Stale messages are expired by wall-clock time; the caller drives expiry
+/// with `conflux_next_expiration_ns` and `conflux_process_expired`.
+#[repr(C)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum ConfluxStalenessPreset {
+    /// No staleness detection.
+    #[default]
+    Disabled = 0,
+    /// Balanced defaults.
+    Default = 1,
+    /// Sub-millisecond precision for high-rate streams.
+    HighFrequency = 2,
+    /// Millisecond precision for low-rate streams.
+    LowFrequency = 3,
+    /// Relaxed precision for offline processing.
+    BatchProcessing = 4,
+}
+
+impl ConfluxStalenessPreset {
+    /// Get the staleness configuration for this preset, or `None` if disabled.
+    fn config(self) -> Option<StalenessConfig> {
+        let mut config = match self {
+            ConfluxStalenessPreset::Disabled => return None,
+            ConfluxStalenessPreset::Default => StalenessConfig::default(),
+            ConfluxStalenessPreset::HighFrequency => StalenessConfig::high_frequency(),
+            ConfluxStalenessPreset::LowFrequency => StalenessConfig::low_frequency(),
+            ConfluxStalenessPreset::BatchProcessing => StalenessConfig::batch_processing(),
+        };
+
+        // Expiry is driven by the caller, not by a background task
+        config.enable_immediate_expiration = false;
+        Some(config)
+    }
+}
+
+/// Reason a buffered message was discarded without being emitted.
+#[repr(C)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum ConfluxDropReason {
+    /// Fell before the time window of a match.
+    Window = 0,
+    /// Evicted by `DropOldest` to make room for a newer message.
+    Overflow = 1,
+    /// Expired by the staleness detector.
+    Stale = 2,
+    /// Expired by its own timeout.
+    Expired = 3,
+    /// Dropped because no group could be formed.
+    Unmatched = 4,
+}
+
+impl From<EvictionReason> for ConfluxDropReason {
+    fn from(reason: EvictionReason) -> Self {
+        match reason {
+            EvictionReason::Window => ConfluxDropReason::Window,
+            EvictionReason::Overflow => ConfluxDropReason::Overflow,
+            EvictionReason::Stale => ConfluxDropReason::Stale,
+            EvictionReason::Expired => ConfluxDropReason::Expired,
+            EvictionReason::Unmatched => ConfluxDropReason::Unmatched,
+        }
+    }
+}
+
 /// Configuration for creating a synchronizer.
 #[repr(C)]
 pub struct ConfluxConfig {
     /// Time window in milliseconds for grouping messages.
-    /// Use 0 for infinite window (no time-based dropping).
+    /// Use 0 for infinite window (no time-based dropping) when
+    /// `window_size_ns` is also 0.
     pub window_size_ms: u64,
     /// Maximum number of messages to buffer per stream.
     pub buffer_size: usize,
     /// Policy for handling buffer overflow.
     pub drop_policy: ConfluxDropPolicy,
+    /// Time window in nanoseconds for grouping messages.
+    /// Overrides `window_size_ms` when nonzero.
+    pub window_size_ns: u64,
+    /// Staleness detection preset.
+    pub staleness: ConfluxStalenessPreset,
+    /// Time in nanoseconds a message may stay buffered before it is stale.
+    /// Use 0 to use the time window, or 60 seconds for an infinite window.
+    pub staleness_timeout_ns: u64,
+    /// Algorithm used to form groups.
+    pub match_policy: ConfluxMatchPolicy,
+    /// Stream index of the reference stream for `ConfluxMatchPolicy::Pivot`.
+    pub pivot_index: usize,
+}
+
+impl ConfluxConfig {
+    /// Get the configured time window, or `None` for an infinite window.
+    fn window_size(&self) -> Option<Duration> {
+        if self.window_size_ns != 0 {
+            Some(Duration::from_nanos(self.window_size_ns))
+        } else if self.window_size_ms != 0 {
+            Some(Duration::from_millis(self.window_size_ms))
+        } else {
+            None
+        }
+    }
+
+    /// Get the core match policy.
+    fn match_policy(&self) -> MatchPolicy {
+        match self.match_policy {
+            ConfluxMatchPolicy::Window => MatchPolicy::Window,
+            ConfluxMatchPolicy::Approximate => MatchPolicy::Approximate,
+            ConfluxMatchPolicy::Pivot => MatchPolicy::Pivot(self.pivot_index),
+        }
+    }
 }
 
 impl Default for ConfluxConfig {
@@ -79,6 +283,11 @@ impl Default for ConfluxConfig {
             window_size_ms: 50,
             buffer_size: 64,
             drop_policy: ConfluxDropPolicy::default(),
+            window_size_ns: 0,
+            staleness: ConfluxStalenessPreset::default(),
+            staleness_timeout_ns: 0,
+            match_policy: ConfluxMatchPolicy::default(),
+            pivot_index: 0,
         }
     }
 }
@@ -99,10 +308,51 @@ pub enum ConfluxResult {
     NullPointer = 4,
     /// Internal error.
     InternalError = 5,
+    /// Message timestamp is before the last emitted group, message rejected.
+    LateMessage = 6,
+    /// Message timestamp is not after the stream's newest message, message
+    /// rejected.
+    OutOfOrder = 7,
+}
+
+/// Stream index written by `conflux_poll_batch` for a stream missing from a
+/// partial group.
+pub const CONFLUX_ABSENT_MEMBER: usize = usize::MAX;
+
+/// One member of a synchronized group, as written by `conflux_poll_batch`.
+#[repr(C)]
+#[derive(Debug, Clone, Copy)]
+pub struct ConfluxGroupMember {
+    /// Stream index of the member.
+    pub stream_index: usize,
+    /// Message timestamp in nanoseconds.
+    pub timestamp_ns: i64,
+    /// The user data pointer passed when pushing.
+    pub user_data: *mut c_void,
+}
+
+/// Rate-control feedback for one stream, as written by
+/// `conflux_get_feedback`.
+#[repr(C)]
+#[derive(Debug, Clone, Copy)]
+pub struct ConfluxStreamFeedback {
+    /// The stream's buffer is full: a new message is rejected with
+    /// `RejectNew`, or evicts the oldest one with `DropOldest`.
+    pub buffer_full: bool,
+    /// New messages must be stamped after this to be accepted, in
+    /// nanoseconds; -1 if any timestamp is. Set by the last emitted group or
+    /// the stream's newest message, whichever is later.
+    pub needed_after_ns: i64,
+    /// Number of messages buffered for the stream.
+    pub buffered: usize,
 }
 
 /// Create a new synchronizer with the given configuration and keys.
 ///
+/// Each key is assigned the stream index of its position in `keys`, starting
+/// at 0. The indices are stable for the lifetime of the synchronizer and can
+/// be used with `conflux_push_message_by_index` and `conflux_poll_indexed`.
+///
 /// # Safety
 ///
 /// - `keys` must be an array of `key_count` valid null-terminated C strings.
@@ -129,31 +379,33 @@ pub unsafe extern "C" fn conflux_synchronizer_new(
             return ptr::null_mut();
         }
 
+        if config.match_policy == ConfluxMatchPolicy::Pivot && config.pivot_index >= key_count {
+            return ptr::null_mut();
+        }
+
         // Parse keys
         let mut key_strings = Vec::with_capacity(key_count);
+        let mut key_cstrings = Vec::with_capacity(key_count);
         for i in 0..key_count {
             let key_ptr = *keys.add(i);
             if key_ptr.is_null() {
                 return ptr::null_mut();
             }
-            match CStr::from_ptr(key_ptr).to_str() {
+            let key = CStr::from_ptr(key_ptr);
+            match key.to_str() {
                 Ok(s) => key_strings.push(s.to_string()),
                 Err(_) => return ptr::null_mut(),
             }
+            key_cstrings.push(key.to_owned());
         }
 
-        // Create buffers for each key
-        let buffers: IndexMap<String, Buffer<FfiMessage>> = key_strings
-            .iter()
-            .map(|key| (key.clone(), Buffer::with_capacity(config.buffer_size)))
+        // Create buffers for each key, indexed by position
+        let buffers: IndexMap<usize, Buffer<FfiMessage>> = (0..key_count)
+            .map(|index| (index, Buffer::with_capacity(config.buffer_size)))
             .collect();
 
         // Convert window size: 0 means infinite window (None)
-        let window_size = if config.window_size_ms == 0 {
-            None
-        } else {
-            Some(Duration::from_millis(config.window_size_ms))
-        };
+        let window_size = config.window_size();
 
         // Create State directly
         let state = State {
@@ -163,13 +415,22 @@ pub unsafe extern "C" fn conflux_synchronizer_new(
             window_size,
             drop_policy: config.drop_policy.into(),
             feedback_tx: None,
-            staleness_detector: None,
+            staleness_detector: config.staleness.config().map(StalenessDetector::new),
             space_notify: Arc::new(Notify::new()),
+            evicted: None,
+            match_policy: config.match_policy(),
+            deadlines: Vec::new(),
         };
 
         let sync = Box::new(ConfluxSynchronizer {
-            state,
+            matcher: IndexedMatcher::new(state),
+            group: Vec::with_capacity(key_count),
             keys: key_strings,
+            key_cstrings,
+            staleness_timeout: (config.staleness_timeout_ns != 0)
+                .then(|| Duration::from_nanos(config.staleness_timeout_ns)),
+            drop_callback: None,
+            drop_context: ptr::null_mut(),
         });
 
         Box::into_raw(sync)
@@ -203,6 +464,10 @@ pub unsafe extern "C" fn conflux_synchronizer_free(sync: *mut ConfluxSynchronize
 ///
 /// - `ConfluxResult::Ok` if the message was accepted.
 /// - `ConfluxResult::BufferFull` if the buffer for this key is full.
+/// - `ConfluxResult::LateMessage` if the timestamp is before the last
+///   emitted group.
+/// - `ConfluxResult::OutOfOrder` if the timestamp is not after the newest
+///   message of the key.
 /// - `ConfluxResult::KeyNotFound` if the key was not provided at creation.
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn conflux_push_message(
@@ -217,30 +482,95 @@ pub unsafe extern "C" fn conflux_push_message(
         }
 
         let sync = &mut *sync;
-        let key_str = match CStr::from_ptr(key).to_str() {
-            Ok(s) => s.to_string(),
-            Err(_) => return ConfluxResult::InvalidArgument,
-        };
+        match sync.key_index(key) {
+            Some(index) => sync.push_index(index, timestamp_ns, user_data),
+            None => ConfluxResult::KeyNotFound,
+        }
+    }
+}
 
-        if !sync.keys.contains(&key_str) {
-            return ConfluxResult::KeyNotFound;
+/// Push a message to the stream at the given index.
+///
+/// Equivalent to `conflux_push_message` without the key lookup.
+///
+/// # Safety
+///
+/// - `sync` must be a valid pointer from `conflux_synchronizer_new`.
+/// - `user_data` is an opaque pointer that will be returned in synchronized groups.
+///
+/// # Returns
+///
+/// - `ConfluxResult::Ok` if the message was accepted.
+/// - `ConfluxResult::BufferFull` if the buffer for this stream is full.
+/// - `ConfluxResult::LateMessage` if the timestamp is before the last
+///   emitted group.
+/// - `ConfluxResult::OutOfOrder` if the timestamp is not after the newest
+///   message of the stream.
+/// - `ConfluxResult::KeyNotFound` if `index` is not less than the key count.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn conflux_push_message_by_index(
+    sync: *mut ConfluxSynchronizer,
+    index: usize,
+    timestamp_ns: i64,
+    user_data: *mut c_void,
+) -> ConfluxResult {
+    unsafe {
+        if sync.is_null() {
+            return ConfluxResult::NullPointer;
         }
 
-        let timestamp = if timestamp_ns >= 0 {
-            Duration::from_nanos(timestamp_ns as u64)
-        } else {
-            return ConfluxResult::InvalidArgument;
-        };
+        (*sync).push_index(index, timestamp_ns, user_data)
+    }
+}
 
-        let message = FfiMessage {
-            timestamp,
-            user_data,
-        };
+/// Mark the stream at the given index as optional.
+///
+/// Groups no longer wait indefinitely for an optional stream: once the
+/// newest buffered message on any stream is `deadline_ns` past a group
+/// without a usable message from it, the group is emitted without that
+/// member. Poll functions then simply omit the stream; `conflux_poll_batch`
+/// marks it with `CONFLUX_ABSENT_MEMBER`. Call this before pushing messages.
+///
+/// # Safety
+///
+/// - `sync` must be a valid pointer from `conflux_synchronizer_new`.
+///
+/// # Returns
+///
+/// - `ConfluxResult::Ok` if the stream is now optional.
+/// - `ConfluxResult::KeyNotFound` if `index` is not less than the key count.
+/// - `ConfluxResult::InvalidArgument` if the stream is the pivot of
+///   `ConfluxMatchPolicy::Pivot` or the last required stream.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn conflux_set_optional(
+    sync: *mut ConfluxSynchronizer,
+    index: usize,
+    deadline_ns: u64,
+) -> ConfluxResult {
+    unsafe {
+        if sync.is_null() {
+            return ConfluxResult::NullPointer;
+        }
 
-        match sync.state.push(key_str, message) {
-            Ok(()) => ConfluxResult::Ok,
-            Err(_) => ConfluxResult::BufferFull,
+        let matcher = &mut (*sync).matcher;
+        let state = matcher.state();
+        let key_count = state.buffers.len();
+        if index >= key_count {
+            return ConfluxResult::KeyNotFound;
         }
+
+        let required = (0..key_count)
+            .filter(|&other| other != index && state.deadline(other).is_none())
+            .count();
+        if required == 0 || state.match_policy == MatchPolicy::Pivot(index) {
+            return ConfluxResult::InvalidArgument;
+        }
+
+        matcher.update(|state| {
+            state.deadlines.resize(key_count, None);
+            state.deadlines[index] = Some(Duration::from_nanos(deadline_ns));
+        });
+        ConfluxResult::Ok
     }
 }
 
@@ -288,112 +618,527 @@ pub unsafe extern "C" fn conflux_poll(
 
         let sync = &mut *sync;
 
-        match sync.state.try_match() {
-            Some(group) => {
-                if let Some(cb) = callback {
-                    for (key, msg) in group {
-                        let key_cstr = std::ffi::CString::new(key).unwrap();
-                        let timestamp_ns = msg.timestamp.as_nanos() as i64;
-                        cb(key_cstr.as_ptr(), timestamp_ns, msg.user_data, context);
-                    }
+        let result = if sync.matcher.try_match_into(&mut sync.group) {
+            if let Some(cb) = callback {
+                for (index, msg) in sync.group.iter().enumerate() {
+                    let Some(msg) = msg else {
+                        continue;
+                    };
+                    let timestamp_ns = msg.timestamp.as_nanos() as i64;
+                    cb(
+                        sync.key_cstrings[index].as_ptr(),
+                        timestamp_ns,
+                        msg.user_data,
+                        context,
+                    );
                 }
-                1
             }
-            None => 0,
-        }
+            1
+        } else {
+            0
+        };
+
+        sync.flush_evictions();
+        result
     }
 }
 
-/// Get the number of keys registered with the synchronizer.
+/// Poll for a synchronized group of messages, reporting stream indices.
+///
+/// Equivalent to `conflux_poll`, but the callback receives the stream index
+/// instead of the key name.
 ///
 /// # Safety
 ///
-/// `sync` must be a valid pointer from `conflux_synchronizer_new`.
+/// - `sync` must be a valid pointer from `conflux_synchronizer_new`.
+/// - `callback` will be called with each member of the synchronized group.
+/// - `context` is passed through to the callback.
+///
+/// # Callback
+///
+/// The callback receives:
+/// - `index`: The stream index of the member
+/// - `timestamp_ns`: Message timestamp in nanoseconds
+/// - `user_data`: The user data pointer passed when pushing
+/// - `context`: The context pointer passed to this function
+///
+/// # Returns
+///
+/// - 1 if a synchronized group was found and callback was invoked.
+/// - 0 if no synchronized group is available.
+/// - -1 on error.
 #[unsafe(no_mangle)]
-pub unsafe extern "C" fn conflux_key_count(sync: *const ConfluxSynchronizer) -> usize {
+pub unsafe extern "C" fn conflux_poll_indexed(
+    sync: *mut ConfluxSynchronizer,
+    callback: Option<
+        extern "C" fn(
+            index: usize,
+            timestamp_ns: i64,
+            user_data: *mut c_void,
+            context: *mut c_void,
+        ),
+    >,
+    context: *mut c_void,
+) -> i32 {
     unsafe {
         if sync.is_null() {
-            return 0;
+            return -1;
         }
-        (*sync).keys.len()
+
+        let sync = &mut *sync;
+
+        let result = if sync.matcher.try_match_into(&mut sync.group) {
+            if let Some(cb) = callback {
+                for (index, msg) in sync.group.iter().enumerate() {
+                    let Some(msg) = msg else {
+                        continue;
+                    };
+                    let timestamp_ns = msg.timestamp.as_nanos() as i64;
+                    cb(index, timestamp_ns, msg.user_data, context);
+                }
+            }
+            1
+        } else {
+            0
+        };
+
+        sync.flush_evictions();
+        result
     }
 }
 
-/// Check if the synchronizer is ready (all buffers have at least 2 messages).
+/// Poll for up to `max_groups` synchronized groups in one call.
+///
+/// Groups are written to `members` in the order they are matched. Group `g`
+/// occupies records `g * key_count` through `(g + 1) * key_count - 1`, with
+/// each member stored at the offset of its stream index. Records of
+/// optional streams missing from a group have `stream_index` set to
+/// `CONFLUX_ABSENT_MEMBER` and a null `user_data`.
 ///
 /// # Safety
 ///
-/// `sync` must be a valid pointer from `conflux_synchronizer_new`.
+/// - `sync` must be a valid pointer from `conflux_synchronizer_new`.
+/// - `members` must point to at least `max_groups * key_count` writable
+///   records, where `key_count` is the value of `conflux_key_count`.
+///
+/// # Returns
+///
+/// - The number of groups written, between 0 and `max_groups`.
+/// - -1 on error.
 #[unsafe(no_mangle)]
-pub unsafe extern "C" fn conflux_is_ready(sync: *const ConfluxSynchronizer) -> bool {
+pub unsafe extern "C" fn conflux_poll_batch(
+    sync: *mut ConfluxSynchronizer,
+    members: *mut ConfluxGroupMember,
+    max_groups: usize,
+) -> isize {
     unsafe {
-        if sync.is_null() {
-            return false;
+        if sync.is_null() || (members.is_null() && max_groups > 0) {
+            return -1;
+        }
+
+        let sync = &mut *sync;
+        let key_count = sync.keys.len();
+
+        let mut count = 0;
+        while count < max_groups && sync.matcher.try_match_into(&mut sync.group) {
+            let base = members.add(count * key_count);
+            for (index, msg) in sync.group.iter().enumerate() {
+                let member = match msg {
+                    Some(msg) => ConfluxGroupMember {
+                        stream_index: index,
+                        timestamp_ns: msg.timestamp.as_nanos() as i64,
+                        user_data: msg.user_data,
+                    },
+                    None => ConfluxGroupMember {
+                        stream_index: CONFLUX_ABSENT_MEMBER,
+                        timestamp_ns: 0,
+                        user_data: ptr::null_mut(),
+                    },
+                };
+                base.add(index).write(member);
+            }
+            count += 1;
         }
-        (*sync).state.is_ready()
+
+        sync.flush_evictions();
+        count as isize
     }
 }
 
-/// Check if the synchronizer is empty (any buffer is empty).
+/// Register a callback for messages discarded without being emitted.
+///
+/// Once set, every message evicted from a buffer (window drops during
+/// matching, `DropOldest` overflow, or expiration) is reported exactly once,
+/// so the caller can release whatever `user_data` refers to. Messages
+/// rejected by `conflux_push_message` are not reported; the caller learns
+/// about them from its return value. Pass a null callback to disable
+/// reporting.
 ///
 /// # Safety
 ///
-/// `sync` must be a valid pointer from `conflux_synchronizer_new`.
+/// - `sync` must be a valid pointer from `conflux_synchronizer_new`.
+/// - `context` is passed through to the callback and must stay valid while
+///   the callback is registered.
+///
+/// # Callback
+///
+/// The callback receives:
+/// - `timestamp_ns`: Message timestamp in nanoseconds
+/// - `user_data`: The user data pointer passed to `conflux_push_message`
+/// - `reason`: Why the message was discarded
+/// - `context`: The context pointer passed to this function
+///
+/// The callback is invoked from within `conflux_push_message` and
+/// `conflux_poll` and must not call back into the synchronizer.
 #[unsafe(no_mangle)]
-pub unsafe extern "C" fn conflux_is_empty(sync: *const ConfluxSynchronizer) -> bool {
+pub unsafe extern "C" fn conflux_set_drop_callback(
+    sync: *mut ConfluxSynchronizer,
+    callback: Option<
+        extern "C" fn(
+            timestamp_ns: i64,
+            user_data: *mut c_void,
+            reason: ConfluxDropReason,
+            context: *mut c_void,
+        ),
+    >,
+    context: *mut c_void,
+) -> ConfluxResult {
     unsafe {
         if sync.is_null() {
-            return true;
+            return ConfluxResult::NullPointer;
         }
-        (*sync).state.is_empty()
+
+        let sync = &mut *sync;
+        sync.drop_callback = callback;
+        sync.drop_context = context;
+        // Sized for every buffered message, which bounds the evictions
+        // between two flushes, so recording never allocates afterwards
+        sync.matcher.update(|state| {
+            let capacity = state.buffers.len() * state.buf_size;
+            state.evicted = callback.map(|_| Vec::with_capacity(capacity));
+        });
+        ConfluxResult::Ok
     }
 }
 
-/// Get the buffer size for a specific key.
+/// Get the time until the next staleness deadline.
 ///
 /// # Safety
 ///
-/// - `sync` must be a valid pointer from `conflux_synchronizer_new`.
-/// - `key` must be a valid null-terminated C string.
+/// `sync` must be a valid pointer from `conflux_synchronizer_new`.
 ///
 /// # Returns
 ///
-/// The number of messages in the buffer, or 0 if the key is not found.
+/// - Nanoseconds until `conflux_process_expired` should be called, or 0 if
+///   the deadline has already passed.
+/// - -1 if staleness detection is disabled or no message is tracked.
 #[unsafe(no_mangle)]
-pub unsafe extern "C" fn conflux_buffer_len(
-    sync: *const ConfluxSynchronizer,
-    key: *const c_char,
-) -> usize {
+pub unsafe extern "C" fn conflux_next_expiration_ns(sync: *const ConfluxSynchronizer) -> i64 {
     unsafe {
-        if sync.is_null() || key.is_null() {
-            return 0;
+        if sync.is_null() {
+            return -1;
         }
 
-        let sync = &*sync;
-        let key_str = match CStr::from_ptr(key).to_str() {
-            Ok(s) => s,
-            Err(_) => return 0,
+        let Some(detector) = &(*sync).matcher.state().staleness_detector else {
+            return -1;
         };
-
-        sync.state
-            .buffers
-            .get(key_str)
-            .map(|b| b.len())
-            .unwrap_or(0)
+        match detector.next_expiration() {
+            Some(deadline) => {
+                let remaining = deadline.saturating_duration_since(Instant::now());
+                i64::try_from(remaining.as_nanos()).unwrap_or(i64::MAX)
+            }
+            None => -1,
+        }
     }
 }
 
-#[cfg(test)]
-mod tests {
-    use super::*;
-    use std::sync::atomic::{AtomicI32, Ordering};
-
-    #[test]
-    fn test_create_and_free() {
-        let config = ConfluxConfig {
-            window_size_ms: 50,
+/// Remove messages whose staleness deadline has passed.
+///
+/// Removed messages are reported to the drop callback with
+/// `ConfluxDropReason::Stale`.
+///
+/// # Safety
+///
+/// `sync` must be a valid pointer from `conflux_synchronizer_new`.
+///
+/// # Returns
+///
+/// The number of messages removed.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn conflux_process_expired(sync: *mut ConfluxSynchronizer) -> usize {
+    unsafe {
+        if sync.is_null() {
+            return 0;
+        }
+
+        let sync = &mut *sync;
+        let removed = sync
+            .matcher
+            .update(|state| state.process_staleness_expiration());
+        sync.flush_evictions();
+        removed
+    }
+}
+
+/// Get the number of keys registered with the synchronizer.
+///
+/// # Safety
+///
+/// `sync` must be a valid pointer from `conflux_synchronizer_new`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn conflux_key_count(sync: *const ConfluxSynchronizer) -> usize {
+    unsafe {
+        if sync.is_null() {
+            return 0;
+        }
+        (*sync).keys.len()
+    }
+}
+
+/// Get the stream index of a key.
+///
+/// # Safety
+///
+/// - `sync` must be a valid pointer from `conflux_synchronizer_new`.
+/// - `key` must be a valid null-terminated C string.
+///
+/// # Returns
+///
+/// The stream index, or -1 if the key is not found.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn conflux_key_index(
+    sync: *const ConfluxSynchronizer,
+    key: *const c_char,
+) -> isize {
+    unsafe {
+        if sync.is_null() || key.is_null() {
+            return -1;
+        }
+
+        match (*sync).key_index(key) {
+            Some(index) => index as isize,
+            None => -1,
+        }
+    }
+}
+
+/// Check if the synchronizer is ready (all buffers have at least 2 messages).
+///
+/// # Safety
+///
+/// `sync` must be a valid pointer from `conflux_synchronizer_new`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn conflux_is_ready(sync: *const ConfluxSynchronizer) -> bool {
+    unsafe {
+        if sync.is_null() {
+            return false;
+        }
+        (*sync).matcher.is_ready()
+    }
+}
+
+/// Check if the synchronizer is empty (any buffer is empty).
+///
+/// # Safety
+///
+/// `sync` must be a valid pointer from `conflux_synchronizer_new`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn conflux_is_empty(sync: *const ConfluxSynchronizer) -> bool {
+    unsafe {
+        if sync.is_null() {
+            return true;
+        }
+        (*sync).matcher.is_empty()
+    }
+}
+
+/// Get the buffer size for a specific key.
+///
+/// # Safety
+///
+/// - `sync` must be a valid pointer from `conflux_synchronizer_new`.
+/// - `key` must be a valid null-terminated C string.
+///
+/// # Returns
+///
+/// The number of messages in the buffer, or 0 if the key is not found.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn conflux_buffer_len(
+    sync: *const ConfluxSynchronizer,
+    key: *const c_char,
+) -> usize {
+    unsafe {
+        if sync.is_null() || key.is_null() {
+            return 0;
+        }
+
+        let sync = &*sync;
+        sync.key_index(key)
+            .and_then(|index| sync.matcher.state().buffers.get(&index))
+            .map(|b| b.len())
+            .unwrap_or(0)
+    }
+}
+
+/// Get rate-control feedback for every stream.
+///
+/// Lets producers skip capturing messages that would be rejected, e.g. for
+/// a stream running ahead of the others whose buffer is full.
+///
+/// # Safety
+///
+/// - `sync` must be a valid pointer from `conflux_synchronizer_new`.
+/// - `feedback` must point to an array of at least `max_streams` elements.
+///
+/// # Returns
+///
+/// The number of streams written, in stream index order.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn conflux_get_feedback(
+    sync: *const ConfluxSynchronizer,
+    feedback: *mut ConfluxStreamFeedback,
+    max_streams: usize,
+) -> usize {
+    unsafe {
+        if sync.is_null() || feedback.is_null() {
+            return 0;
+        }
+
+        let state = (*sync).matcher.state();
+        let count = state.buffers.len().min(max_streams);
+        let out = std::slice::from_raw_parts_mut(feedback, count);
+        for (index, (slot, (_key, buffer))) in out.iter_mut().zip(&state.buffers).enumerate() {
+            *slot = ConfluxStreamFeedback {
+                buffer_full: !state.accepts(index),
+                needed_after_ns: state
+                    .accepted_after(index)
+                    .map_or(-1, |ts| ts.as_nanos() as i64),
+                buffered: buffer.len(),
+            };
+        }
+        count
+    }
+}
+
+/// Get the commit timestamp: messages stamped at or before it are
+/// rejected as late.
+///
+/// # Safety
+///
+/// `sync` must be a valid pointer from `conflux_synchronizer_new`.
+///
+/// # Returns
+///
+/// The commit timestamp in nanoseconds, or -1 if no group has been emitted.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn conflux_commit_timestamp_ns(sync: *const ConfluxSynchronizer) -> i64 {
+    unsafe {
+        if sync.is_null() {
+            return -1;
+        }
+        (*sync)
+            .matcher
+            .state()
+            .commit_ts
+            .map_or(-1, |ts| ts.as_nanos() as i64)
+    }
+}
+
+/// Copy the messages buffered for a stream, oldest first, without
+/// removing them.
+///
+/// # Safety
+///
+/// - `sync` must be a valid pointer from `conflux_synchronizer_new`.
+/// - `members` must point to an array of at least `max_members` elements.
+///
+/// # Returns
+///
+/// The number of messages written, or 0 if the stream index is invalid.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn conflux_peek_buffer(
+    sync: *const ConfluxSynchronizer,
+    stream_index: usize,
+    members: *mut ConfluxGroupMember,
+    max_members: usize,
+) -> usize {
+    unsafe {
+        if sync.is_null() || members.is_null() {
+            return 0;
+        }
+
+        let Some((_key, buffer)) = (*sync).matcher.state().buffers.get_index(stream_index) else {
+            return 0;
+        };
+        let count = buffer.len().min(max_members);
+        let out = std::slice::from_raw_parts_mut(members, count);
+        for (slot, msg) in out.iter_mut().zip(buffer.iter()) {
+            *slot = ConfluxGroupMember {
+                stream_index,
+                timestamp_ns: msg.timestamp.as_nanos() as i64,
+                user_data: msg.user_data,
+            };
+        }
+        count
+    }
+}
+
+/// Raise the commit timestamp and the streams' last timestamps, e.g. when
+/// restoring a snapshot.
+///
+/// Later pushes behave as if the last emitted group had the given commit
+/// timestamp and each stream's newest message the given last timestamp.
+/// Values already past the given ones are kept.
+///
+/// # Safety
+///
+/// - `sync` must be a valid pointer from `conflux_synchronizer_new`.
+/// - `last_timestamps_ns` must point to an array of `count` elements,
+///   indexed by stream; -1 leaves a stream as it is.
+///
+/// # Returns
+///
+/// `ConfluxResult::Ok`, or `ConfluxResult::InvalidArgument` if `count` is
+/// not the number of streams.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn conflux_restore_watermarks(
+    sync: *mut ConfluxSynchronizer,
+    commit_timestamp_ns: i64,
+    last_timestamps_ns: *const i64,
+    count: usize,
+) -> ConfluxResult {
+    unsafe {
+        if sync.is_null() || last_timestamps_ns.is_null() {
+            return ConfluxResult::NullPointer;
+        }
+
+        let sync = &mut *sync;
+        if count != sync.keys.len() {
+            return ConfluxResult::InvalidArgument;
+        }
+
+        let to_duration = |ns: i64| (ns >= 0).then(|| Duration::from_nanos(ns as u64));
+        let last_ts: Vec<Option<Duration>> = std::slice::from_raw_parts(last_timestamps_ns, count)
+            .iter()
+            .map(|&ns| to_duration(ns))
+            .collect();
+        sync.matcher.update(|state| {
+            state.raise_watermarks(to_duration(commit_timestamp_ns), &last_ts);
+        });
+        ConfluxResult::Ok
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::atomic::{AtomicI32, Ordering};
+
+    #[test]
+    fn test_create_and_free() {
+        let config = ConfluxConfig {
             buffer_size: 10,
-            drop_policy: ConfluxDropPolicy::RejectNew,
+            ..Default::default()
         };
 
         let key1 = std::ffi::CString::new("topic1").unwrap();
@@ -428,7 +1173,7 @@ mod tests {
         let config = ConfluxConfig {
             window_size_ms: 100,
             buffer_size: 10,
-            drop_policy: ConfluxDropPolicy::RejectNew,
+            ..Default::default()
         };
 
         let key1 = std::ffi::CString::new("topic1").unwrap();
@@ -468,12 +1213,323 @@ mod tests {
         }
     }
 
+    static DROPPED: AtomicI32 = AtomicI32::new(0);
+
+    extern "C" fn test_drop_callback(
+        _timestamp_ns: i64,
+        user_data: *mut c_void,
+        reason: ConfluxDropReason,
+        _context: *mut c_void,
+    ) {
+        assert_eq!(reason, ConfluxDropReason::Overflow);
+        DROPPED.store(user_data as usize as i32, Ordering::SeqCst);
+    }
+
+    #[test]
+    fn test_drop_callback_reports_overflow() {
+        let config = ConfluxConfig {
+            buffer_size: 2,
+            drop_policy: ConfluxDropPolicy::DropOldest,
+            ..Default::default()
+        };
+
+        let key1 = std::ffi::CString::new("topic1").unwrap();
+        let key2 = std::ffi::CString::new("topic2").unwrap();
+        let keys = [key1.as_ptr(), key2.as_ptr()];
+
+        let sync = unsafe { conflux_synchronizer_new(&config, keys.as_ptr(), keys.len()) };
+        assert!(!sync.is_null());
+
+        unsafe {
+            let result = conflux_set_drop_callback(sync, Some(test_drop_callback), ptr::null_mut());
+            assert_eq!(result, ConfluxResult::Ok);
+
+            for (i, ts) in [1_000_000_000, 1_100_000_000, 1_200_000_000]
+                .into_iter()
+                .enumerate()
+            {
+                let user_data = (i + 1) as *mut c_void;
+                let result = conflux_push_message(sync, key1.as_ptr(), ts, user_data);
+                assert_eq!(result, ConfluxResult::Ok);
+            }
+
+            // The first message was evicted to make room for the third
+            assert_eq!(DROPPED.load(Ordering::SeqCst), 1);
+
+            conflux_synchronizer_free(sync);
+        }
+    }
+
+    static INDEX_MASK: AtomicI32 = AtomicI32::new(0);
+
+    extern "C" fn test_indexed_callback(
+        index: usize,
+        _timestamp_ns: i64,
+        user_data: *mut c_void,
+        _context: *mut c_void,
+    ) {
+        assert_eq!(user_data as usize, index + 1);
+        INDEX_MASK.fetch_or(1 << index, Ordering::SeqCst);
+    }
+
+    #[test]
+    fn test_push_and_poll_by_index() {
+        let config = ConfluxConfig {
+            window_size_ms: 100,
+            buffer_size: 10,
+            ..Default::default()
+        };
+
+        let key1 = std::ffi::CString::new("topic1").unwrap();
+        let key2 = std::ffi::CString::new("topic2").unwrap();
+        let keys = [key1.as_ptr(), key2.as_ptr()];
+
+        let sync = unsafe { conflux_synchronizer_new(&config, keys.as_ptr(), keys.len()) };
+        assert!(!sync.is_null());
+
+        unsafe {
+            assert_eq!(conflux_key_index(sync, key1.as_ptr()), 0);
+            assert_eq!(conflux_key_index(sync, key2.as_ptr()), 1);
+
+            for ts in [1_000_000_000, 1_100_000_000] {
+                for index in 0..2 {
+                    let user_data = (index + 1) as *mut c_void;
+                    let result = conflux_push_message_by_index(sync, index, ts, user_data);
+                    assert_eq!(result, ConfluxResult::Ok);
+                }
+            }
+
+            let result = conflux_push_message_by_index(sync, 2, 1_000_000_000, ptr::null_mut());
+            assert_eq!(result, ConfluxResult::KeyNotFound);
+            assert_eq!(conflux_buffer_len(sync, key1.as_ptr()), 2);
+
+            let result = conflux_poll_indexed(sync, Some(test_indexed_callback), ptr::null_mut());
+            assert_eq!(result, 1);
+            assert_eq!(INDEX_MASK.load(Ordering::SeqCst), 0b11);
+
+            conflux_synchronizer_free(sync);
+        }
+    }
+
+    #[test]
+    fn test_push_reports_rejection_reason() {
+        let config = ConfluxConfig {
+            window_size_ms: 100,
+            buffer_size: 10,
+            ..Default::default()
+        };
+
+        let key1 = std::ffi::CString::new("topic1").unwrap();
+        let key2 = std::ffi::CString::new("topic2").unwrap();
+        let keys = [key1.as_ptr(), key2.as_ptr()];
+
+        let sync = unsafe { conflux_synchronizer_new(&config, keys.as_ptr(), keys.len()) };
+        assert!(!sync.is_null());
+
+        unsafe {
+            for ts in [1_000_000_000, 1_100_000_000] {
+                for index in 0..2 {
+                    let user_data = (index + 1) as *mut c_void;
+                    let result = conflux_push_message_by_index(sync, index, ts, user_data);
+                    assert_eq!(result, ConfluxResult::Ok);
+                }
+            }
+
+            // Not after the stream's newest message
+            let result = conflux_push_message_by_index(sync, 0, 1_100_000_000, ptr::null_mut());
+            assert_eq!(result, ConfluxResult::OutOfOrder);
+
+            let result = conflux_poll_indexed(sync, Some(test_indexed_callback), ptr::null_mut());
+            assert_eq!(result, 1);
+
+            // Before the group that was just emitted
+            let result = conflux_push_message_by_index(sync, 0, 500_000_000, ptr::null_mut());
+            assert_eq!(result, ConfluxResult::LateMessage);
+
+            conflux_synchronizer_free(sync);
+        }
+    }
+
+    #[test]
+    fn test_poll_batch() {
+        let config = ConfluxConfig {
+            window_size_ms: 100,
+            buffer_size: 10,
+            ..Default::default()
+        };
+
+        let key1 = std::ffi::CString::new("topic1").unwrap();
+        let key2 = std::ffi::CString::new("topic2").unwrap();
+        let keys = [key1.as_ptr(), key2.as_ptr()];
+
+        let sync = unsafe { conflux_synchronizer_new(&config, keys.as_ptr(), keys.len()) };
+        assert!(!sync.is_null());
+
+        unsafe {
+            for step in 0..5i64 {
+                let ts = 1_000_000_000 + step * 200_000_000;
+                for index in 0..2 {
+                    let user_data = (step as usize * 2 + index + 1) as *mut c_void;
+                    let result = conflux_push_message_by_index(sync, index, ts, user_data);
+                    assert_eq!(result, ConfluxResult::Ok);
+                }
+            }
+
+            let mut members = [ConfluxGroupMember {
+                stream_index: usize::MAX,
+                timestamp_ns: 0,
+                user_data: ptr::null_mut(),
+            }; 6];
+
+            // Only three groups were requested even though more are ready
+            let count = conflux_poll_batch(sync, members.as_mut_ptr(), 3);
+            assert_eq!(count, 3);
+            for (i, member) in members.iter().enumerate() {
+                assert_eq!(member.stream_index, i % 2);
+                assert_eq!(member.user_data as usize, i + 1);
+            }
+
+            let count = conflux_poll_batch(sync, members.as_mut_ptr(), 3);
+            assert!(count >= 1);
+            assert_eq!(members[0].user_data as usize, 7);
+
+            conflux_synchronizer_free(sync);
+        }
+    }
+
+    #[test]
+    fn test_optional_stream_partial_groups() {
+        let config = ConfluxConfig {
+            window_size_ms: 100,
+            buffer_size: 10,
+            ..Default::default()
+        };
+
+        let key1 = std::ffi::CString::new("topic1").unwrap();
+        let key2 = std::ffi::CString::new("topic2").unwrap();
+        let keys = [key1.as_ptr(), key2.as_ptr()];
+
+        let sync = unsafe { conflux_synchronizer_new(&config, keys.as_ptr(), keys.len()) };
+        assert!(!sync.is_null());
+
+        unsafe {
+            assert_eq!(conflux_set_optional(sync, 2, 0), ConfluxResult::KeyNotFound);
+            assert_eq!(conflux_set_optional(sync, 1, 50_000_000), ConfluxResult::Ok);
+            // At least one stream must stay required
+            assert_eq!(
+                conflux_set_optional(sync, 0, 50_000_000),
+                ConfluxResult::InvalidArgument
+            );
+
+            // topic2 is out; topic1 alone keeps producing groups
+            for step in 0..3i64 {
+                let ts = 1_000_000_000 + step * 100_000_000;
+                let user_data = (step as usize + 1) as *mut c_void;
+                let result = conflux_push_message_by_index(sync, 0, ts, user_data);
+                assert_eq!(result, ConfluxResult::Ok);
+            }
+
+            let mut members = [ConfluxGroupMember {
+                stream_index: 0,
+                timestamp_ns: 0,
+                user_data: ptr::null_mut(),
+            }; 6];
+
+            // The last message is still within topic2's deadline
+            let count = conflux_poll_batch(sync, members.as_mut_ptr(), 3);
+            assert_eq!(count, 2);
+            for group in members[..4].chunks(2) {
+                assert_eq!(group[0].stream_index, 0);
+                assert_eq!(group[1].stream_index, CONFLUX_ABSENT_MEMBER);
+                assert!(group[1].user_data.is_null());
+            }
+            assert_eq!(members[2].user_data as usize, 2);
+
+            // Once topic2 is back, groups are complete again
+            conflux_push_message_by_index(sync, 1, 1_210_000_000, ptr::null_mut());
+            conflux_push_message_by_index(sync, 0, 1_300_000_000, ptr::null_mut());
+            conflux_push_message_by_index(sync, 1, 1_310_000_000, ptr::null_mut());
+            let count = conflux_poll_batch(sync, members.as_mut_ptr(), 1);
+            assert_eq!(count, 1);
+            assert_eq!(members[0].timestamp_ns, 1_200_000_000);
+            assert_eq!(members[1].stream_index, 1);
+
+            conflux_synchronizer_free(sync);
+        }
+    }
+
+    #[test]
+    fn test_window_size_ns_overrides_ms() {
+        let mut config = ConfluxConfig {
+            buffer_size: 10,
+            window_size_ns: 2_500_000,
+            ..Default::default()
+        };
+        assert_eq!(config.window_size(), Some(Duration::from_micros(2500)));
+
+        config.window_size_ns = 0;
+        assert_eq!(config.window_size(), Some(Duration::from_millis(50)));
+
+        config.window_size_ms = 0;
+        assert_eq!(config.window_size(), None);
+    }
+
+    static STALE: AtomicI32 = AtomicI32::new(0);
+
+    extern "C" fn test_stale_callback(
+        _timestamp_ns: i64,
+        _user_data: *mut c_void,
+        reason: ConfluxDropReason,
+        _context: *mut c_void,
+    ) {
+        assert_eq!(reason, ConfluxDropReason::Stale);
+        STALE.fetch_add(1, Ordering::SeqCst);
+    }
+
+    #[test]
+    fn test_staleness_expiry() {
+        let config = ConfluxConfig {
+            buffer_size: 10,
+            staleness: ConfluxStalenessPreset::Default,
+            staleness_timeout_ns: 5_000_000,
+            ..Default::default()
+        };
+
+        let key1 = std::ffi::CString::new("topic1").unwrap();
+        let key2 = std::ffi::CString::new("topic2").unwrap();
+        let keys = [key1.as_ptr(), key2.as_ptr()];
+
+        let sync = unsafe { conflux_synchronizer_new(&config, keys.as_ptr(), keys.len()) };
+        assert!(!sync.is_null());
+
+        unsafe {
+            let result =
+                conflux_set_drop_callback(sync, Some(test_stale_callback), ptr::null_mut());
+            assert_eq!(result, ConfluxResult::Ok);
+            assert_eq!(conflux_next_expiration_ns(sync), -1);
+
+            let result =
+                conflux_push_message_by_index(sync, 0, 1_000_000_000, std::ptr::dangling_mut());
+            assert_eq!(result, ConfluxResult::Ok);
+
+            let remaining = conflux_next_expiration_ns(sync);
+            assert!((0..=5_000_000).contains(&remaining));
+
+            std::thread::sleep(Duration::from_millis(10));
+            assert_eq!(conflux_next_expiration_ns(sync), 0);
+            assert_eq!(conflux_process_expired(sync), 1);
+            assert_eq!(STALE.load(Ordering::SeqCst), 1);
+            assert_eq!(conflux_buffer_len(sync, key1.as_ptr()), 0);
+
+            conflux_synchronizer_free(sync);
+        }
+    }
+
     #[test]
     fn test_invalid_key() {
         let config = ConfluxConfig {
-            window_size_ms: 50,
             buffer_size: 10,
-            drop_policy: ConfluxDropPolicy::RejectNew,
+            ..Default::default()
         };
 
         let key1 = std::ffi::CString::new("topic1").unwrap();
@@ -487,6 +1543,140 @@ mod tests {
             let result =
                 conflux_push_message(sync, invalid_key.as_ptr(), 1_000_000_000, ptr::null_mut());
             assert_eq!(result, ConfluxResult::KeyNotFound);
+            assert_eq!(conflux_key_index(sync, invalid_key.as_ptr()), -1);
+
+            conflux_synchronizer_free(sync);
+        }
+    }
+
+    #[test]
+    fn test_pivot_match_policy() {
+        let mut config = ConfluxConfig {
+            window_size_ms: 100,
+            buffer_size: 10,
+            match_policy: ConfluxMatchPolicy::Pivot,
+            pivot_index: 2,
+            ..Default::default()
+        };
+
+        let key1 = std::ffi::CString::new("topic1").unwrap();
+        let key2 = std::ffi::CString::new("topic2").unwrap();
+        let keys = [key1.as_ptr(), key2.as_ptr()];
+
+        // The pivot index must name a stream
+        let sync = unsafe { conflux_synchronizer_new(&config, keys.as_ptr(), keys.len()) };
+        assert!(sync.is_null());
+
+        config.pivot_index = 0;
+        let sync = unsafe { conflux_synchronizer_new(&config, keys.as_ptr(), keys.len()) };
+        assert!(!sync.is_null());
+
+        unsafe {
+            conflux_push_message_by_index(sync, 0, 1_000_000_000, ptr::null_mut());
+            conflux_push_message_by_index(sync, 1, 990_000_000, ptr::null_mut());
+            assert_eq!(conflux_poll_indexed(sync, None, ptr::null_mut()), 0);
+
+            // Bracketed well before the buffers span the 100 ms window
+            conflux_push_message_by_index(sync, 1, 1_020_000_000, ptr::null_mut());
+            assert_eq!(conflux_poll_indexed(sync, None, ptr::null_mut()), 1);
+            assert_eq!(conflux_buffer_len(sync, key1.as_ptr()), 0);
+            assert_eq!(conflux_buffer_len(sync, key2.as_ptr()), 1);
+
+            conflux_synchronizer_free(sync);
+        }
+    }
+
+    #[test]
+    fn test_get_feedback() {
+        let config = ConfluxConfig {
+            window_size_ms: 100,
+            buffer_size: 2,
+            ..Default::default()
+        };
+
+        let key1 = std::ffi::CString::new("topic1").unwrap();
+        let key2 = std::ffi::CString::new("topic2").unwrap();
+        let keys = [key1.as_ptr(), key2.as_ptr()];
+
+        let sync = unsafe { conflux_synchronizer_new(&config, keys.as_ptr(), keys.len()) };
+        assert!(!sync.is_null());
+
+        let empty = ConfluxStreamFeedback {
+            buffer_full: false,
+            needed_after_ns: 0,
+            buffered: 0,
+        };
+        let mut feedback = [empty; 3];
+
+        unsafe {
+            assert_eq!(conflux_get_feedback(sync, feedback.as_mut_ptr(), 3), 2);
+            assert!(!feedback[0].buffer_full);
+            assert_eq!(feedback[0].needed_after_ns, -1);
+
+            // Stream 0 runs ahead and fills its buffer
+            conflux_push_message_by_index(sync, 0, 1_000_000_000, ptr::null_mut());
+            conflux_push_message_by_index(sync, 0, 1_500_000_000, ptr::null_mut());
+            assert_eq!(conflux_get_feedback(sync, feedback.as_mut_ptr(), 3), 2);
+            assert!(feedback[0].buffer_full);
+            assert_eq!(feedback[0].needed_after_ns, 1_500_000_000);
+            assert_eq!(feedback[0].buffered, 2);
+            assert!(!feedback[1].buffer_full);
+            assert_eq!(feedback[1].needed_after_ns, -1);
+
+            // Emitting a group commits its timestamp for every stream
+            conflux_push_message_by_index(sync, 1, 1_010_000_000, ptr::null_mut());
+            conflux_push_message_by_index(sync, 1, 1_520_000_000, ptr::null_mut());
+            assert_eq!(conflux_poll_indexed(sync, None, ptr::null_mut()), 1);
+            assert_eq!(conflux_get_feedback(sync, feedback.as_mut_ptr(), 1), 1);
+            assert!(!feedback[0].buffer_full);
+            assert_eq!(feedback[0].needed_after_ns, 1_500_000_000);
+
+            conflux_synchronizer_free(sync);
+        }
+    }
+
+    #[test]
+    fn test_snapshot_accessors() {
+        let config = ConfluxConfig {
+            window_size_ms: 100,
+            buffer_size: 4,
+            ..Default::default()
+        };
+
+        let key1 = std::ffi::CString::new("topic1").unwrap();
+        let key2 = std::ffi::CString::new("topic2").unwrap();
+        let keys = [key1.as_ptr(), key2.as_ptr()];
+
+        let sync = unsafe { conflux_synchronizer_new(&config, keys.as_ptr(), keys.len()) };
+        assert!(!sync.is_null());
+
+        let empty = ConfluxGroupMember {
+            stream_index: 0,
+            timestamp_ns: 0,
+            user_data: ptr::null_mut(),
+        };
+        let mut members = [empty; 4];
+
+        unsafe {
+            assert_eq!(conflux_commit_timestamp_ns(sync), -1);
+            conflux_push_message_by_index(sync, 0, 1_000_000_000, 3 as *mut c_void);
+            conflux_push_message_by_index(sync, 0, 1_200_000_000, 2 as *mut c_void);
+            assert_eq!(conflux_peek_buffer(sync, 0, members.as_mut_ptr(), 4), 2);
+            assert_eq!(members[1].timestamp_ns, 1_200_000_000);
+            assert_eq!(members[1].user_data, 2 as *mut c_void);
+            assert_eq!(conflux_peek_buffer(sync, 2, members.as_mut_ptr(), 4), 0);
+
+            let last = [-1, 1_300_000_000];
+            let result = conflux_restore_watermarks(sync, 900_000_000, last.as_ptr(), 1);
+            assert_eq!(result, ConfluxResult::InvalidArgument);
+            let result = conflux_restore_watermarks(sync, 900_000_000, last.as_ptr(), 2);
+            assert_eq!(result, ConfluxResult::Ok);
+            assert_eq!(conflux_commit_timestamp_ns(sync), 900_000_000);
+
+            let result = conflux_push_message_by_index(sync, 1, 1_250_000_000, ptr::null_mut());
+            assert_eq!(result, ConfluxResult::OutOfOrder);
+            let result = conflux_push_message_by_index(sync, 0, 1_250_000_000, ptr::null_mut());
+            assert_eq!(result, ConfluxResult::Ok);
 
             conflux_synchronizer_free(sync);
         }
@@ -0,0 +1,178 @@
+/*
+ * Conflux C++ Library - Bag Synchronizer Implementation
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#include "conflux/bag_synchronizer.hpp"
+
+#include "conflux/cdr.hpp"
+#include "conflux/synchronizer.hpp"
+
+#include "rosbag2_cpp/reader.hpp"
+#include "rosbag2_storage/storage_filter.hpp"
+
+#include <any>
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace conflux {
+
+namespace {
+
+Config bag_config(Config config) {
+    config.eager_dispatch = true;
+    return config;
+}
+
+}  // namespace
+
+/// Internal implementation of the BagSynchronizer class.
+class BagSynchronizer::Impl {
+public:
+    explicit Impl(const Config& config) : sync_(bag_config(config)) {}
+
+    size_t add_topic(const std::string& topic) {
+        if (reader_) {
+            throw std::runtime_error("Cannot add topics after a bag is opened");
+        }
+        size_t index = sync_.add_topic(topic);
+        topics_.push_back(topic);
+        indices_.emplace(topic, index);
+        return index;
+    }
+
+    void on_synchronized(SyncCallback callback) { sync_.on_synchronized(std::move(callback)); }
+
+    void open(const std::string& uri) {
+        rosbag2_storage::StorageOptions storage_options;
+        storage_options.uri = uri;
+        open(storage_options);
+    }
+
+    void open(const rosbag2_storage::StorageOptions& storage_options) {
+        auto reader = std::make_unique<rosbag2_cpp::Reader>();
+
+        // Empty converter options keep the messages in their stored format
+        reader->open(storage_options, rosbag2_cpp::ConverterOptions{});
+
+        std::unordered_map<std::string, std::string> formats;
+        for (const auto& metadata : reader->get_all_topics_and_types()) {
+            formats.emplace(metadata.name, metadata.serialization_format);
+        }
+        for (const auto& topic : topics_) {
+            auto it = formats.find(topic);
+            if (it == formats.end()) {
+                throw std::runtime_error("Topic not found in bag: " + topic);
+            }
+            if (it->second != "cdr") {
+                throw std::runtime_error("Topic is not stored as CDR: " + topic);
+            }
+        }
+
+        // Let the storage plugin skip the other topics
+        rosbag2_storage::StorageFilter filter;
+        filter.topics = topics_;
+        reader->set_filter(filter);
+
+        reader_ = std::move(reader);
+    }
+
+    bool play_next() {
+        if (!reader_) {
+            throw std::runtime_error("No bag is open");
+        }
+        if (!reader_->has_next()) {
+            return false;
+        }
+
+        std::shared_ptr<BagMessage> message = reader_->read_next();
+        auto it = indices_.find(message->topic_name);
+        const auto* data = message->serialized_data.get();
+        std::optional<int64_t> stamp_ns;
+        if (it != indices_.end() && data) {
+            stamp_ns = cdr::header_stamp_ns(data->buffer, data->buffer_length);
+        }
+        if (!stamp_ns) {
+            skipped_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        // Ready groups are delivered on this thread and nothing else frees
+        // space, so a stream still full afterwards stays full until another
+        // topic's message arrives; waiting would never return
+        bool accepted = sync_.push_blocking(
+            it->second, *stamp_ns, std::any(std::shared_ptr<const BagMessage>(std::move(message))),
+            std::chrono::nanoseconds::zero());
+        if (!accepted) {
+            skipped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    size_t play() {
+        size_t count = 0;
+        while (play_next()) {
+            ++count;
+        }
+        return count;
+    }
+
+    uint64_t skipped() const { return skipped_.load(std::memory_order_relaxed); }
+
+    SyncStats stats() const { return sync_.stats(); }
+
+private:
+    Synchronizer sync_;
+    std::vector<std::string> topics_;
+    std::unordered_map<std::string, size_t> indices_;
+    std::unique_ptr<rosbag2_cpp::Reader> reader_;
+    std::atomic<uint64_t> skipped_{0};
+};
+
+// BagSynchronizer implementation
+
+BagSynchronizer::BagSynchronizer(const Config& config) : impl_(std::make_unique<Impl>(config)) {}
+
+BagSynchronizer::~BagSynchronizer() = default;
+
+BagSynchronizer::BagSynchronizer(BagSynchronizer&&) noexcept = default;
+BagSynchronizer& BagSynchronizer::operator=(BagSynchronizer&&) noexcept = default;
+
+size_t BagSynchronizer::add_topic(const std::string& topic) {
+    return impl_->add_topic(topic);
+}
+
+void BagSynchronizer::on_synchronized(SyncCallback callback) {
+    impl_->on_synchronized(std::move(callback));
+}
+
+void BagSynchronizer::open(const std::string& uri) {
+    impl_->open(uri);
+}
+
+void BagSynchronizer::open(const rosbag2_storage::StorageOptions& storage_options) {
+    impl_->open(storage_options);
+}
+
+bool BagSynchronizer::play_next() {
+    return impl_->play_next();
+}
+
+size_t BagSynchronizer::play() {
+    return impl_->play();
+}
+
+uint64_t BagSynchronizer::skipped() const {
+    return impl_->skipped();
+}
+
+SyncStats BagSynchronizer::stats() const {
+    return impl_->stats();
+}
+
+}  // namespace conflux
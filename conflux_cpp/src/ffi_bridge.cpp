@@ -13,14 +13,57 @@ extern "C" {
 #include "conflux_ffi.h"
 }
 
+#include <cstddef>
+
 namespace conflux {
 namespace ffi {
 
-SynchronizerHandle create_synchronizer(uint64_t window_size_ms, size_t buffer_size,
+SynchronizerHandle create_synchronizer(const Config& config,
                                        const std::vector<std::string>& topics) {
-    ConfluxConfig config;
-    config.window_size_ms = window_size_ms;
-    config.buffer_size = buffer_size;
+    ConfluxConfig ffi_config{};
+    ffi_config.buffer_size = config.buffer_size;
+    ffi_config.drop_policy = config.drop_policy == DropPolicy::DropOldest
+                                 ? ConfluxDropPolicy_DropOldest
+                                 : ConfluxDropPolicy_RejectNew;
+
+    switch (config.staleness) {
+        case StalenessPreset::Default:
+            ffi_config.staleness = ConfluxStalenessPreset_Default;
+            break;
+        case StalenessPreset::HighFrequency:
+            ffi_config.staleness = ConfluxStalenessPreset_HighFrequency;
+            break;
+        case StalenessPreset::LowFrequency:
+            ffi_config.staleness = ConfluxStalenessPreset_LowFrequency;
+            break;
+        case StalenessPreset::BatchProcessing:
+            ffi_config.staleness = ConfluxStalenessPreset_BatchProcessing;
+            break;
+        default:
+            ffi_config.staleness = ConfluxStalenessPreset_Disabled;
+            break;
+    }
+    if (config.staleness_timeout.count() > 0) {
+        ffi_config.staleness_timeout_ns = static_cast<uint64_t>(config.staleness_timeout.count());
+    }
+
+    switch (config.match_policy) {
+        case MatchPolicy::Approximate:
+            ffi_config.match_policy = ConfluxMatchPolicy_Approximate;
+            break;
+        case MatchPolicy::Pivot:
+            ffi_config.match_policy = ConfluxMatchPolicy_Pivot;
+            ffi_config.pivot_index = config.pivot_stream;
+            break;
+        default:
+            ffi_config.match_policy = ConfluxMatchPolicy_Window;
+            break;
+    }
+
+    // Both window fields zero selects the infinite window
+    if (!config.infinite_window && config.window_size.count() > 0) {
+        ffi_config.window_size_ns = static_cast<uint64_t>(config.window_size.count());
+    }
 
     // Convert topics to C strings
     std::vector<const char*> topic_ptrs;
@@ -29,7 +72,7 @@ SynchronizerHandle create_synchronizer(uint64_t window_size_ms, size_t buffer_si
         topic_ptrs.push_back(topic.c_str());
     }
 
-    auto* ptr = conflux_synchronizer_new(&config, topic_ptrs.data(), topic_ptrs.size());
+    auto* ptr = conflux_synchronizer_new(&ffi_config, topic_ptrs.data(), topic_ptrs.size());
 
     return SynchronizerHandle{ptr};
 }
@@ -40,19 +83,24 @@ void destroy_synchronizer(SynchronizerHandle handle) {
     }
 }
 
-PushResult push_message(SynchronizerHandle handle, const std::string& topic, int64_t timestamp_ns,
+PushResult push_message(SynchronizerHandle handle, size_t stream_index, int64_t timestamp_ns,
                         void* user_data) {
     if (!handle.ptr) {
         return PushResult::NullPointer;
     }
 
-    auto result = conflux_push_message(handle.ptr, topic.c_str(), timestamp_ns, user_data);
+    auto result =
+        conflux_push_message_by_index(handle.ptr, stream_index, timestamp_ns, user_data);
 
     switch (result) {
         case ConfluxResult_Ok:
             return PushResult::Ok;
         case ConfluxResult_BufferFull:
             return PushResult::BufferFull;
+        case ConfluxResult_LateMessage:
+            return PushResult::LateMessage;
+        case ConfluxResult_OutOfOrder:
+            return PushResult::OutOfOrder;
         case ConfluxResult_KeyNotFound:
             return PushResult::KeyNotFound;
         case ConfluxResult_InvalidArgument:
@@ -64,6 +112,15 @@ PushResult push_message(SynchronizerHandle handle, const std::string& topic, int
     }
 }
 
+bool set_optional(SynchronizerHandle handle, size_t stream_index,
+                  std::chrono::nanoseconds deadline) {
+    if (!handle.ptr) {
+        return false;
+    }
+    auto deadline_ns = static_cast<uint64_t>(deadline.count() > 0 ? deadline.count() : 0);
+    return conflux_set_optional(handle.ptr, stream_index, deadline_ns) == ConfluxResult_Ok;
+}
+
 bool poll(SynchronizerHandle handle, PollCallback callback, void* context) {
     if (!handle.ptr) {
         return false;
@@ -77,15 +134,85 @@ bool poll(SynchronizerHandle handle, PollCallback callback, void* context) {
 
     CallbackWrapper wrapper{callback, context};
 
-    auto c_callback = [](const char* key, int64_t timestamp_ns, void* user_data, void* context) {
+    auto c_callback = [](uintptr_t index, int64_t timestamp_ns, void* user_data, void* context) {
         auto* wrapper = static_cast<CallbackWrapper*>(context);
-        wrapper->callback(key, timestamp_ns, user_data, wrapper->context);
+        wrapper->callback(index, timestamp_ns, user_data, wrapper->context);
     };
 
-    int result = conflux_poll(handle.ptr, c_callback, &wrapper);
+    int result = conflux_poll_indexed(handle.ptr, c_callback, &wrapper);
     return result > 0;
 }
 
+static_assert(sizeof(GroupMember) == sizeof(ConfluxGroupMember) &&
+                  offsetof(GroupMember, stream_index) ==
+                      offsetof(ConfluxGroupMember, stream_index) &&
+                  offsetof(GroupMember, timestamp_ns) ==
+                      offsetof(ConfluxGroupMember, timestamp_ns) &&
+                  offsetof(GroupMember, user_data) == offsetof(ConfluxGroupMember, user_data),
+              "GroupMember must match the layout of ConfluxGroupMember");
+
+size_t poll_batch(SynchronizerHandle handle, GroupMember* members, size_t max_groups) {
+    if (!handle.ptr) {
+        return 0;
+    }
+
+    auto result = conflux_poll_batch(
+        handle.ptr, reinterpret_cast<ConfluxGroupMember*>(members), max_groups);
+    return result > 0 ? static_cast<size_t>(result) : 0;
+}
+
+bool set_drop_handler(SynchronizerHandle handle, const DropHandler* handler) {
+    if (!handle.ptr) {
+        return false;
+    }
+
+    if (!handler) {
+        return conflux_set_drop_callback(handle.ptr, nullptr, nullptr) == ConfluxResult_Ok;
+    }
+
+    auto c_callback = [](int64_t timestamp_ns, void* user_data, ConfluxDropReason reason,
+                         void* context) {
+        auto* handler = static_cast<const DropHandler*>(context);
+        DropReason drop_reason;
+        switch (reason) {
+            case ConfluxDropReason_Window:
+                drop_reason = DropReason::Window;
+                break;
+            case ConfluxDropReason_Overflow:
+                drop_reason = DropReason::Overflow;
+                break;
+            case ConfluxDropReason_Stale:
+                drop_reason = DropReason::Stale;
+                break;
+            case ConfluxDropReason_Expired:
+                drop_reason = DropReason::Expired;
+                break;
+            default:
+                drop_reason = DropReason::Unmatched;
+                break;
+        }
+        handler->callback(timestamp_ns, user_data, drop_reason, handler->context);
+    };
+
+    auto result = conflux_set_drop_callback(handle.ptr, c_callback,
+                                            const_cast<DropHandler*>(handler));
+    return result == ConfluxResult_Ok;
+}
+
+int64_t next_expiration_ns(SynchronizerHandle handle) {
+    if (!handle.ptr) {
+        return -1;
+    }
+    return conflux_next_expiration_ns(handle.ptr);
+}
+
+size_t process_expired(SynchronizerHandle handle) {
+    if (!handle.ptr) {
+        return 0;
+    }
+    return conflux_process_expired(handle.ptr);
+}
+
 size_t key_count(SynchronizerHandle handle) {
     if (!handle.ptr) {
         return 0;
@@ -114,5 +241,55 @@ size_t buffer_len(SynchronizerHandle handle, const std::string& topic) {
     return conflux_buffer_len(handle.ptr, topic.c_str());
 }
 
+bool get_feedback(SynchronizerHandle handle, std::vector<StreamFeedback>& feedback) {
+    if (!handle.ptr) {
+        return false;
+    }
+
+    std::vector<ConfluxStreamFeedback> raw(feedback.size());
+    size_t count = conflux_get_feedback(handle.ptr, raw.data(), raw.size());
+    if (count != conflux_key_count(handle.ptr)) {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        feedback[i].buffer_full = raw[i].buffer_full;
+        feedback[i].needed_after = std::chrono::nanoseconds(raw[i].needed_after_ns);
+        feedback[i].buffered = raw[i].buffered;
+    }
+    return true;
+}
+
+int64_t commit_timestamp_ns(SynchronizerHandle handle) {
+    if (!handle.ptr) {
+        return -1;
+    }
+    return conflux_commit_timestamp_ns(handle.ptr);
+}
+
+std::vector<GroupMember> peek_buffer(SynchronizerHandle handle, size_t stream_index,
+                                     size_t max_members) {
+    std::vector<GroupMember> members;
+    if (!handle.ptr) {
+        return members;
+    }
+
+    members.resize(max_members);
+    size_t count =
+        conflux_peek_buffer(handle.ptr, stream_index,
+                            reinterpret_cast<ConfluxGroupMember*>(members.data()), max_members);
+    members.resize(count);
+    return members;
+}
+
+bool restore_watermarks(SynchronizerHandle handle, int64_t commit_timestamp_ns,
+                        const std::vector<int64_t>& last_timestamps_ns) {
+    if (!handle.ptr) {
+        return false;
+    }
+    auto result = conflux_restore_watermarks(handle.ptr, commit_timestamp_ns,
+                                             last_timestamps_ns.data(), last_timestamps_ns.size());
+    return result == ConfluxResult_Ok;
+}
+
 }  // namespace ffi
 }  // namespace conflux
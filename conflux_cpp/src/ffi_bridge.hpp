@@ -9,6 +9,10 @@
 #ifndef CONFLUX_FFI_BRIDGE_HPP
 #define CONFLUX_FFI_BRIDGE_HPP
 
+#include "conflux/stats.hpp"
+#include "conflux/types.hpp"
+
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <string>
@@ -26,27 +30,80 @@ struct SynchronizerHandle {
 };
 
 /// Result codes for push operations.
-enum class PushResult { Ok, InvalidArgument, BufferFull, KeyNotFound, NullPointer, InternalError };
+enum class PushResult {
+    Ok,
+    InvalidArgument,
+    BufferFull,
+    KeyNotFound,
+    NullPointer,
+    InternalError,
+    LateMessage,
+    OutOfOrder,
+};
 
-/// Callback type for poll results.
-using PollCallback = void (*)(const char* key, int64_t timestamp_ns, void* user_data,
+/// Callback type for poll results, reporting each member's stream index.
+using PollCallback = void (*)(size_t stream_index, int64_t timestamp_ns, void* user_data,
                               void* context);
 
+/// One member of a group returned by poll_batch.
+/// Layout-compatible with ConfluxGroupMember.
+struct GroupMember {
+    size_t stream_index = 0;
+    int64_t timestamp_ns = 0;
+    void* user_data = nullptr;
+};
+
+/// Reasons for a buffered message to be discarded without being emitted.
+enum class DropReason { Window, Overflow, Stale, Expired, Unmatched };
+
+/// Callback type for discarded messages.
+using DropCallback = void (*)(int64_t timestamp_ns, void* user_data, DropReason reason,
+                              void* context);
+
+/// Drop callback registration. Must outlive the registration.
+struct DropHandler {
+    DropCallback callback = nullptr;
+    void* context = nullptr;
+};
+
 /// Create a new synchronizer.
-SynchronizerHandle create_synchronizer(uint64_t window_size_ms, size_t buffer_size,
+/// Each topic's stream index is its position in `topics`.
+SynchronizerHandle create_synchronizer(const Config& config,
                                        const std::vector<std::string>& topics);
 
 /// Destroy a synchronizer.
 void destroy_synchronizer(SynchronizerHandle handle);
 
-/// Push a message to the synchronizer.
-PushResult push_message(SynchronizerHandle handle, const std::string& topic, int64_t timestamp_ns,
+/// Push a message to the stream at the given index.
+PushResult push_message(SynchronizerHandle handle, size_t stream_index, int64_t timestamp_ns,
                         void* user_data);
 
+/// Mark the stream at the given index as optional with a deadline.
+/// Returns false if the index is invalid or no required stream would remain.
+bool set_optional(SynchronizerHandle handle, size_t stream_index,
+                  std::chrono::nanoseconds deadline);
+
 /// Poll for synchronized groups.
 /// Returns true if a group was found.
 bool poll(SynchronizerHandle handle, PollCallback callback, void* context);
 
+/// Poll for up to max_groups synchronized groups at once.
+/// `members` must hold max_groups * key_count records; group g occupies
+/// records [g * key_count, (g + 1) * key_count), ordered by stream index.
+/// Members missing from a partial group have a stream_index of at least
+/// key_count. Returns the number of groups written.
+size_t poll_batch(SynchronizerHandle handle, GroupMember* members, size_t max_groups);
+
+/// Register a handler for discarded messages, or unregister with nullptr.
+bool set_drop_handler(SynchronizerHandle handle, const DropHandler* handler);
+
+/// Get the nanoseconds until the next staleness deadline, or -1 if none.
+int64_t next_expiration_ns(SynchronizerHandle handle);
+
+/// Remove stale messages, reporting them to the drop handler.
+/// Returns the number of messages removed.
+size_t process_expired(SynchronizerHandle handle);
+
 /// Get the number of registered topics.
 size_t key_count(SynchronizerHandle handle);
 
@@ -59,6 +116,23 @@ bool is_empty(SynchronizerHandle handle);
 /// Get the buffer length for a specific topic.
 size_t buffer_len(SynchronizerHandle handle, const std::string& topic);
 
+/// Fill in the rate-control fields of one record per stream.
+/// Returns false if the handle is invalid or `feedback` is too short.
+bool get_feedback(SynchronizerHandle handle, std::vector<StreamFeedback>& feedback);
+
+/// Get the commit timestamp in nanoseconds, or -1 if no group was emitted.
+int64_t commit_timestamp_ns(SynchronizerHandle handle);
+
+/// Get up to max_members messages buffered for a stream, oldest first.
+std::vector<GroupMember> peek_buffer(SynchronizerHandle handle, size_t stream_index,
+                                     size_t max_members);
+
+/// Raise the commit timestamp and each stream's last timestamp; -1 leaves
+/// one as it is. Returns false if `last_timestamps_ns` does not hold one
+/// value per stream.
+bool restore_watermarks(SynchronizerHandle handle, int64_t commit_timestamp_ns,
+                        const std::vector<int64_t>& last_timestamps_ns);
+
 }  // namespace ffi
 }  // namespace conflux
 
@@ -0,0 +1,258 @@
+/*
+ * Conflux C++ Library - Matching Core Implementation
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#include "matching_core.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace conflux {
+namespace detail {
+
+MatchingCore::MatchingCore(const Config& config, const std::vector<std::string>& topics,
+                           Host& host)
+    : host_(host), drop_oldest_(config.drop_policy == DropPolicy::DropOldest) {
+    // The pool holds up to buffer_size messages in the core, as many queued
+    // in the ring, and one being pushed
+    size_t capacity = 2 * config.buffer_size + 1;
+    if (topics.size() > SlotHandle::kStreamMask + 1 || capacity > SlotHandle::kSlotMask + 1) {
+        throw std::runtime_error("Too many topics or buffer_size too large");
+    }
+    if (config.match_policy == MatchPolicy::Pivot && config.pivot_stream >= topics.size()) {
+        throw std::runtime_error("pivot_stream does not name a registered topic");
+    }
+
+    handle_ = ffi::create_synchronizer(config, topics);
+    if (!handle_.ptr) {
+        throw std::runtime_error("Failed to create synchronizer");
+    }
+
+    // One pool and one ring per stream
+    pools_.reserve(topics.size());
+    ingress_.reserve(topics.size());
+    for (size_t i = 0; i < topics.size(); ++i) {
+        pools_.push_back(std::make_unique<PayloadPool>(static_cast<uint32_t>(i), capacity));
+        ingress_.push_back(std::make_unique<Ingress>(capacity));
+    }
+    drain_remaining_.resize(topics.size());
+
+    // Groups are filled in place, so size the member array once
+    group_.topics_ = std::make_shared<const std::vector<std::string>>(topics);
+    group_.members_.resize(topics.size());
+    batch_.resize(kBatchSize * topics.size());
+
+    stats_ = std::make_unique<StatsRecorder>(topics.size());
+
+    // Release payloads of messages the core discards without emitting
+    drop_handler_.callback = [](int64_t, void* user_data, ffi::DropReason reason,
+                                void* context) {
+        auto* core = static_cast<MatchingCore*>(context);
+        auto handle = SlotHandle::from_user_data(user_data);
+        if (handle.stream < core->pools_.size()) {
+            core->stats_->record_evicted(handle.stream, reason);
+        }
+        core->release(handle);
+        core->host_.space_freed();
+    };
+    drop_handler_.context = this;
+    ffi::set_drop_handler(handle_, &drop_handler_);
+}
+
+MatchingCore::~MatchingCore() { ffi::destroy_synchronizer(handle_); }
+
+bool MatchingCore::push(size_t stream_index, int64_t timestamp_ns, std::any message) {
+    // Store the message; a full pool means the stream's buffer is full
+    Payload payload{std::move(message), Clock::now()};
+    auto handle = pools_[stream_index]->acquire(std::move(payload));
+    if (!handle && drop_oldest_) {
+        handle = reclaim(stream_index, payload);
+    }
+    if (!handle) {
+        stats_->record_rejected(stream_index, ffi::PushResult::BufferFull);
+        return false;
+    }
+
+    // The ring holds at least as many entries as the pool has slots, so an
+    // entry with a slot always fits
+    Ingress& ingress = *ingress_[stream_index];
+    {
+        std::lock_guard<std::mutex> lock(ingress.producer_mutex);
+        ingress.entries.try_push(Ingress::Entry{timestamp_ns, handle->to_user_data()});
+    }
+    return true;
+}
+
+ffi::PushResult MatchingCore::push_direct(size_t stream_index, int64_t timestamp_ns,
+                                          Payload& payload, bool relieve) {
+    PayloadPool& pool = *pools_[stream_index];
+    auto handle = pool.acquire(std::move(payload));
+    if (!handle) {
+        // Slots are held by messages queued by other threads meanwhile
+        return ffi::PushResult::BufferFull;
+    }
+
+    void* user_data = handle->to_user_data();
+    auto result = ffi::push_message(handle_, stream_index, timestamp_ns, user_data);
+    if (result == ffi::PushResult::BufferFull && relieve && host_.relieve()) {
+        result = ffi::push_message(handle_, stream_index, timestamp_ns, user_data);
+    }
+    if (result != ffi::PushResult::Ok) {
+        payload = std::move(*pool.take(*handle));
+        return result;
+    }
+
+    stats_->record_accepted(stream_index);
+    return result;
+}
+
+void MatchingCore::drain(bool relieve) {
+    for (size_t i = 0; i < ingress_.size(); ++i) {
+        auto lock = consumer_lock(*ingress_[i]);
+        drain_remaining_[i] = ingress_[i]->entries.size();
+    }
+
+    while (true) {
+        // Entries counted above may since have been discarded by a
+        // producer, so an empty ring ends the stream's share of the drain
+        size_t next = ingress_.size();
+        int64_t oldest = std::numeric_limits<int64_t>::max();
+        for (size_t i = 0; i < ingress_.size(); ++i) {
+            if (drain_remaining_[i] == 0) {
+                continue;
+            }
+            auto lock = consumer_lock(*ingress_[i]);
+            const Ingress::Entry* front = ingress_[i]->entries.front();
+            if (!front) {
+                drain_remaining_[i] = 0;
+            } else if (next == ingress_.size() || front->timestamp_ns < oldest) {
+                oldest = front->timestamp_ns;
+                next = i;
+            }
+        }
+        if (next == ingress_.size()) {
+            break;
+        }
+
+        Ingress::Entry entry;
+        {
+            auto lock = consumer_lock(*ingress_[next]);
+            const Ingress::Entry* front = ingress_[next]->entries.front();
+            if (!front) {
+                drain_remaining_[next] = 0;
+                continue;
+            }
+            entry = *front;
+            ingress_[next]->entries.pop();
+        }
+        --drain_remaining_[next];
+
+        auto result = ffi::push_message(handle_, next, entry.timestamp_ns, entry.user_data);
+        if (result == ffi::PushResult::BufferFull && relieve && host_.relieve()) {
+            result = ffi::push_message(handle_, next, entry.timestamp_ns, entry.user_data);
+        }
+        if (result != ffi::PushResult::Ok) {
+            // Release the slot on failure
+            stats_->record_rejected(next, result);
+            release(SlotHandle::from_user_data(entry.user_data));
+            continue;
+        }
+
+        stats_->record_accepted(next);
+    }
+}
+
+size_t MatchingCore::dispatch_batch(size_t max_groups) {
+    size_t stride = pools_.size();
+    max_groups = std::min(max_groups, kBatchSize);
+
+    size_t count = ffi::poll_batch(handle_, batch_.data(), max_groups);
+    for (size_t i = 0; i < count * stride; ++i) {
+        if (batch_[i].stream_index < pools_.size()) {
+            stats_->record_emitted(batch_[i].stream_index);
+        }
+    }
+    if (count > 0) {
+        host_.space_freed();
+    }
+
+    size_t next = 0;
+    try {
+        for (; next < count; ++next) {
+            Clock::time_point first_arrival = Clock::time_point::max();
+            int64_t newest_ns = 0;
+            for (size_t i = 0; i < stride; ++i) {
+                const auto& member = batch_[next * stride + i];
+                auto handle = SlotHandle::from_user_data(member.user_data);
+                if (handle.stream != member.stream_index || handle.stream >= pools_.size()) {
+                    continue;
+                }
+
+                auto payload = pools_[handle.stream]->take(handle);
+                if (payload) {
+                    first_arrival = std::min(first_arrival, payload->arrival);
+                    newest_ns = std::max(newest_ns, member.timestamp_ns);
+                    group_.set(handle.stream, std::chrono::nanoseconds(member.timestamp_ns),
+                               std::move(payload->message));
+                }
+            }
+
+            if (group_.size() > 0) {
+                stats_->record_group(Clock::now() - first_arrival,
+                                     std::chrono::nanoseconds(newest_ns) - group_.timestamp());
+            }
+
+            host_.deliver(group_);
+            group_.clear();
+        }
+    } catch (...) {
+        group_.clear();
+
+        // Release the members of groups that will not be delivered
+        for (size_t i = (next + 1) * stride; i < count * stride; ++i) {
+            if (batch_[i].stream_index < pools_.size()) {
+                release(SlotHandle::from_user_data(batch_[i].user_data));
+            }
+        }
+        throw;
+    }
+
+    return count;
+}
+
+std::unique_lock<std::mutex> MatchingCore::consumer_lock(Ingress& ingress) const {
+    if (!drop_oldest_) {
+        return std::unique_lock<std::mutex>();
+    }
+    return std::unique_lock<std::mutex>(ingress.producer_mutex);
+}
+
+std::optional<SlotHandle> MatchingCore::reclaim(size_t stream_index, Payload& payload) {
+    Ingress& ingress = *ingress_[stream_index];
+    std::lock_guard<std::mutex> lock(ingress.producer_mutex);
+    while (const Ingress::Entry* front = ingress.entries.front()) {
+        auto handle = SlotHandle::from_user_data(front->user_data);
+        ingress.entries.pop();
+        release(handle);
+        stats_->record_discarded(stream_index);
+
+        auto acquired = pools_[stream_index]->acquire(std::move(payload));
+        if (acquired) {
+            return acquired;
+        }
+    }
+    return std::nullopt;
+}
+
+void MatchingCore::release(const SlotHandle& handle) {
+    if (handle.stream < pools_.size()) {
+        pools_[handle.stream]->release(handle);
+    }
+}
+
+}  // namespace detail
+}  // namespace conflux
@@ -0,0 +1,154 @@
+/*
+ * Conflux C++ Library - Matching Core
+ *
+ * Internal header for the ingress and dispatch path shared by Synchronizer
+ * and SyncEngine: slot pools, per-stream rings, the drain into the core
+ * and the batched delivery of groups.
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#ifndef CONFLUX_MATCHING_CORE_HPP
+#define CONFLUX_MATCHING_CORE_HPP
+
+#include "conflux/detail/slot_pool.hpp"
+#include "conflux/detail/spsc_queue.hpp"
+#include "conflux/types.hpp"
+#include "ffi_bridge.hpp"
+#include "stats_recorder.hpp"
+
+#include <any>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace conflux {
+namespace detail {
+
+/// Owns a core synchronizer together with the messages buffered for it.
+///
+/// Pushes from any thread store the message in a slot of the stream's pool
+/// and queue its handle in the stream's ring. Everything else, which is
+/// draining the rings into the core and delivering the groups it emits,
+/// belongs to a single consumer at a time; the front end provides the
+/// mutual exclusion. Groups are handed to the front end through its Host.
+class MatchingCore {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// A buffered message and the time it was pushed.
+    struct Payload {
+        std::any message;
+        Clock::time_point arrival;
+    };
+
+    using PayloadPool = SlotPool<Payload>;
+
+    /// Number of groups fetched per poll.
+    static constexpr size_t kBatchSize = 64;
+
+    /// Front end hooks, called by the consumer.
+    class Host {
+    public:
+        virtual ~Host() = default;
+
+        /// Take a filled group. Whatever is left in it is released on return.
+        virtual void deliver(SyncGroup& group) = 0;
+
+        /// Deliver ready groups to make room in a full core buffer, ahead of
+        /// rejecting a message. Returns true if any group was delivered.
+        virtual bool relieve() = 0;
+
+        /// The core emitted or discarded buffered messages.
+        virtual void space_freed() {}
+    };
+
+    /// Create the core. Throws std::runtime_error if the configuration does
+    /// not fit the pools or the core rejects it.
+    MatchingCore(const Config& config, const std::vector<std::string>& topics, Host& host);
+    ~MatchingCore();
+
+    MatchingCore(const MatchingCore&) = delete;
+    MatchingCore& operator=(const MatchingCore&) = delete;
+
+    /// Queue a message for the consumer. Safe from any thread. Returns false
+    /// if the message was rejected because the stream's buffer is full.
+    /// Under DropOldest that only happens once no queued message is left to
+    /// discard, e.g. while other pushes to the stream take the freed slots.
+    bool push(size_t stream_index, int64_t timestamp_ns, std::any message);
+
+    /// Push a message straight into the core, bypassing the ring. The
+    /// payload is moved into a slot on success and left in place otherwise.
+    /// With `relieve`, a full core buffer is relieved through the host.
+    ffi::PushResult push_direct(size_t stream_index, int64_t timestamp_ns, Payload& payload,
+                                bool relieve);
+
+    /// Move every queued message into the core, oldest timestamp first
+    /// across all streams. Only messages queued when the drain starts are
+    /// taken, so a steady stream of pushes cannot keep it going. With
+    /// `relieve`, a full core buffer is relieved through the host before the
+    /// message is rejected.
+    void drain(bool relieve);
+
+    /// Fetch up to max_groups ready groups, at most kBatchSize, and deliver
+    /// each to the host. Returns the number delivered.
+    size_t dispatch_batch(size_t max_groups);
+
+    /// Return a slot whose message will not be delivered.
+    void release(const SlotHandle& handle);
+
+    size_t stream_count() const { return pools_.size(); }
+    ffi::SynchronizerHandle handle() const { return handle_; }
+    PayloadPool& pool(size_t stream_index) { return *pools_[stream_index]; }
+    StatsRecorder& stats() const { return *stats_; }
+
+private:
+    /// Per-stream queue of messages not yet handed to the core. Pushes to
+    /// one stream are serialized by the producer mutex, which is
+    /// uncontended when each stream has a single subscription. Under
+    /// DropOldest a producer may also pop the oldest entry, so the consumer
+    /// takes the mutex as well.
+    struct Ingress {
+        explicit Ingress(size_t capacity) : entries(capacity) {}
+
+        /// A message queued for the core.
+        struct Entry {
+            int64_t timestamp_ns = 0;
+            void* user_data = nullptr;
+        };
+
+        std::mutex producer_mutex;
+        SpscQueue<Entry> entries;
+    };
+
+    /// Lock a stream's ring for the consumer, if producers may pop from it.
+    std::unique_lock<std::mutex> consumer_lock(Ingress& ingress) const;
+
+    /// Take a slot for a message under DropOldest by discarding the oldest
+    /// queued messages of the stream. An exhausted pool means the ring holds
+    /// at least buffer_size newer messages, so a drain would evict these
+    /// anyway. Leaves the payload in place if the ring is empty.
+    std::optional<SlotHandle> reclaim(size_t stream_index, Payload& payload);
+
+    Host& host_;
+    bool drop_oldest_;
+    ffi::SynchronizerHandle handle_;
+    ffi::DropHandler drop_handler_;
+
+    std::vector<std::unique_ptr<PayloadPool>> pools_;
+    std::vector<std::unique_ptr<Ingress>> ingress_;
+    std::vector<size_t> drain_remaining_;
+    std::unique_ptr<StatsRecorder> stats_;
+    std::vector<ffi::GroupMember> batch_;
+    SyncGroup group_;
+};
+
+}  // namespace detail
+}  // namespace conflux
+
+#endif  // CONFLUX_MATCHING_CORE_HPP
@@ -0,0 +1,114 @@
+/*
+ * Conflux C++ Library - Realtime Allocation Check Implementation
+ *
+ * With CONFLUX_RT_CHECK, the library interposes glibc's malloc family so
+ * that an allocation inside a NoAllocScope aborts with a message. The
+ * interposed functions forward to glibc's own entry points, so the check
+ * adds one thread-local load to every allocation in the process.
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#include "rt_check.hpp"
+
+#ifdef CONFLUX_RT_CHECK
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <unistd.h>
+
+#if !defined(__GLIBC__)
+#error "CONFLUX_RT_CHECK requires glibc"
+#endif
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+}
+
+namespace conflux {
+namespace detail {
+
+namespace {
+
+/// Initial-exec, so that reading it from inside malloc never allocates
+/// thread-local storage itself. This requires the library to be linked
+/// rather than loaded with dlopen().
+__attribute__((tls_model("initial-exec"))) thread_local bool t_no_alloc = false;
+
+void check_allocation() {
+    if (!t_no_alloc) {
+        return;
+    }
+
+    // Report without allocating, then stop where the debugger can see it
+    t_no_alloc = false;
+    static const char message[] = "conflux: heap allocation on the realtime path\n";
+    ssize_t written = write(STDERR_FILENO, message, sizeof(message) - 1);
+    (void)written;
+    std::abort();
+}
+
+}  // namespace
+
+NoAllocScope::NoAllocScope(bool enabled) : previous_(t_no_alloc) {
+    if (enabled) {
+        t_no_alloc = true;
+    }
+}
+
+NoAllocScope::~NoAllocScope() { t_no_alloc = previous_; }
+
+AllowAllocScope::AllowAllocScope() : previous_(t_no_alloc) { t_no_alloc = false; }
+
+AllowAllocScope::~AllowAllocScope() { t_no_alloc = previous_; }
+
+}  // namespace detail
+}  // namespace conflux
+
+extern "C" {
+
+void* malloc(size_t size) noexcept {
+    conflux::detail::check_allocation();
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+    conflux::detail::check_allocation();
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) noexcept {
+    conflux::detail::check_allocation();
+    return __libc_realloc(pointer, size);
+}
+
+void* memalign(size_t alignment, size_t size) noexcept {
+    conflux::detail::check_allocation();
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept {
+    conflux::detail::check_allocation();
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** pointer, size_t alignment, size_t size) noexcept {
+    conflux::detail::check_allocation();
+    if (alignment == 0 || alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    void* result = __libc_memalign(alignment, size);
+    if (!result) {
+        return ENOMEM;
+    }
+    *pointer = result;
+    return 0;
+}
+
+}  // extern "C"
+
+#endif  // CONFLUX_RT_CHECK
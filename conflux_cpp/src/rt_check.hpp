@@ -0,0 +1,67 @@
+/*
+ * Conflux C++ Library - Realtime Allocation Check
+ *
+ * Internal header for the CONFLUX_RT_CHECK build option, which aborts on
+ * heap allocation in the push, match and dispatch path of a synchronizer
+ * prepared with Synchronizer::preallocate(). Without the option the scopes
+ * are empty and cost nothing.
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#ifndef CONFLUX_RT_CHECK_HPP
+#define CONFLUX_RT_CHECK_HPP
+
+namespace conflux {
+namespace detail {
+
+#ifdef CONFLUX_RT_CHECK
+
+/// Aborts the process if the current thread allocates from the heap while
+/// the scope is alive. Allocations by C++ and by the Rust core are caught
+/// alike, as both go through malloc. Nested scopes restore the previous
+/// state on exit.
+class NoAllocScope {
+public:
+    /// @param enabled Whether to check at all, e.g. only once preallocated
+    explicit NoAllocScope(bool enabled);
+    ~NoAllocScope();
+
+    NoAllocScope(const NoAllocScope&) = delete;
+    NoAllocScope& operator=(const NoAllocScope&) = delete;
+
+private:
+    bool previous_;
+};
+
+/// Suspends an enclosing NoAllocScope, e.g. around the user callback.
+class AllowAllocScope {
+public:
+    AllowAllocScope();
+    ~AllowAllocScope();
+
+    AllowAllocScope(const AllowAllocScope&) = delete;
+    AllowAllocScope& operator=(const AllowAllocScope&) = delete;
+
+private:
+    bool previous_;
+};
+
+#else
+
+class NoAllocScope {
+public:
+    explicit NoAllocScope(bool) {}
+};
+
+class AllowAllocScope {
+public:
+    AllowAllocScope() {}
+};
+
+#endif  // CONFLUX_RT_CHECK
+
+}  // namespace detail
+}  // namespace conflux
+
+#endif  // CONFLUX_RT_CHECK_HPP
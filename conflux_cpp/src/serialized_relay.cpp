@@ -0,0 +1,43 @@
+/*
+ * Conflux C++ Library - Serialized Relay Implementation
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#include "conflux/serialized_relay.hpp"
+
+#include <stdexcept>
+
+namespace conflux {
+
+SerializedRelay::SerializedRelay(rclcpp::Node::SharedPtr node) : node_(std::move(node)) {
+    if (!node_) {
+        throw std::runtime_error("SerializedRelay requires a node");
+    }
+}
+
+void SerializedRelay::add_output(size_t stream_index, const std::string& topic,
+                                 const std::string& type_name, const rclcpp::QoS& qos) {
+    if (stream_index >= publishers_.size()) {
+        publishers_.resize(stream_index + 1);
+    }
+    publishers_[stream_index] = node_->create_generic_publisher(topic, type_name, qos);
+}
+
+size_t SerializedRelay::publish(const SyncGroup& group) const {
+    size_t published = 0;
+    for (size_t i = 0; i < publishers_.size(); ++i) {
+        if (!publishers_[i]) {
+            continue;
+        }
+        const auto* message = group.get<rclcpp::SerializedMessage>(i);
+        if (!message) {
+            continue;
+        }
+        publishers_[i]->publish(*message);
+        ++published;
+    }
+    return published;
+}
+
+}  // namespace conflux
@@ -0,0 +1,120 @@
+/*
+ * Conflux C++ Library - Snapshot Format
+ *
+ * Internal header for the binary layout behind Synchronizer::snapshot() and
+ * Synchronizer::restore().
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#ifndef CONFLUX_SNAPSHOT_FORMAT_HPP
+#define CONFLUX_SNAPSHOT_FORMAT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace conflux {
+namespace detail {
+
+/// A snapshot is a little-endian sequence of:
+///
+/// - magic "CFXS", u32 version
+/// - i64 commit timestamp in nanoseconds, -1 for none
+/// - u32 stream count, then per stream in stream index order:
+///   - u32 topic length, topic bytes
+///   - i64 timestamp new messages must be stamped after, -1 for none
+///   - u32 message count, then per buffered message, oldest first:
+///     i64 timestamp, u32 payload length, payload bytes
+constexpr char kSnapshotMagic[4] = {'C', 'F', 'X', 'S'};
+constexpr uint32_t kSnapshotVersion = 1;
+
+/// Appends snapshot fields to a byte vector.
+class SnapshotWriter {
+public:
+    SnapshotWriter() { bytes_.insert(bytes_.end(), kSnapshotMagic, kSnapshotMagic + 4); }
+
+    void write_u32(uint32_t value) { write_le(value, 4); }
+    void write_i64(int64_t value) { write_le(static_cast<uint64_t>(value), 8); }
+
+    void write_bytes(const uint8_t* data, size_t size) {
+        write_u32(static_cast<uint32_t>(size));
+        bytes_.insert(bytes_.end(), data, data + size);
+    }
+
+    void write_string(const std::string& value) {
+        write_bytes(reinterpret_cast<const uint8_t*>(value.data()), value.size());
+    }
+
+    std::vector<uint8_t> take() { return std::move(bytes_); }
+
+private:
+    void write_le(uint64_t value, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            bytes_.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    std::vector<uint8_t> bytes_;
+};
+
+/// Reads snapshot fields, throwing std::runtime_error past the end.
+class SnapshotReader {
+public:
+    SnapshotReader(const uint8_t* data, size_t size) : data_(data), size_(size) {
+        if (size_ < 4 || std::memcmp(data_, kSnapshotMagic, 4) != 0) {
+            throw std::runtime_error("Not a synchronizer snapshot");
+        }
+        offset_ = 4;
+    }
+
+    uint32_t read_u32() { return static_cast<uint32_t>(read_le(4)); }
+    int64_t read_i64() { return static_cast<int64_t>(read_le(8)); }
+
+    /// Read a length-prefixed byte string, returning a pointer into the
+    /// snapshot.
+    const uint8_t* read_bytes(size_t& size) {
+        size = read_u32();
+        return advance(size);
+    }
+
+    std::string read_string() {
+        size_t size = 0;
+        const uint8_t* bytes = read_bytes(size);
+        return std::string(reinterpret_cast<const char*>(bytes), size);
+    }
+
+    bool at_end() const { return offset_ == size_; }
+
+private:
+    uint64_t read_le(size_t size) {
+        const uint8_t* bytes = advance(size);
+        uint64_t value = 0;
+        for (size_t i = 0; i < size; ++i) {
+            value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+        }
+        return value;
+    }
+
+    const uint8_t* advance(size_t size) {
+        if (size > size_ - offset_) {
+            throw std::runtime_error("Truncated synchronizer snapshot");
+        }
+        const uint8_t* bytes = data_ + offset_;
+        offset_ += size;
+        return bytes;
+    }
+
+    const uint8_t* data_;
+    size_t size_;
+    size_t offset_ = 0;
+};
+
+}  // namespace detail
+}  // namespace conflux
+
+#endif  // CONFLUX_SNAPSHOT_FORMAT_HPP
@@ -0,0 +1,194 @@
+/*
+ * Conflux C++ Library - Statistics Recorder
+ *
+ * Internal header for the lock-free counters behind Synchronizer::stats().
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#ifndef CONFLUX_STATS_RECORDER_HPP
+#define CONFLUX_STATS_RECORDER_HPP
+
+#include "conflux/stats.hpp"
+#include "ffi_bridge.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace conflux {
+namespace detail {
+
+/// Records synchronizer events into relaxed atomics.
+///
+/// Recording never blocks or allocates, and snapshot() may run concurrently
+/// from any thread. A snapshot is not taken atomically as a whole, so
+/// counters updated during the snapshot may be off by the events in flight.
+class StatsRecorder {
+public:
+    explicit StatsRecorder(size_t stream_count)
+        : stream_count_(stream_count), streams_(std::make_unique<StreamCounters[]>(stream_count)) {}
+
+    StatsRecorder(const StatsRecorder&) = delete;
+    StatsRecorder& operator=(const StatsRecorder&) = delete;
+
+    void record_accepted(size_t stream) {
+        StreamCounters& counters = streams_[stream];
+        counters.accepted.fetch_add(1, std::memory_order_relaxed);
+        uint64_t depth = counters.depth.fetch_add(1, std::memory_order_relaxed) + 1;
+        store_max(counters.peak_depth, depth);
+    }
+
+    void record_rejected(size_t stream, ffi::PushResult result) {
+        StreamCounters& counters = streams_[stream];
+        switch (result) {
+            case ffi::PushResult::BufferFull:
+                counters.rejected_buffer_full.fetch_add(1, std::memory_order_relaxed);
+                break;
+            case ffi::PushResult::LateMessage:
+                counters.rejected_late.fetch_add(1, std::memory_order_relaxed);
+                break;
+            case ffi::PushResult::OutOfOrder:
+                counters.rejected_out_of_order.fetch_add(1, std::memory_order_relaxed);
+                break;
+            default:
+                break;
+        }
+    }
+
+    void record_evicted(size_t stream, ffi::DropReason reason) {
+        StreamCounters& counters = streams_[stream];
+        counters.evicted[static_cast<size_t>(reason)].fetch_add(1, std::memory_order_relaxed);
+        counters.depth.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /// Record a queued message discarded under DropOldest before it reached
+    /// the core. It was accepted by the push but never counted towards the
+    /// buffer depth.
+    void record_discarded(size_t stream) {
+        StreamCounters& counters = streams_[stream];
+        counters.accepted.fetch_add(1, std::memory_order_relaxed);
+        counters.evicted[kOverflow].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// Record a member taken out of the core as part of a matched group.
+    void record_emitted(size_t stream) {
+        StreamCounters& counters = streams_[stream];
+        counters.emitted.fetch_add(1, std::memory_order_relaxed);
+        counters.depth.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /// Record a group about to be delivered to the callback.
+    void record_group(std::chrono::nanoseconds latency, std::chrono::nanoseconds skew) {
+        groups_.fetch_add(1, std::memory_order_relaxed);
+        latency_.record(latency);
+        skew_.record(skew);
+    }
+
+    /// Record a queued group discarded to make room for a newer one.
+    void record_group_dropped() { groups_dropped_.fetch_add(1, std::memory_order_relaxed); }
+
+    /// Copy the current values, labelling streams with the given topics.
+    SyncStats snapshot(const std::vector<std::string>& topics) const {
+        SyncStats stats;
+        stats.streams.resize(stream_count_);
+        for (size_t i = 0; i < stream_count_; ++i) {
+            const StreamCounters& counters = streams_[i];
+            StreamStats& stream = stats.streams[i];
+            stream.topic = i < topics.size() ? topics[i] : std::string();
+            stream.accepted = load(counters.accepted);
+            stream.emitted = load(counters.emitted);
+            stream.rejected_buffer_full = load(counters.rejected_buffer_full);
+            stream.rejected_late = load(counters.rejected_late);
+            stream.rejected_out_of_order = load(counters.rejected_out_of_order);
+            stream.evicted_window = load(counters.evicted[kWindow]);
+            stream.evicted_overflow = load(counters.evicted[kOverflow]);
+            stream.evicted_stale = load(counters.evicted[kStale]);
+            stream.evicted_expired = load(counters.evicted[kExpired]);
+            stream.evicted_unmatched = load(counters.evicted[kUnmatched]);
+            stream.buffer_depth = static_cast<size_t>(load(counters.depth));
+            stream.peak_buffer_depth = static_cast<size_t>(load(counters.peak_depth));
+        }
+        stats.groups = load(groups_);
+        stats.groups_dropped = load(groups_dropped_);
+        latency_.copy_to(stats.latency);
+        skew_.copy_to(stats.skew);
+        return stats;
+    }
+
+private:
+    static constexpr size_t kWindow = static_cast<size_t>(ffi::DropReason::Window);
+    static constexpr size_t kOverflow = static_cast<size_t>(ffi::DropReason::Overflow);
+    static constexpr size_t kStale = static_cast<size_t>(ffi::DropReason::Stale);
+    static constexpr size_t kExpired = static_cast<size_t>(ffi::DropReason::Expired);
+    static constexpr size_t kUnmatched = static_cast<size_t>(ffi::DropReason::Unmatched);
+    static constexpr size_t kReasonCount = kUnmatched + 1;
+
+    using Counter = std::atomic<uint64_t>;
+
+    static uint64_t load(const Counter& counter) {
+        return counter.load(std::memory_order_relaxed);
+    }
+
+    static void store_max(Counter& counter, uint64_t value) {
+        uint64_t current = counter.load(std::memory_order_relaxed);
+        while (value > current &&
+               !counter.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    /// Counters of one stream, padded to a cache line so streams pushed
+    /// from different threads do not share one.
+    struct alignas(64) StreamCounters {
+        Counter accepted{0};
+        Counter emitted{0};
+        Counter rejected_buffer_full{0};
+        Counter rejected_late{0};
+        Counter rejected_out_of_order{0};
+        std::array<Counter, kReasonCount> evicted{};
+        Counter depth{0};
+        Counter peak_depth{0};
+    };
+
+    class AtomicHistogram {
+    public:
+        void record(std::chrono::nanoseconds value) {
+            buckets_[Histogram::bucket_of(value)].fetch_add(1, std::memory_order_relaxed);
+            count_.fetch_add(1, std::memory_order_relaxed);
+            auto ns = static_cast<uint64_t>(value.count() > 0 ? value.count() : 0);
+            sum_.fetch_add(ns, std::memory_order_relaxed);
+            store_max(max_, ns);
+        }
+
+        void copy_to(Histogram& histogram) const {
+            for (size_t b = 0; b < Histogram::kBucketCount; ++b) {
+                histogram.buckets[b] = load(buckets_[b]);
+            }
+            histogram.count = load(count_);
+            histogram.sum = std::chrono::nanoseconds(static_cast<int64_t>(load(sum_)));
+            histogram.max = std::chrono::nanoseconds(static_cast<int64_t>(load(max_)));
+        }
+
+    private:
+        std::array<Counter, Histogram::kBucketCount> buckets_{};
+        Counter count_{0};
+        Counter sum_{0};
+        Counter max_{0};
+    };
+
+    size_t stream_count_;
+    std::unique_ptr<StreamCounters[]> streams_;
+    Counter groups_{0};
+    Counter groups_dropped_{0};
+    AtomicHistogram latency_;
+    AtomicHistogram skew_;
+};
+
+}  // namespace detail
+}  // namespace conflux
+
+#endif  // CONFLUX_STATS_RECORDER_HPP
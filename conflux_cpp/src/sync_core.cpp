@@ -0,0 +1,102 @@
+/*
+ * Conflux C++ Library - Sync Core Implementation
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#include "conflux/detail/sync_core.hpp"
+
+#include "ffi_bridge.hpp"
+
+#include <cstddef>
+#include <stdexcept>
+
+namespace conflux {
+namespace detail {
+
+static_assert(sizeof(SyncCore::Member) == sizeof(ffi::GroupMember) &&
+                  offsetof(SyncCore::Member, stream_index) ==
+                      offsetof(ffi::GroupMember, stream_index) &&
+                  offsetof(SyncCore::Member, timestamp_ns) ==
+                      offsetof(ffi::GroupMember, timestamp_ns) &&
+                  offsetof(SyncCore::Member, user_data) == offsetof(ffi::GroupMember, user_data),
+              "SyncCore::Member must match the layout of ffi::GroupMember");
+
+/// Internal implementation of the SyncCore class.
+class SyncCore::Impl {
+public:
+    Impl(const Config& config, const std::vector<std::string>& topics, DropCallback on_drop,
+         void* context)
+        : on_drop_(on_drop), context_(context), stream_count_(topics.size()) {
+        handle_ = ffi::create_synchronizer(config, topics);
+        if (!handle_.ptr) {
+            throw std::runtime_error("Failed to create synchronizer");
+        }
+
+        drop_handler_.callback = [](int64_t, void* user_data, ffi::DropReason, void* context) {
+            auto* impl = static_cast<Impl*>(context);
+            impl->on_drop_(user_data, impl->context_);
+        };
+        drop_handler_.context = this;
+        ffi::set_drop_handler(handle_, &drop_handler_);
+    }
+
+    ~Impl() { ffi::destroy_synchronizer(handle_); }
+
+    bool push(size_t stream_index, int64_t timestamp_ns, void* user_data) {
+        return ffi::push_message(handle_, stream_index, timestamp_ns, user_data) ==
+               ffi::PushResult::Ok;
+    }
+
+    size_t poll_batch(Member* members, size_t max_groups) {
+        return ffi::poll_batch(handle_, reinterpret_cast<ffi::GroupMember*>(members), max_groups);
+    }
+
+    int64_t next_expiration_ns() const { return ffi::next_expiration_ns(handle_); }
+
+    size_t process_expired() { return ffi::process_expired(handle_); }
+
+    size_t stream_count() const { return stream_count_; }
+
+    bool is_ready() const { return ffi::is_ready(handle_); }
+
+private:
+    DropCallback on_drop_;
+    void* context_;
+    size_t stream_count_;
+    ffi::SynchronizerHandle handle_;
+    ffi::DropHandler drop_handler_;
+};
+
+SyncCore::SyncCore(const Config& config, const std::vector<std::string>& topics,
+                   DropCallback on_drop, void* context)
+    : impl_(std::make_unique<Impl>(config, topics, on_drop, context)) {}
+
+SyncCore::~SyncCore() = default;
+
+bool SyncCore::push(size_t stream_index, int64_t timestamp_ns, void* user_data) {
+    return impl_->push(stream_index, timestamp_ns, user_data);
+}
+
+size_t SyncCore::poll_batch(Member* members, size_t max_groups) {
+    return impl_->poll_batch(members, max_groups);
+}
+
+int64_t SyncCore::next_expiration_ns() const {
+    return impl_->next_expiration_ns();
+}
+
+size_t SyncCore::process_expired() {
+    return impl_->process_expired();
+}
+
+size_t SyncCore::stream_count() const {
+    return impl_->stream_count();
+}
+
+bool SyncCore::is_ready() const {
+    return impl_->is_ready();
+}
+
+}  // namespace detail
+}  // namespace conflux
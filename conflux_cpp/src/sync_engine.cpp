@@ -0,0 +1,419 @@
+/*
+ * Conflux C++ Library - Sync Engine Implementation
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#include "conflux/sync_engine.hpp"
+
+#include "ffi_bridge.hpp"
+#include "matching_core.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace conflux {
+
+using detail::MatchingCore;
+
+namespace detail {
+
+/// One synchronizer hosted by the engine.
+///
+/// Producers only touch the pools and rings. Everything else belongs to the
+/// thread that took the instance off the ready queue, of which there is at
+/// most one at a time.
+class EngineInstance : public MatchingCore::Host {
+public:
+    EngineInstance(InstanceId id, const Config& config, const std::vector<std::string>& topics)
+        : id_(id), config_(config), topics_(topics), core_(config, check_topics(topics), *this) {}
+
+    EngineInstance(const EngineInstance&) = delete;
+    EngineInstance& operator=(const EngineInstance&) = delete;
+
+    void set_optional(size_t stream_index, std::chrono::nanoseconds deadline) {
+        if (stream_index >= core_.stream_count()) {
+            throw std::out_of_range("Stream index out of range");
+        }
+        if (!ffi::set_optional(core_.handle(), stream_index, deadline)) {
+            throw std::runtime_error("Too many optional streams, or the pivot is optional");
+        }
+    }
+
+    /// Queue a message for the core. Safe from any thread. Returns false if
+    /// the message was dropped.
+    bool push(size_t stream_index, int64_t timestamp_ns, std::any message) {
+        if (stream_index >= core_.stream_count() ||
+            !core_.push(stream_index, timestamp_ns, std::move(message))) {
+            return false;
+        }
+        pushes_.fetch_add(1);
+        return true;
+    }
+
+    /// Move the queued messages into the core and deliver up to
+    /// `max_groups` groups. Sets `more` if further groups may be ready.
+    /// Returns the number of groups delivered.
+    size_t run(const EngineCallback& callback, size_t max_groups, bool& more) {
+        if (expire_requested_.exchange(false)) {
+            ffi::process_expired(core_.handle());
+        }
+
+        // A core buffer that is full under RejectNew is relieved by
+        // delivering ready groups before the message is rejected
+        callback_ = &callback;
+        relieved_ = 0;
+        core_.drain(static_cast<bool>(callback));
+        size_t count = deliver_groups(max_groups);
+        callback_ = nullptr;
+
+        more = count == max_groups && callback;
+        return relieved_ + count;
+    }
+
+    InstanceId id() const { return id_; }
+
+    bool stale_tracking() const { return config_.staleness != StalenessPreset::Disabled; }
+
+    SyncStats stats() const { return core_.stats().snapshot(topics_); }
+
+    /// Set while the instance is on the ready queue or being run.
+    std::atomic<bool> scheduled{false};
+
+    /// Counts accepted pushes, so the runner can tell whether any arrived
+    /// while it was running.
+    const std::atomic<uint64_t>& pushes() const { return pushes_; }
+
+    void request_expiry() { expire_requested_.store(true); }
+
+private:
+    static const std::vector<std::string>& check_topics(const std::vector<std::string>& topics) {
+        if (topics.empty()) {
+            throw std::runtime_error("An instance needs at least one topic");
+        }
+        return topics;
+    }
+
+    /// Deliver up to max_groups ready groups. Returns the number delivered.
+    size_t deliver_groups(size_t max_groups) {
+        if (!*callback_) {
+            return 0;
+        }
+
+        size_t total = 0;
+        while (total < max_groups) {
+            size_t batch = std::min(MatchingCore::kBatchSize, max_groups - total);
+            size_t count = core_.dispatch_batch(batch);
+            total += count;
+            if (count < batch) {
+                break;
+            }
+        }
+        return total;
+    }
+
+    void deliver(SyncGroup& group) override { (*callback_)(id_, group); }
+
+    bool relieve() override {
+        size_t count = deliver_groups(std::numeric_limits<size_t>::max());
+        relieved_ += count;
+        return count > 0;
+    }
+
+    InstanceId id_;
+    Config config_;
+    std::vector<std::string> topics_;
+    MatchingCore core_;
+
+    /// The callback of the current run(), and the groups it delivered to
+    /// make room while draining.
+    const EngineCallback* callback_ = nullptr;
+    size_t relieved_ = 0;
+
+    std::atomic<uint64_t> pushes_{0};
+    std::atomic<bool> expire_requested_{false};
+};
+
+}  // namespace detail
+
+using detail::EngineInstance;
+
+/// Internal implementation of the SyncEngine class.
+///
+/// The ready queue is a ring sized to the instance table. An instance is
+/// queued only by whoever flips its `scheduled` flag from false to true,
+/// so it is on the queue at most once and the ring never overflows.
+class SyncEngine::Impl {
+public:
+    explicit Impl(const EngineOptions& options)
+        : options_(options),
+          instances_(std::make_unique<std::unique_ptr<EngineInstance>[]>(options.max_instances)),
+          ready_(options.max_instances) {
+        if (options_.max_groups_per_turn == 0) {
+            options_.max_groups_per_turn = 1;
+        }
+    }
+
+    ~Impl() { stop(); }
+
+    InstanceId add_instance(const Config& config, const std::vector<std::string>& topics) {
+        std::lock_guard<std::mutex> lock(instances_mutex_);
+        size_t count = instance_count_.load(std::memory_order_relaxed);
+        if (count >= options_.max_instances) {
+            throw std::runtime_error("EngineOptions::max_instances reached");
+        }
+
+        auto id = static_cast<InstanceId>(count);
+        instances_[count] = std::make_unique<EngineInstance>(id, config, topics);
+
+        // Publish the instance to lock-free lookups
+        instance_count_.store(count + 1, std::memory_order_release);
+        return id;
+    }
+
+    void set_optional(InstanceId id, size_t stream_index, std::chrono::nanoseconds deadline) {
+        at(id).set_optional(stream_index, deadline);
+    }
+
+    void set_callback(EngineCallback callback) {
+        if (running()) {
+            throw std::runtime_error("Cannot change the callback while running");
+        }
+        callback_ = std::move(callback);
+    }
+
+    void push_message(InstanceId id, size_t stream_index, int64_t timestamp_ns,
+                      std::any message) {
+        EngineInstance* instance = find(id);
+        if (instance && instance->push(stream_index, timestamp_ns, std::move(message))) {
+            schedule(*instance);
+        }
+    }
+
+    size_t run_once() {
+        // Only instances queued so far, so a steady stream of pushes cannot
+        // keep the caller here
+        size_t queued = 0;
+        {
+            std::lock_guard<std::mutex> lock(ready_mutex_);
+            queued = ready_size_;
+        }
+
+        size_t delivered = 0;
+        for (; queued > 0; --queued) {
+            EngineInstance* instance = pop_ready(false);
+            if (!instance) {
+                break;
+            }
+            delivered += run_instance(*instance);
+        }
+        return delivered;
+    }
+
+    void start() {
+        if (!workers_.empty()) {
+            throw std::runtime_error("SyncEngine is already running");
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(ready_mutex_);
+            stop_requested_ = false;
+        }
+        running_.store(true);
+        size_t count = std::max<size_t>(options_.worker_count, 1);
+        workers_.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            workers_.emplace_back([this]() { run_worker(); });
+        }
+    }
+
+    void stop() {
+        if (workers_.empty()) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(ready_mutex_);
+            stop_requested_ = true;
+        }
+        ready_cv_.notify_all();
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+        workers_.clear();
+        running_.store(false);
+    }
+
+    bool running() const { return running_.load(); }
+
+    void process_expired() {
+        size_t count = instance_count();
+        for (size_t i = 0; i < count; ++i) {
+            EngineInstance& instance = *instances_[i];
+            if (instance.stale_tracking()) {
+                instance.request_expiry();
+                schedule(instance);
+            }
+        }
+    }
+
+    size_t instance_count() const { return instance_count_.load(std::memory_order_acquire); }
+
+    SyncStats stats(InstanceId id) const { return at(id).stats(); }
+
+private:
+    EngineInstance* find(InstanceId id) const {
+        return id < instance_count() ? instances_[id].get() : nullptr;
+    }
+
+    EngineInstance& at(InstanceId id) const {
+        EngineInstance* instance = find(id);
+        if (!instance) {
+            throw std::out_of_range("Unknown instance");
+        }
+        return *instance;
+    }
+
+    /// Put an instance on the ready queue unless it is already there or
+    /// being run.
+    void schedule(EngineInstance& instance) {
+        if (instance.scheduled.exchange(true)) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(ready_mutex_);
+            ready_[(ready_head_ + ready_size_) % ready_.size()] = instance.id();
+            ++ready_size_;
+        }
+        ready_cv_.notify_one();
+    }
+
+    /// Take the next ready instance, optionally waiting for one. Returns
+    /// nullptr if none is ready, or once stop() is requested while waiting.
+    EngineInstance* pop_ready(bool wait) {
+        std::unique_lock<std::mutex> lock(ready_mutex_);
+        if (wait) {
+            ready_cv_.wait(lock, [this]() { return stop_requested_ || ready_size_ > 0; });
+            if (stop_requested_) {
+                return nullptr;
+            }
+        }
+        if (ready_size_ == 0) {
+            return nullptr;
+        }
+
+        InstanceId id = ready_[ready_head_];
+        ready_head_ = (ready_head_ + 1) % ready_.size();
+        --ready_size_;
+        return instances_[id].get();
+    }
+
+    /// Run a scheduled instance, then queue it again if it has more to do.
+    size_t run_instance(EngineInstance& instance) {
+        // Pushes that land after this read bump the count, and either see
+        // the flag still set or are caught by the check below
+        uint64_t seen = instance.pushes().load();
+        bool more = false;
+        size_t delivered = 0;
+        try {
+            delivered = instance.run(callback_, options_.max_groups_per_turn, more);
+        } catch (...) {
+            instance.scheduled.store(false);
+            schedule(instance);
+            throw;
+        }
+
+        instance.scheduled.store(false);
+        if (more || instance.pushes().load() != seen) {
+            schedule(instance);
+        }
+        return delivered;
+    }
+
+    /// Worker thread: run ready instances until stop() is requested.
+    void run_worker() {
+        while (EngineInstance* instance = pop_ready(true)) {
+            run_instance(*instance);
+        }
+    }
+
+    EngineOptions options_;
+    EngineCallback callback_;
+
+    std::mutex instances_mutex_;
+    std::unique_ptr<std::unique_ptr<EngineInstance>[]> instances_;
+    std::atomic<size_t> instance_count_{0};
+
+    std::mutex ready_mutex_;
+    std::condition_variable ready_cv_;
+    std::vector<InstanceId> ready_;
+    size_t ready_head_ = 0;
+    size_t ready_size_ = 0;
+    bool stop_requested_ = false;
+
+    std::vector<std::thread> workers_;
+    std::atomic<bool> running_{false};
+};
+
+// SyncEngine implementation
+
+SyncEngine::SyncEngine(const EngineOptions& options) : impl_(std::make_unique<Impl>(options)) {}
+
+SyncEngine::~SyncEngine() = default;
+
+SyncEngine::SyncEngine(SyncEngine&&) noexcept = default;
+SyncEngine& SyncEngine::operator=(SyncEngine&&) noexcept = default;
+
+InstanceId SyncEngine::add_instance(const Config& config, const std::vector<std::string>& topics) {
+    return impl_->add_instance(config, topics);
+}
+
+void SyncEngine::set_optional(InstanceId instance, size_t stream_index,
+                              std::chrono::nanoseconds deadline) {
+    impl_->set_optional(instance, stream_index, deadline);
+}
+
+void SyncEngine::on_synchronized(EngineCallback callback) {
+    impl_->set_callback(std::move(callback));
+}
+
+void SyncEngine::push_message(InstanceId instance, size_t stream_index, int64_t timestamp_ns,
+                              std::any message) {
+    impl_->push_message(instance, stream_index, timestamp_ns, std::move(message));
+}
+
+size_t SyncEngine::run_once() {
+    return impl_->run_once();
+}
+
+void SyncEngine::start() {
+    impl_->start();
+}
+
+void SyncEngine::stop() {
+    impl_->stop();
+}
+
+bool SyncEngine::running() const {
+    return impl_->running();
+}
+
+void SyncEngine::process_expired() {
+    impl_->process_expired();
+}
+
+size_t SyncEngine::instance_count() const {
+    return impl_->instance_count();
+}
+
+SyncStats SyncEngine::stats(InstanceId instance) const {
+    return impl_->stats(instance);
+}
+
+}  // namespace conflux
@@ -6,146 +6,983 @@
 
 #include "conflux/synchronizer.hpp"
 
+#include "conflux/cdr.hpp"
+#include "conflux/detail/deadline_timer.hpp"
 #include "ffi_bridge.hpp"
+#include "matching_core.hpp"
+#include "rt_check.hpp"
+#include "snapshot_format.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <limits>
 #include <mutex>
-#include <unordered_map>
+#include <stdexcept>
+#include <thread>
+#include <utility>
 
 namespace conflux {
 
+using detail::MatchingCore;
+using detail::SlotHandle;
+
 /// Internal implementation of the Synchronizer class.
-class Synchronizer::Impl {
+///
+/// Pushes from any thread go into a per-stream ring instead of the core,
+/// which is not thread-safe. The thread whose push finds no drain in
+/// progress becomes the matcher: it takes the core lock, moves every ring
+/// into the core oldest timestamp first, and keeps draining until no push
+/// arrived meanwhile. Other pushes return as soon as their message is
+/// queued, so subscriptions on different streams never wait on each other.
+/// When a worker thread is running, pushes wake the worker instead and it
+/// does all the matching.
+class Synchronizer::Impl : public MatchingCore::Host {
 public:
-    Impl(const Config& config) : config_(config), finalized_(false), handle_{nullptr} {}
+    Impl(const Config& config)
+        : config_(config), expiry_timer_([this]() { process_expired(); }) {}
 
     ~Impl() {
-        if (handle_.ptr) {
-            ffi::destroy_synchronizer(handle_);
-        }
+        stop();
+        expiry_timer_.cancel();
+        core_.reset();
+    }
+
+    std::shared_ptr<detail::MessageAllocator<void>> message_allocator(size_t message_size) const {
+        return detail::make_message_allocator(config_, message_size);
     }
 
-    void add_topic(const std::string& topic) {
+    size_t add_topic(const std::string& topic) {
         if (finalized_) {
             throw std::runtime_error("Cannot add topics after on_synchronized() is called");
         }
         topics_.push_back(topic);
+        return topics_.size() - 1;
     }
 
-    void finalize() {
+    void set_optional(size_t stream_index, std::chrono::nanoseconds deadline) {
         if (finalized_) {
-            return;
+            throw std::runtime_error("Cannot change streams after on_synchronized() is called");
         }
+        if (stream_index >= topics_.size()) {
+            throw std::out_of_range("Stream index out of range");
+        }
+        optional_.emplace_back(stream_index, deadline);
+    }
 
-        handle_ =
-            ffi::create_synchronizer(config_.window_size.count(), config_.buffer_size, topics_);
+    void finalize() {
+        std::call_once(finalize_once_, [this]() { do_finalize(); });
+    }
 
-        if (!handle_.ptr) {
-            throw std::runtime_error("Failed to create synchronizer");
+    void preallocate() {
+        if (config_.staleness != StalenessPreset::Disabled) {
+            // Expiry re-arms an rclcpp timer, which allocates
+            throw std::runtime_error("preallocate() requires staleness to be disabled");
         }
-
-        finalized_ = true;
+        finalize();
+        preallocated_.store(true, std::memory_order_relaxed);
     }
 
-    void set_callback(SyncCallback callback) { callback_ = std::move(callback); }
+    void set_node(const rclcpp::Node::SharedPtr& node) { expiry_timer_.set_node(node); }
 
-    void push_message(const std::string& topic, int64_t timestamp_ns, std::any message) {
-        if (!finalized_) {
+    void set_callback(SyncCallback callback) {
+        std::lock_guard<std::recursive_mutex> lock(core_mutex_);
+        callback_ = std::move(callback);
+    }
+
+    void push_message(size_t stream_index, int64_t timestamp_ns, std::any message) {
+        if (!finalized_.load(std::memory_order_acquire)) {
             // Lazily finalize on first message
             finalize();
         }
 
-        // Store the message
-        size_t msg_id;
+        if (stream_index >= core_->stream_count()) {
+            return;
+        }
+        detail::NoAllocScope no_alloc(preallocated_.load(std::memory_order_relaxed));
+
+        if (!core_->push(stream_index, timestamp_ns, std::move(message))) {
+            return;
+        }
+
+        // Become the matcher unless another thread already is
+        notify_matcher();
+    }
+
+    bool push_blocking(size_t stream_index, int64_t timestamp_ns, std::any message,
+                       std::chrono::nanoseconds timeout) {
+        if (!finalized_.load(std::memory_order_acquire)) {
+            finalize();
+        }
+
+        if (stream_index >= core_->stream_count()) {
+            return false;
+        }
+        detail::NoAllocScope no_alloc(preallocated_.load(std::memory_order_relaxed));
+
+        MatchingCore::Payload payload{std::move(message), Clock::now()};
+        Clock::time_point deadline = deadline_after(timeout);
+        SpaceWaiter waiter(space_waiters_);
+
+        while (true) {
+            uint64_t epoch = 0;
+            {
+                std::lock_guard<std::recursive_mutex> lock(core_mutex_);
+                epoch = space_epoch_.load();
+
+                // Without a worker nobody else may be around to free space,
+                // so deliver ready groups on this thread
+                bool dispatch = !worker_running_.load();
+
+                // Messages already queued for the stream go into the core first
+                core_->drain(dispatch);
+
+                auto result = core_->push_direct(stream_index, timestamp_ns, payload, dispatch);
+                if (result == ffi::PushResult::Ok) {
+                    break;
+                }
+                if (result != ffi::PushResult::BufferFull) {
+                    core_->stats().record_rejected(stream_index, result);
+                    return false;
+                }
+            }
+
+            // Wait for the core to emit or evict a message
+            std::unique_lock<std::mutex> lock(space_mutex_);
+            auto freed = [this, epoch]() { return space_epoch_.load() != epoch; };
+            if (deadline == Clock::time_point::max()) {
+                space_cv_.wait(lock, freed);
+            } else if (!space_cv_.wait_until(lock, deadline, freed)) {
+                core_->stats().record_rejected(stream_index, ffi::PushResult::BufferFull);
+                return false;
+            }
+        }
+
+        // Match the message like any other push
+        notify_matcher();
+        return true;
+    }
+
+    void start(const WorkerOptions& options) {
+        if (worker_.joinable()) {
+            throw std::runtime_error("Synchronizer is already running");
+        }
+        if (options.callback_threads > 0) {
+            if (options.output_capacity > 0) {
+                throw std::runtime_error(
+                    "callback_threads cannot be combined with output_capacity");
+            }
+            if (!callback_) {
+                throw std::runtime_error("callback_threads requires a callback");
+            }
+        }
+        finalize();
+
         {
-            std::lock_guard<std::mutex> lock(mutex_);
-            msg_id = next_msg_id_++;
-            pending_messages_[msg_id] =
-                PendingMessage{topic, std::chrono::nanoseconds(timestamp_ns), std::move(message)};
+            std::lock_guard<std::recursive_mutex> lock(core_mutex_);
+
+            // Groups left over from the previous run were never popped
+            if (output_) {
+                for (size_t i = output_->size(); i > 0; --i) {
+                    core_->stats().record_group_dropped();
+                }
+                output_.reset();
+            }
+            if (options.output_capacity > 0) {
+                output_ = std::make_unique<OutputQueue>(options.output_capacity,
+                                                        options.output_policy, topics_.size());
+                output_open_ = true;
+            }
+            if (options.callback_threads > 0) {
+                dispatch_ = std::make_unique<DispatchPool>(
+                    options.callback_threads, options.dispatch_order, callback_, topics_.size());
+            }
         }
 
-        // Push to the Rust synchronizer with the message ID as user_data
-        auto result =
-            ffi::push_message(handle_, topic, timestamp_ns, reinterpret_cast<void*>(msg_id));
+        stop_requested_ = false;
+        worker_running_.store(true);
+        worker_ = std::thread([this]() { run_worker(); });
+    }
 
-        if (result != ffi::PushResult::Ok) {
-            // Remove the pending message on failure
-            std::lock_guard<std::mutex> lock(mutex_);
-            pending_messages_.erase(msg_id);
+    void stop() {
+        if (!worker_.joinable()) {
+            return;
+        }
+
+        // Pushes from now on match on their own thread again
+        worker_running_.store(false);
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            stop_requested_ = true;
+        }
+        wake_cv_.notify_one();
+        if (output_) {
+            output_->interrupt();
+        }
+        if (dispatch_) {
+            dispatch_->interrupt();
         }
+        worker_.join();
+
+        // Match what was pushed while the worker was shutting down, still
+        // into the output queue or the callback threads
+        if (pending_.load() != 0) {
+            run_matcher(output_open_ || dispatch_ || config_.eager_dispatch);
+        }
+
+        // Later groups go to the callback, if any, or stay in the core for
+        // the next start(); the queue keeps what it holds for pop_group()
+        if (output_) {
+            std::lock_guard<std::recursive_mutex> lock(core_mutex_);
+            output_open_ = false;
+            output_->close();
+        }
+
+        // Let the callback threads finish outside the core lock, as their
+        // callbacks may push and match on their own thread
+        std::unique_ptr<DispatchPool> dispatch;
+        {
+            std::lock_guard<std::recursive_mutex> lock(core_mutex_);
+            dispatch = std::move(dispatch_);
+        }
+        dispatch.reset();
+
+        // Blocked pushes now have to free space on their own thread
+        signal_space();
+    }
+
+    bool running() const { return worker_running_.load(); }
+
+    bool pop_group(SyncGroup& group, std::chrono::nanoseconds timeout) {
+        return output_ && output_->pop(group, timeout);
     }
 
     void spin_once() {
-        if (!finalized_ || !callback_) {
+        if (!finalized_.load(std::memory_order_acquire)) {
             return;
         }
+        detail::NoAllocScope no_alloc(preallocated_.load(std::memory_order_relaxed));
 
-        // Keep polling until no more groups
-        while (true) {
-            SyncGroup group;
-            bool found = false;
+        std::lock_guard<std::recursive_mutex> lock(core_mutex_);
+        core_->drain(true);
+        dispatch_all();
+    }
 
-            // Collect messages from the callback
-            auto callback = [](const char* key, int64_t timestamp_ns, void* user_data,
-                               void* context) {
-                auto* impl = static_cast<Impl*>(context);
-                size_t msg_id = reinterpret_cast<size_t>(user_data);
+    size_t spin_some(size_t max_groups) {
+        if (!finalized_.load(std::memory_order_acquire)) {
+            return 0;
+        }
+        detail::NoAllocScope no_alloc(preallocated_.load(std::memory_order_relaxed));
+
+        std::lock_guard<std::recursive_mutex> lock(core_mutex_);
+        core_->drain(false);
+        max_groups = std::min(max_groups, free_space());
+        if ((!callback_ && !output_open_) || dispatching_ || max_groups == 0) {
+            return 0;
+        }
 
-                std::lock_guard<std::mutex> lock(impl->mutex_);
-                auto it = impl->pending_messages_.find(msg_id);
-                if (it != impl->pending_messages_.end()) {
-                    impl->current_group_->timestamp_ = std::chrono::nanoseconds(timestamp_ns);
-                    impl->current_group_->messages_[key] = std::move(it->second.message);
-                    impl->pending_messages_.erase(it);
+        DispatchGuard guard(dispatching_);
+
+        // Poll in batches, so the poll buffer sized at finalization suffices
+        size_t delivered = 0;
+        while (delivered < max_groups) {
+            size_t batch = std::min(MatchingCore::kBatchSize, max_groups - delivered);
+            size_t count = core_->dispatch_batch(batch);
+            delivered += count;
+            if (count < batch) {
+                break;
+            }
+        }
+        return delivered;
+    }
+
+    size_t topic_count() const { return topics_.size(); }
+
+    SyncStats stats() const {
+        if (!finalized_.load(std::memory_order_acquire)) {
+            // Not finalized yet: report the topics with zero counts
+            SyncStats stats;
+            stats.streams.resize(topics_.size());
+            for (size_t i = 0; i < topics_.size(); ++i) {
+                stats.streams[i].topic = topics_[i];
+            }
+            return stats;
+        }
+        return core_->stats().snapshot(topics_);
+    }
+
+    /// A buffered serialized message with its timestamp.
+    using Buffered = std::pair<int64_t, std::shared_ptr<const rclcpp::SerializedMessage>>;
+
+    std::vector<uint8_t> snapshot() {
+        if (!finalized_.load(std::memory_order_acquire)) {
+            throw std::runtime_error("Cannot snapshot before on_synchronized() is called");
+        }
+
+        std::lock_guard<std::recursive_mutex> lock(core_mutex_);
+        core_->drain(false);
+
+        std::vector<StreamFeedback> feedback(topics_.size());
+        ffi::get_feedback(core_->handle(), feedback);
+
+        detail::SnapshotWriter writer;
+        writer.write_u32(detail::kSnapshotVersion);
+        writer.write_i64(ffi::commit_timestamp_ns(core_->handle()));
+        writer.write_u32(static_cast<uint32_t>(topics_.size()));
+        for (size_t i = 0; i < topics_.size(); ++i) {
+            writer.write_string(topics_[i]);
+            writer.write_i64(feedback[i].needed_after.count());
+
+            // Only serialized messages can be written out as they are
+            std::vector<Buffered> messages;
+            for (const auto& member : ffi::peek_buffer(core_->handle(), i, config_.buffer_size)) {
+                MatchingCore::Payload* payload =
+                    core_->pool(i).get(SlotHandle::from_user_data(member.user_data));
+                if (!payload) {
+                    continue;
+                }
+                if (auto* serialized =
+                        std::any_cast<std::shared_ptr<const rclcpp::SerializedMessage>>(
+                            &payload->message)) {
+                    messages.emplace_back(member.timestamp_ns, *serialized);
+                }
+            }
+            writer.write_u32(static_cast<uint32_t>(messages.size()));
+            for (const auto& [timestamp_ns, message] : messages) {
+                const auto& raw = message->get_rcl_serialized_message();
+                writer.write_i64(timestamp_ns);
+                writer.write_bytes(raw.buffer, raw.buffer_length);
+            }
+        }
+        return writer.take();
+    }
+
+    void restore(const uint8_t* data, size_t size) {
+        if (!finalized_.load(std::memory_order_acquire)) {
+            throw std::runtime_error("Cannot restore before on_synchronized() is called");
+        }
+
+        // Parse everything before touching the core
+        detail::SnapshotReader reader(data, size);
+        if (reader.read_u32() != detail::kSnapshotVersion) {
+            throw std::runtime_error("Unsupported synchronizer snapshot version");
+        }
+        int64_t commit_ns = reader.read_i64();
+        if (reader.read_u32() != topics_.size()) {
+            throw std::runtime_error("Snapshot topics do not match the synchronizer");
+        }
+        std::vector<int64_t> last_ns(topics_.size());
+        std::vector<std::vector<Buffered>> messages(topics_.size());
+        for (size_t i = 0; i < topics_.size(); ++i) {
+            if (reader.read_string() != topics_[i]) {
+                throw std::runtime_error("Snapshot topics do not match the synchronizer");
+            }
+            last_ns[i] = reader.read_i64();
+            uint32_t count = reader.read_u32();
+            for (uint32_t m = 0; m < count; ++m) {
+                int64_t timestamp_ns = reader.read_i64();
+                size_t length = 0;
+                const uint8_t* bytes = reader.read_bytes(length);
+
+                auto message = std::make_shared<rclcpp::SerializedMessage>(length);
+                auto& raw = message->get_rcl_serialized_message();
+                std::memcpy(raw.buffer, bytes, length);
+                raw.buffer_length = length;
+                messages[i].emplace_back(timestamp_ns, std::move(message));
+            }
+        }
+        if (!reader.at_end()) {
+            throw std::runtime_error("Trailing bytes after synchronizer snapshot");
+        }
+
+        std::lock_guard<std::recursive_mutex> lock(core_mutex_);
+        core_->drain(false);
+        std::vector<StreamFeedback> feedback(topics_.size());
+        ffi::get_feedback(core_->handle(), feedback);
+        for (const StreamFeedback& stream : feedback) {
+            if (stream.needed_after.count() >= 0) {
+                throw std::runtime_error("Cannot restore after messages were pushed");
+            }
+        }
+
+        // Buffer the messages first, while any timestamp is still accepted
+        for (size_t i = 0; i < topics_.size(); ++i) {
+            for (auto& [timestamp_ns, message] : messages[i]) {
+                MatchingCore::Payload payload{std::move(message), Clock::now()};
+                auto result = core_->push_direct(i, timestamp_ns, payload, false);
+                if (result != ffi::PushResult::Ok) {
+                    core_->stats().record_rejected(i, result);
+                }
+            }
+        }
+        ffi::restore_watermarks(core_->handle(), commit_ns, last_ns);
+        schedule_expiry();
+    }
+
+    std::vector<StreamFeedback> feedback() const {
+        std::vector<StreamFeedback> feedback(topics_.size());
+        for (size_t i = 0; i < topics_.size(); ++i) {
+            feedback[i].topic = topics_[i];
+        }
+        if (finalized_.load(std::memory_order_acquire)) {
+            std::lock_guard<std::recursive_mutex> lock(core_mutex_);
+            ffi::get_feedback(core_->handle(), feedback);
+        }
+        return feedback;
+    }
+
+    bool is_ready() const {
+        if (!finalized_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        std::lock_guard<std::recursive_mutex> lock(core_mutex_);
+        return ffi::is_ready(core_->handle());
+    }
+
+private:
+    using Clock = MatchingCore::Clock;
+
+    /// Counts a blocked push for the guard's lifetime, so space is only
+    /// signalled while someone waits for it.
+    struct SpaceWaiter {
+        explicit SpaceWaiter(std::atomic<size_t>& count) : count(count) { ++count; }
+        ~SpaceWaiter() { --count; }
+        std::atomic<size_t>& count;
+    };
+
+    /// Marks the synchronizer as dispatching for the guard's lifetime.
+    struct DispatchGuard {
+        explicit DispatchGuard(bool& flag) : flag(flag) { flag = true; }
+        ~DispatchGuard() { flag = false; }
+        bool& flag;
+    };
+
+    /// Bounded queue of groups between the worker and the consumer.
+    ///
+    /// Slots keep their member storage, and groups are moved in and out
+    /// member by member, so steady-state delivery allocates nothing.
+    class OutputQueue {
+    public:
+        /// @param members Number of streams, to size the slots up front
+        OutputQueue(size_t capacity, OutputPolicy policy, size_t members)
+            : slots_(capacity), policy_(policy) {
+            for (SyncGroup& slot : slots_) {
+                slot.members_.resize(members);
+            }
+        }
+
+        /// Queue a group, leaving it empty. Returns true if a group was
+        /// discarded: an older one to make room, or this one once closed.
+        bool push(SyncGroup& group) {
+            bool dropped = false;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                if (closed_) {
+                    group.clear();
+                    return true;
                 }
-            };
+                if (size_ == slots_.size()) {
+                    // Only reached with DropOldest; Block polls no more than
+                    // free_space() groups
+                    slots_[head_].clear();
+                    head_ = (head_ + 1) % slots_.size();
+                    --size_;
+                    dropped = true;
+                }
+                slots_[(head_ + size_) % slots_.size()].take(group);
+                ++size_;
+            }
+            not_empty_.notify_one();
+            return dropped;
+        }
+
+        /// Move the oldest group into `group`, waiting up to `timeout`.
+        /// Returns false if the queue stayed empty or was closed.
+        bool pop(SyncGroup& group, std::chrono::nanoseconds timeout) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                if (!not_empty_.wait_for(lock, timeout,
+                                         [this]() { return size_ > 0 || closed_; }) ||
+                    size_ == 0) {
+                    return false;
+                }
+                group.take(slots_[head_]);
+                head_ = (head_ + 1) % slots_.size();
+                --size_;
+            }
+            not_full_.notify_one();
+            return true;
+        }
+
+        /// Number of groups that can be queued without discarding any:
+        /// unlimited with DropOldest.
+        size_t free_space() {
+            if (policy_ == OutputPolicy::DropOldest) {
+                return std::numeric_limits<size_t>::max();
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            return slots_.size() - size_;
+        }
+
+        /// Number of groups queued.
+        size_t size() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return size_;
+        }
+
+        /// Wait until a group can be queued. Returns false once interrupted.
+        bool wait_for_space() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_full_.wait(lock, [this]() { return size_ < slots_.size() || interrupted_; });
+            return !interrupted_;
+        }
+
+        /// Wake the worker waiting for space when it stops. Groups are
+        /// still queued afterwards.
+        void interrupt() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                interrupted_ = true;
+            }
+            not_full_.notify_all();
+        }
 
+        /// Wake all waiters and reject further groups.
+        void close() {
             {
                 std::lock_guard<std::mutex> lock(mutex_);
-                current_group_ = &group;
+                interrupted_ = true;
+                closed_ = true;
             }
+            not_empty_.notify_all();
+            not_full_.notify_all();
+        }
 
-            found = ffi::poll(handle_, callback, this);
+    private:
+        std::mutex mutex_;
+        std::condition_variable not_empty_;
+        std::condition_variable not_full_;
+        std::vector<SyncGroup> slots_;
+        OutputPolicy policy_;
+        size_t head_ = 0;
+        size_t size_ = 0;
+        bool interrupted_ = false;
+        bool closed_ = false;
+    };
 
+    /// Pool of threads running the user callback.
+    ///
+    /// Every thread has a ring of its own, and groups are dealt to the rings
+    /// in turn; a thread whose ring is empty steals the oldest group of the
+    /// next non-empty one. Slots keep their member storage as in the output
+    /// queue, so steady-state dispatch allocates nothing.
+    class DispatchPool {
+    public:
+        /// @param members Number of streams, to size the slots up front
+        DispatchPool(size_t threads, DispatchOrder order, SyncCallback callback, size_t members)
+            : order_(order), callback_(std::move(callback)), members_(members) {
+            size_t depth = order == DispatchOrder::LatestOnly ? 1 : kInOrderDepth;
+            queues_.reserve(threads);
+            for (size_t i = 0; i < threads; ++i) {
+                queues_.push_back(std::make_unique<Queue>(depth, members));
+            }
+            threads_.reserve(threads);
+            for (size_t i = 0; i < threads; ++i) {
+                threads_.emplace_back([this, i]() { run(i); });
+            }
+        }
+
+        /// Run the groups already handed out, then join the threads.
+        ~DispatchPool() {
             {
                 std::lock_guard<std::mutex> lock(mutex_);
-                current_group_ = nullptr;
+                closed_ = true;
+            }
+            work_cv_.notify_all();
+            space_cv_.notify_all();
+            for (std::thread& thread : threads_) {
+                thread.join();
             }
+        }
 
-            if (!found) {
-                break;
+        /// Hand a group to the next thread, leaving it empty. Returns true
+        /// if a waiting group was discarded to make room.
+        bool push(SyncGroup& group) {
+            bool dropped = false;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+
+                // Deal round robin, skipping full rings; only LatestOnly
+                // reaches a full pool, as InOrder pushes no more than
+                // free_space() groups
+                size_t target = next_;
+                for (size_t k = 0; k < queues_.size(); ++k) {
+                    size_t i = (next_ + k) % queues_.size();
+                    if (!queues_[i]->full()) {
+                        target = i;
+                        break;
+                    }
+                }
+                next_ = (target + 1) % queues_.size();
+
+                Queue& queue = *queues_[target];
+                if (queue.full()) {
+                    queue.drop_oldest();
+                    --waiting_;
+                    dropped = true;
+                }
+                queue.push(group);
+                ++waiting_;
             }
+            work_cv_.notify_one();
+            return dropped;
+        }
 
-            // Invoke the user callback
-            callback_(group);
+        /// Number of groups that can be handed out without discarding any:
+        /// unlimited with LatestOnly.
+        size_t free_space() {
+            if (order_ == DispatchOrder::LatestOnly) {
+                return std::numeric_limits<size_t>::max();
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            return queues_.size() * kInOrderDepth - waiting_;
         }
+
+        /// Wait until a group can be handed out. Returns false once closed.
+        bool wait_for_space() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            space_cv_.wait(lock, [this]() {
+                return waiting_ < queues_.size() * kInOrderDepth || interrupted_;
+            });
+            return !interrupted_;
+        }
+
+        /// Wake the worker waiting for space when it stops. The threads keep
+        /// running groups handed out afterwards.
+        void interrupt() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                interrupted_ = true;
+            }
+            space_cv_.notify_all();
+        }
+
+    private:
+        /// Groups queued per thread under InOrder before matching pauses.
+        static constexpr size_t kInOrderDepth = 2;
+
+        /// Fixed ring of groups waiting for one thread.
+        class Queue {
+        public:
+            Queue(size_t capacity, size_t members) : slots_(capacity) {
+                for (SyncGroup& slot : slots_) {
+                    slot.members_.resize(members);
+                }
+            }
+
+            bool full() const { return size_ == slots_.size(); }
+            bool empty() const { return size_ == 0; }
+
+            void push(SyncGroup& group) {
+                slots_[(head_ + size_) % slots_.size()].take(group);
+                ++size_;
+            }
+
+            void pop(SyncGroup& group) {
+                group.take(slots_[head_]);
+                head_ = (head_ + 1) % slots_.size();
+                --size_;
+            }
+
+            void drop_oldest() {
+                slots_[head_].clear();
+                head_ = (head_ + 1) % slots_.size();
+                --size_;
+            }
+
+        private:
+            std::vector<SyncGroup> slots_;
+            size_t head_ = 0;
+            size_t size_ = 0;
+        };
+
+        /// Callback thread: run groups from its own ring, or stolen ones,
+        /// until the pool is destroyed and nothing is left.
+        void run(size_t self) {
+            SyncGroup group;
+            group.members_.resize(members_);
+            while (true) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    work_cv_.wait(lock, [this]() { return waiting_ > 0 || closed_; });
+                    if (waiting_ == 0) {
+                        return;
+                    }
+
+                    for (size_t k = 0; k < queues_.size(); ++k) {
+                        Queue& queue = *queues_[(self + k) % queues_.size()];
+                        if (!queue.empty()) {
+                            queue.pop(group);
+                            break;
+                        }
+                    }
+                    --waiting_;
+                }
+                space_cv_.notify_one();
+
+                callback_(group);
+                group.clear();
+            }
+        }
+
+        DispatchOrder order_;
+        SyncCallback callback_;
+        size_t members_;
+        std::mutex mutex_;
+        std::condition_variable work_cv_;
+        std::condition_variable space_cv_;
+        std::vector<std::unique_ptr<Queue>> queues_;
+        std::vector<std::thread> threads_;
+        size_t next_ = 0;
+        size_t waiting_ = 0;
+        bool interrupted_ = false;
+        bool closed_ = false;
+    };
+
+    void do_finalize() {
+        core_ = std::make_unique<MatchingCore>(config_, topics_, *this);
+        for (const auto& [stream_index, deadline] : optional_) {
+            if (!ffi::set_optional(core_->handle(), stream_index, deadline)) {
+                throw std::runtime_error("Too many optional streams, or the pivot is optional");
+            }
+        }
+
+        finalized_.store(true, std::memory_order_release);
     }
 
-    size_t topic_count() const { return topics_.size(); }
+    /// Count a push and make sure someone matches it: the caller itself,
+    /// or the worker if one is running.
+    void notify_matcher() {
+        if (pending_.fetch_add(1) != 0) {
+            // A matcher is active and will see the new count
+            return;
+        }
+        if (!worker_running_.load()) {
+            run_matcher(config_.eager_dispatch);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+        }
+        wake_cv_.notify_one();
+    }
 
-    bool is_ready() const {
-        if (!finalized_) {
+    /// Drain the rings into the core until no push is left unaccounted
+    /// for, dispatching ready groups if requested. Returns true if groups
+    /// were left undelivered because the output queue is full.
+    bool run_matcher(bool dispatch) {
+        detail::NoAllocScope no_alloc(preallocated_.load(std::memory_order_relaxed));
+        uint64_t claimed = pending_.load(std::memory_order_acquire);
+        bool backlog = false;
+        try {
+            do {
+                std::lock_guard<std::recursive_mutex> lock(core_mutex_);
+                core_->drain(dispatch);
+
+                // The newly pushed messages may have completed a group
+                if (dispatch) {
+                    backlog = dispatch_all();
+                }
+
+                schedule_expiry();
+
+                // Pushes that arrived meanwhile bumped the count, so the
+                // exchange fails and their messages are drained next round
+            } while (!pending_.compare_exchange_strong(claimed, 0, std::memory_order_acq_rel,
+                                                       std::memory_order_acquire));
+        } catch (...) {
+            // Let the next push take over as matcher
+            pending_.store(0, std::memory_order_release);
+            throw;
+        }
+        return backlog;
+    }
+
+    /// Worker thread: wait for pushes, then match and deliver.
+    void run_worker() {
+        bool backlog = false;
+        while (true) {
+            if (backlog) {
+                // Resume once the consumer makes room
+                if (!(output_ ? output_->wait_for_space() : dispatch_->wait_for_space())) {
+                    return;
+                }
+            } else {
+                std::unique_lock<std::mutex> lock(wake_mutex_);
+                wake_cv_.wait(lock, [this]() { return stop_requested_ || pending_.load() != 0; });
+                if (stop_requested_) {
+                    return;
+                }
+            }
+
+            if (pending_.load() == 0) {
+                // Woken for space only: claim a round of our own
+                pending_.fetch_add(1);
+            }
+            backlog = run_matcher(true);
+        }
+    }
+
+    /// Wake blocked pushes after the core freed buffer space.
+    void signal_space() {
+        if (space_waiters_.load() == 0) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(space_mutex_);
+            ++space_epoch_;
+        }
+        space_cv_.notify_all();
+    }
+
+    /// Get the time a wait of `timeout` from now ends, saturating so that
+    /// nanoseconds::max() waits forever.
+    static Clock::time_point deadline_after(std::chrono::nanoseconds timeout) {
+        Clock::time_point now = Clock::now();
+        auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::time_point::max() - now);
+        if (timeout >= remaining) {
+            return Clock::time_point::max();
+        }
+        return now + std::chrono::duration_cast<Clock::duration>(timeout);
+    }
+
+    /// Deliver ready groups to make room in the core. Returns true if any
+    /// group was delivered.
+    bool dispatch_all_ready() {
+        uint64_t before = delivered_;
+        dispatch_all();
+        return delivered_ != before;
+    }
+
+    /// Number of groups the output queue or callback threads can take.
+    size_t free_space() {
+        if (output_open_) {
+            return output_->free_space();
+        }
+        if (dispatch_) {
+            return dispatch_->free_space();
+        }
+        return std::numeric_limits<size_t>::max();
+    }
+
+    /// Deliver every ready group. Requires the core lock. Returns true if
+    /// groups may be left because the output queue or the callback threads
+    /// are full (Block, InOrder).
+    bool dispatch_all() {
+        if ((!callback_ && !output_open_) || dispatching_) {
             return false;
         }
-        return ffi::is_ready(handle_);
+
+        // Messages pushed from inside the user callback are matched by the
+        // enclosing loop instead of recursing into it
+        DispatchGuard guard(dispatching_);
+
+        // Keep polling until no more groups
+        while (true) {
+            size_t max_groups = std::min(MatchingCore::kBatchSize, free_space());
+            if (max_groups == 0) {
+                return true;
+            }
+            if (core_->dispatch_batch(max_groups) < max_groups) {
+                return false;
+            }
+        }
     }
 
-private:
-    struct PendingMessage {
-        std::string topic;
-        std::chrono::nanoseconds timestamp;
-        std::any message;
-    };
+    /// Arm the expiry timer to the next staleness deadline, if any.
+    void schedule_expiry() {
+        if (config_.staleness == StalenessPreset::Disabled) {
+            return;
+        }
+        int64_t delay_ns = ffi::next_expiration_ns(core_->handle());
+        if (delay_ns >= 0) {
+            expiry_timer_.arm(std::chrono::nanoseconds(delay_ns));
+        }
+    }
+
+    /// Remove stale messages, then re-arm for the next deadline.
+    void process_expired() {
+        std::lock_guard<std::recursive_mutex> lock(core_mutex_);
+        core_->drain(false);
+        if (ffi::process_expired(core_->handle()) > 0) {
+            // Dropping a stale message may unblock a group
+            if (worker_running_.load()) {
+                notify_matcher();
+            } else if (config_.eager_dispatch) {
+                dispatch_all();
+            }
+        }
+        schedule_expiry();
+    }
+
+    /// Hand a filled group to the output queue, the callback threads or
+    /// the user callback.
+    void deliver(SyncGroup& group) override {
+        ++delivered_;
+        if (output_open_) {
+            if (output_->push(group)) {
+                core_->stats().record_group_dropped();
+            }
+            return;
+        }
+        if (dispatch_) {
+            if (dispatch_->push(group)) {
+                core_->stats().record_group_dropped();
+            }
+            return;
+        }
+
+        // The callback is the user's own and may allocate
+        detail::AllowAllocScope allow_alloc;
+        callback_(group);
+    }
+
+    bool relieve() override { return dispatch_all_ready(); }
+
+    void space_freed() override { signal_space(); }
 
     Config config_;
     std::vector<std::string> topics_;
-    bool finalized_;
-    ffi::SynchronizerHandle handle_;
+    std::vector<std::pair<size_t, std::chrono::nanoseconds>> optional_;
+    std::once_flag finalize_once_;
+    std::atomic<bool> finalized_{false};
+    std::atomic<bool> preallocated_{false};
     SyncCallback callback_;
+    bool dispatching_ = false;
+    uint64_t delivered_ = 0;
+
+    std::unique_ptr<MatchingCore> core_;
+    std::atomic<uint64_t> pending_{0};
+    mutable std::recursive_mutex core_mutex_;
 
-    std::mutex mutex_;
-    size_t next_msg_id_ = 0;
-    std::unordered_map<size_t, PendingMessage> pending_messages_;
-    SyncGroup* current_group_ = nullptr;
+    std::unique_ptr<OutputQueue> output_;
+    bool output_open_ = false;
+    std::unique_ptr<DispatchPool> dispatch_;
+    std::thread worker_;
+    std::atomic<bool> worker_running_{false};
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    bool stop_requested_ = false;
+
+    std::atomic<size_t> space_waiters_{0};
+    std::atomic<uint64_t> space_epoch_{0};
+    std::mutex space_mutex_;
+    std::condition_variable space_cv_;
+
+    detail::DeadlineTimer expiry_timer_;
 };
 
 // Synchronizer implementation
@@ -157,8 +994,45 @@ Synchronizer::~Synchronizer() = default;
 Synchronizer::Synchronizer(Synchronizer&&) noexcept = default;
 Synchronizer& Synchronizer::operator=(Synchronizer&&) noexcept = default;
 
-void Synchronizer::add_topic(const std::string& topic) {
-    impl_->add_topic(topic);
+size_t Synchronizer::add_topic(const std::string& topic) {
+    return impl_->add_topic(topic);
+}
+
+void Synchronizer::set_optional(size_t stream_index, std::chrono::nanoseconds deadline) {
+    impl_->set_optional(stream_index, deadline);
+}
+
+size_t Synchronizer::add_serialized_subscription(rclcpp::Node::SharedPtr node,
+                                                 const std::string& topic,
+                                                 const std::string& type_name,
+                                                 const rclcpp::QoS& qos) {
+    size_t stream_index = add_topic(topic);
+    set_node(node);
+
+    auto callback = [this, stream_index](std::shared_ptr<rclcpp::SerializedMessage> msg) {
+        const auto& raw = msg->get_rcl_serialized_message();
+        auto timestamp_ns = cdr::header_stamp_ns(raw.buffer, raw.buffer_length);
+        if (!timestamp_ns) {
+            // Not CDR, or too short to hold a header
+            return;
+        }
+
+        push_message(stream_index, *timestamp_ns,
+                     std::any(std::shared_ptr<const rclcpp::SerializedMessage>(std::move(msg))));
+    };
+
+    auto sub = node->create_generic_subscription(topic, type_name, qos, callback);
+    subscriptions_.push_back(sub);
+    return stream_index;
+}
+
+void Synchronizer::set_node(const rclcpp::Node::SharedPtr& node) {
+    impl_->set_node(node);
+}
+
+std::shared_ptr<detail::MessageAllocator<void>> Synchronizer::message_allocator(
+    size_t message_size) const {
+    return impl_->message_allocator(message_size);
 }
 
 void Synchronizer::finalize() {
@@ -170,18 +1044,67 @@ void Synchronizer::on_synchronized(SyncCallback callback) {
     impl_->set_callback(std::move(callback));
 }
 
-void Synchronizer::push_message(const std::string& topic, int64_t timestamp_ns, std::any message) {
-    impl_->push_message(topic, timestamp_ns, std::move(message));
+void Synchronizer::push_message(size_t stream_index, int64_t timestamp_ns, std::any message) {
+    impl_->push_message(stream_index, timestamp_ns, std::move(message));
+}
+
+bool Synchronizer::push_blocking(size_t stream_index, int64_t timestamp_ns, std::any message,
+                                 std::chrono::nanoseconds timeout) {
+    return impl_->push_blocking(stream_index, timestamp_ns, std::move(message), timeout);
 }
 
 void Synchronizer::spin_once() {
     impl_->spin_once();
 }
 
+void Synchronizer::preallocate() {
+    impl_->preallocate();
+}
+
+size_t Synchronizer::spin_some(size_t max_groups) {
+    return impl_->spin_some(max_groups);
+}
+
+void Synchronizer::start(const WorkerOptions& options) {
+    impl_->start(options);
+}
+
+void Synchronizer::stop() {
+    impl_->stop();
+}
+
+bool Synchronizer::running() const {
+    return impl_->running();
+}
+
+bool Synchronizer::pop_group(SyncGroup& group, std::chrono::nanoseconds timeout) {
+    return impl_->pop_group(group, timeout);
+}
+
 size_t Synchronizer::topic_count() const {
     return impl_->topic_count();
 }
 
+SyncStats Synchronizer::stats() const {
+    return impl_->stats();
+}
+
+std::vector<uint8_t> Synchronizer::snapshot() const {
+    return impl_->snapshot();
+}
+
+void Synchronizer::restore(const uint8_t* data, size_t size) {
+    impl_->restore(data, size);
+}
+
+void Synchronizer::restore(const std::vector<uint8_t>& snapshot) {
+    impl_->restore(snapshot.data(), snapshot.size());
+}
+
+std::vector<StreamFeedback> Synchronizer::feedback() const {
+    return impl_->feedback();
+}
+
 bool Synchronizer::is_ready() const {
     return impl_->is_ready();
 }
@@ -0,0 +1,111 @@
+/*
+ * Conflux C++ Library - Bag Synchronizer Tests
+ *
+ * Plays bags written with rosbag2_cpp into the default storage plugin.
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#include "conflux/bag_synchronizer.hpp"
+
+#include "rclcpp/time.hpp"
+#include "rosbag2_cpp/writer.hpp"
+#include "std_msgs/msg/header.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+constexpr int64_t kStartNs = 1000000000;
+constexpr int64_t kFastPeriodNs = 10000000;
+constexpr int kFastPerSlow = 100;
+constexpr int kFastCount = 3 * kFastPerSlow;
+constexpr int kSlowCount = kFastCount / kFastPerSlow;
+
+/// A bag with a 100 Hz and a 1 Hz topic, removed again on destruction.
+class MismatchedRatesBag {
+public:
+    explicit MismatchedRatesBag(const std::string& name)
+        : uri_(std::filesystem::temp_directory_path() /
+               ("conflux_" + name + "_" + std::to_string(::getpid()))) {
+        std::filesystem::remove_all(uri_);
+
+        rosbag2_cpp::Writer writer;
+        writer.open(uri_.string());
+        for (int i = 0; i < kFastCount; ++i) {
+            int64_t stamp_ns = kStartNs + i * kFastPeriodNs;
+            write(writer, "/fast", stamp_ns);
+            if (i % kFastPerSlow == 0) {
+                write(writer, "/slow", stamp_ns + 1000);
+            }
+        }
+    }
+
+    ~MismatchedRatesBag() { std::filesystem::remove_all(uri_); }
+
+    std::string uri() const { return uri_.string(); }
+
+private:
+    static void write(rosbag2_cpp::Writer& writer, const std::string& topic, int64_t stamp_ns) {
+        std_msgs::msg::Header header;
+        header.stamp = rclcpp::Time(stamp_ns);
+        writer.write(header, topic, rclcpp::Time(stamp_ns));
+    }
+
+    std::filesystem::path uri_;
+};
+
+/// Play the bag with a buffer much shorter than the slow topic's period.
+conflux::SyncStats play(const MismatchedRatesBag& bag, conflux::DropPolicy policy,
+                        size_t& read, uint64_t& skipped, int& groups) {
+    conflux::Config config;
+    config.buffer_size = 4;
+    config.window_size = std::chrono::milliseconds(5);
+    config.drop_policy = policy;
+
+    conflux::BagSynchronizer sync(config);
+    sync.add_topic("/fast");
+    sync.add_topic("/slow");
+    groups = 0;
+    sync.on_synchronized([&groups](const conflux::SyncGroup&) { ++groups; });
+
+    sync.open(bag.uri());
+    read = sync.play();
+    skipped = sync.skipped();
+    return sync.stats();
+}
+
+TEST(BagSynchronizerTest, RejectNewSkipsMessagesOfAFullTopic) {
+    MismatchedRatesBag bag("reject_new");
+    size_t read = 0;
+    uint64_t skipped = 0;
+    int groups = 0;
+    conflux::SyncStats stats = play(bag, conflux::DropPolicy::RejectNew, read, skipped, groups);
+
+    // The fast topic fills up while the slow one is silent, and playback
+    // moves on past what no longer fits
+    EXPECT_EQ(read, static_cast<size_t>(kFastCount + kSlowCount));
+    EXPECT_GT(skipped, 0u);
+    EXPECT_EQ(skipped, stats.streams[0].rejected_buffer_full);
+    EXPECT_GE(groups, 1);
+}
+
+TEST(BagSynchronizerTest, DropOldestKeepsTheNewestMessagesOfAFullTopic) {
+    MismatchedRatesBag bag("drop_oldest");
+    size_t read = 0;
+    uint64_t skipped = 0;
+    int groups = 0;
+    conflux::SyncStats stats = play(bag, conflux::DropPolicy::DropOldest, read, skipped, groups);
+
+    EXPECT_EQ(read, static_cast<size_t>(kFastCount + kSlowCount));
+    EXPECT_EQ(skipped, 0u);
+    EXPECT_GT(stats.streams[0].evicted_overflow, 0u);
+    EXPECT_GE(groups, 1);
+}
+
+}  // namespace
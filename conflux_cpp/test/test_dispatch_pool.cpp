@@ -0,0 +1,121 @@
+/*
+ * Conflux C++ Library - Callback Thread Tests
+ *
+ * Exercises the dispatch pool behind WorkerOptions::callback_threads
+ * through the public Synchronizer API.
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#include "conflux/synchronizer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <any>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+constexpr int64_t kStartNs = 1000000000;
+constexpr int64_t kPeriodNs = 10000000;
+constexpr int kPairs = 200;
+
+/// Groups seen by the callback threads.
+struct Observed {
+    std::mutex mutex;
+    std::multiset<int> values;
+    std::set<std::thread::id> threads;
+    std::atomic<int> busy{0};
+    std::atomic<int> max_busy{0};
+};
+
+/// Push kPairs matching pairs to a synchronizer running `options`, with a
+/// callback slow enough for the groups to pile up, then stop it.
+conflux::SyncStats run_pairs(const conflux::WorkerOptions& options, Observed& observed) {
+    conflux::Config config;
+    config.buffer_size = 1024;
+    conflux::Synchronizer sync(config);
+    sync.add_topic("/a");
+    sync.add_topic("/b");
+    sync.on_synchronized([&observed](const conflux::SyncGroup& group) {
+        int busy = ++observed.busy;
+        int max_busy = observed.max_busy.load();
+        while (busy > max_busy && !observed.max_busy.compare_exchange_weak(max_busy, busy)) {
+        }
+        {
+            std::lock_guard<std::mutex> lock(observed.mutex);
+            observed.values.insert(*group.get<int>(0));
+            observed.threads.insert(std::this_thread::get_id());
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+        --observed.busy;
+    });
+
+    sync.start(options);
+    for (int i = 0; i < kPairs; ++i) {
+        int64_t timestamp_ns = kStartNs + i * kPeriodNs;
+        sync.push_message(0, timestamp_ns, std::any(i));
+        sync.push_message(1, timestamp_ns + 1, std::any(i));
+    }
+
+    // Let the callback threads overlap before stopping
+    for (int k = 0; k < 2000 && sync.stats().groups < kPairs - 10; ++k) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    sync.stop();
+    return sync.stats();
+}
+
+TEST(DispatchPoolTest, InOrderDeliversEveryGroupOnce) {
+    conflux::WorkerOptions options;
+    options.callback_threads = 4;
+    options.dispatch_order = conflux::DispatchOrder::InOrder;
+
+    Observed observed;
+    conflux::SyncStats stats = run_pairs(options, observed);
+
+    EXPECT_GE(stats.groups, static_cast<uint64_t>(kPairs - 10));
+    EXPECT_EQ(stats.groups_dropped, 0u);
+    EXPECT_EQ(observed.values.size(), stats.groups);
+    for (int value : observed.values) {
+        EXPECT_EQ(observed.values.count(value), 1u);
+    }
+    EXPECT_GT(observed.threads.size(), 1u);
+    EXPECT_GT(observed.max_busy.load(), 1);
+}
+
+TEST(DispatchPoolTest, LatestOnlyAccountsForDroppedGroups) {
+    conflux::WorkerOptions options;
+    options.callback_threads = 2;
+    options.dispatch_order = conflux::DispatchOrder::LatestOnly;
+
+    Observed observed;
+    conflux::SyncStats stats = run_pairs(options, observed);
+
+    // Groups handed out before stop() still run, so none is unaccounted for
+    EXPECT_GT(stats.groups_dropped, 0u);
+    EXPECT_EQ(observed.values.size() + stats.groups_dropped, stats.groups);
+}
+
+TEST(DispatchPoolTest, StartRejectsInvalidOptions) {
+    conflux::Synchronizer sync{conflux::Config()};
+    sync.add_topic("/a");
+    sync.add_topic("/b");
+
+    conflux::WorkerOptions options;
+    options.callback_threads = 2;
+    EXPECT_THROW(sync.start(options), std::runtime_error);
+
+    sync.on_synchronized([](const conflux::SyncGroup&) {});
+    options.output_capacity = 4;
+    EXPECT_THROW(sync.start(options), std::runtime_error);
+    EXPECT_FALSE(sync.running());
+}
+
+}  // namespace
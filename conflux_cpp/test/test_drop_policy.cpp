@@ -0,0 +1,127 @@
+/*
+ * Conflux C++ Library - Drop Policy Tests
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#include "conflux/synchronizer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <any>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int64_t kStartNs = 1000000000;
+constexpr int64_t kPeriodNs = 100000000;
+constexpr size_t kBufferSize = 4;
+
+/// Holds the synchronizer's matcher inside the callback of the first
+/// group, so that pushes meanwhile pile up ahead of the core.
+class StalledCallback {
+public:
+    void operator()(const conflux::SyncGroup& group) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        values_.push_back(*group.get<int>(0));
+        entered_ = true;
+        cv_.notify_all();
+        cv_.wait(lock, [this]() { return released_; });
+    }
+
+    void wait_entered() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return entered_; });
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        released_ = true;
+        cv_.notify_all();
+    }
+
+    std::vector<int> values() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return values_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<int> values_;
+    bool entered_ = false;
+    bool released_ = false;
+};
+
+/// Stall the matcher, push `count` messages to stream 0, then let a
+/// stream 1 message at the newest timestamp complete a group.
+conflux::SyncStats overflow(conflux::DropPolicy policy, int count, std::vector<int>& values) {
+    conflux::Config config;
+    config.buffer_size = kBufferSize;
+    config.drop_policy = policy;
+    config.eager_dispatch = true;
+    conflux::Synchronizer sync(config);
+    sync.add_topic("/a");
+    sync.add_topic("/b");
+
+    StalledCallback callback;
+    sync.on_synchronized([&callback](const conflux::SyncGroup& group) { callback(group); });
+
+    std::thread matcher([&sync]() {
+        sync.push_message(0, kStartNs, std::any(0));
+        sync.push_message(1, kStartNs, std::any(0));
+    });
+    callback.wait_entered();
+
+    int64_t newest_ns = kStartNs;
+    for (int i = 1; i <= count; ++i) {
+        newest_ns = kStartNs + i * kPeriodNs;
+        sync.push_message(0, newest_ns, std::any(i));
+    }
+    sync.push_message(1, newest_ns, std::any(count));
+
+    callback.release();
+    matcher.join();
+
+    // A later pair closes the window of the group
+    int64_t later_ns = newest_ns + 10 * kPeriodNs;
+    sync.push_message(0, later_ns, std::any(-1));
+    sync.push_message(1, later_ns, std::any(-1));
+
+    values = callback.values();
+    return sync.stats();
+}
+
+TEST(DropPolicyTest, DropOldestAcceptsPushesWhileMatchingStalls) {
+    constexpr int kCount = 5 * kBufferSize;
+    std::vector<int> values;
+    conflux::SyncStats stats = overflow(conflux::DropPolicy::DropOldest, kCount, values);
+
+    // Nothing is rejected: the oldest messages make room instead
+    const conflux::StreamStats& stream = stats.streams[0];
+    EXPECT_EQ(stream.rejected_buffer_full, 0u);
+    EXPECT_GT(stream.evicted_overflow, 0u);
+    EXPECT_EQ(stream.accepted, static_cast<uint64_t>(kCount + 2));
+    EXPECT_EQ(stream.accepted, stream.emitted + stream.evicted() + stream.buffer_depth);
+
+    // The newest message survives and completes the group
+    ASSERT_GE(values.size(), 2u);
+    EXPECT_EQ(values[0], 0);
+    EXPECT_EQ(values[1], kCount);
+}
+
+TEST(DropPolicyTest, RejectNewRejectsPushesWhileMatchingStalls) {
+    constexpr int kCount = 5 * kBufferSize;
+    std::vector<int> values;
+    conflux::SyncStats stats = overflow(conflux::DropPolicy::RejectNew, kCount, values);
+
+    EXPECT_GT(stats.streams[0].rejected_buffer_full, 0u);
+}
+
+}  // namespace
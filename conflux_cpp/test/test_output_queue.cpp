@@ -0,0 +1,132 @@
+/*
+ * Conflux C++ Library - Output Queue Tests
+ *
+ * Exercises the worker's output queue behind WorkerOptions::output_capacity
+ * through the public Synchronizer API, in particular around stop().
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#include "conflux/synchronizer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <any>
+#include <chrono>
+#include <cstdint>
+
+namespace {
+
+constexpr int64_t kStartNs = 1000000000;
+constexpr int64_t kPeriodNs = 100000000;
+constexpr int kPairs = 50;
+
+conflux::Synchronizer make_synchronizer() {
+    conflux::Config config;
+    config.buffer_size = 256;
+    conflux::Synchronizer sync(config);
+    sync.add_topic("/a");
+    sync.add_topic("/b");
+    return sync;
+}
+
+/// Push `count` matching pairs, starting at pair `first`.
+void push_pairs(conflux::Synchronizer& sync, int first, int count) {
+    for (int i = first; i < first + count; ++i) {
+        int64_t timestamp_ns = kStartNs + i * kPeriodNs;
+        sync.push_message(0, timestamp_ns, std::any(i));
+        sync.push_message(1, timestamp_ns + 1, std::any(i));
+    }
+}
+
+/// Pop every queued group without waiting.
+uint64_t pop_all(conflux::Synchronizer& sync) {
+    uint64_t popped = 0;
+    conflux::SyncGroup group;
+    while (sync.pop_group(group)) {
+        ++popped;
+    }
+    return popped;
+}
+
+conflux::WorkerOptions queue_options() {
+    conflux::WorkerOptions options;
+    options.output_capacity = 2 * kPairs;
+    return options;
+}
+
+TEST(OutputQueueTest, StopKeepsGroupsMatchedDuringShutdown) {
+    conflux::Synchronizer sync = make_synchronizer();
+    sync.start(queue_options());
+    push_pairs(sync, 0, kPairs);
+    sync.stop();
+
+    // Whatever the worker had not matched yet was matched by stop()
+    conflux::SyncStats stats = sync.stats();
+    EXPECT_GE(stats.groups, static_cast<uint64_t>(kPairs - 1));
+    EXPECT_EQ(pop_all(sync), stats.groups);
+    EXPECT_EQ(stats.groups_dropped, 0u);
+}
+
+TEST(OutputQueueTest, GroupsMatchedAfterStopReachTheCallback) {
+    conflux::Synchronizer sync = make_synchronizer();
+    uint64_t called = 0;
+    sync.on_synchronized([&called](const conflux::SyncGroup&) { ++called; });
+
+    sync.start(queue_options());
+    push_pairs(sync, 0, kPairs);
+    sync.stop();
+    uint64_t popped = pop_all(sync);
+
+    push_pairs(sync, kPairs, kPairs);
+    sync.spin_once();
+
+    conflux::SyncStats stats = sync.stats();
+    EXPECT_GE(called, static_cast<uint64_t>(kPairs - 1));
+    EXPECT_EQ(popped + called, stats.groups);
+    EXPECT_EQ(stats.groups_dropped, 0u);
+}
+
+TEST(OutputQueueTest, GroupsMatchedAfterStopWaitForTheNextStart) {
+    conflux::Synchronizer sync = make_synchronizer();
+    sync.start(queue_options());
+    push_pairs(sync, 0, kPairs);
+    sync.stop();
+    uint64_t popped = pop_all(sync);
+
+    // Without a callback, nothing leaves the core while stopped
+    push_pairs(sync, kPairs, kPairs);
+    sync.spin_once();
+    EXPECT_EQ(sync.stats().groups, popped);
+
+    sync.start(queue_options());
+    push_pairs(sync, 2 * kPairs, 1);
+    conflux::SyncGroup group;
+    while (sync.pop_group(group, std::chrono::milliseconds(500))) {
+        ++popped;
+    }
+    sync.stop();
+    popped += pop_all(sync);
+
+    conflux::SyncStats stats = sync.stats();
+    EXPECT_GE(popped, static_cast<uint64_t>(2 * kPairs - 1));
+    EXPECT_EQ(popped, stats.groups);
+    EXPECT_EQ(stats.groups_dropped, 0u);
+}
+
+TEST(OutputQueueTest, StartCountsUnpoppedGroupsAsDropped) {
+    conflux::Synchronizer sync = make_synchronizer();
+    sync.start(queue_options());
+    push_pairs(sync, 0, kPairs);
+    sync.stop();
+    uint64_t queued = sync.stats().groups;
+
+    sync.start(queue_options());
+    sync.stop();
+    EXPECT_EQ(sync.stats().groups_dropped, queued);
+
+    conflux::SyncGroup group;
+    EXPECT_FALSE(sync.pop_group(group));
+}
+
+}  // namespace
@@ -0,0 +1,123 @@
+/*
+ * Conflux C++ Library - Realtime Allocation Check Tests
+ *
+ * Built with CONFLUX_RT_CHECK, so any heap allocation on the push, match
+ * and dispatch path of a preallocated synchronizer aborts the test.
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#include "conflux/synchronizer.hpp"
+#include "rt_check.hpp"
+
+#include <gtest/gtest.h>
+
+#include <any>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+
+namespace {
+
+constexpr int64_t kStartNs = 1000000000;
+constexpr int64_t kPeriodNs = 10000000;
+constexpr int kRounds = 2000;
+
+conflux::Config rt_config(bool eager_dispatch) {
+    conflux::Config config;
+    config.buffer_size = 8;
+    config.window_size = std::chrono::milliseconds(5);
+    config.eager_dispatch = eager_dispatch;
+    return config;
+}
+
+/// Push one round of messages, with gaps on stream 1 that force window
+/// evictions and an out-of-order message that is rejected.
+void push_round(conflux::Synchronizer& sync, int i) {
+    int64_t timestamp_ns = kStartNs + i * kPeriodNs;
+    sync.push_message(0, timestamp_ns, std::any(i));
+    if (i % 7 != 3) {
+        sync.push_message(1, timestamp_ns + 1000000, std::any(i));
+    }
+    if (i % 100 == 0) {
+        sync.push_message(1, kStartNs, std::any(i));
+    }
+}
+
+TEST(RtCheckTest, AllocationInScopeAborts) {
+    EXPECT_DEATH(
+        {
+            conflux::detail::NoAllocScope no_alloc(true);
+            void* volatile pointer = std::malloc(32);
+            (void)pointer;
+        },
+        "heap allocation on the realtime path");
+}
+
+TEST(RtCheckTest, EagerDispatchAllocatesNothing) {
+    conflux::Synchronizer sync(rt_config(true));
+    sync.add_topic("/a");
+    sync.add_topic("/b");
+    int groups = 0;
+    sync.on_synchronized([&groups](const conflux::SyncGroup&) { ++groups; });
+    sync.preallocate();
+
+    for (int i = 0; i < kRounds; ++i) {
+        push_round(sync, i);
+    }
+    EXPECT_GT(groups, kRounds / 2);
+}
+
+TEST(RtCheckTest, SpinSomeAllocatesNothing) {
+    conflux::Synchronizer sync(rt_config(false));
+    sync.add_topic("/a");
+    sync.add_topic("/b");
+    int groups = 0;
+    sync.on_synchronized([&groups](const conflux::SyncGroup&) { ++groups; });
+    sync.preallocate();
+
+    for (int i = 0; i < kRounds; ++i) {
+        push_round(sync, i);
+        if (i % 4 == 3) {
+            sync.spin_some(2);
+        }
+    }
+    sync.spin_once();
+    EXPECT_GT(groups, kRounds / 2);
+}
+
+TEST(RtCheckTest, OutputQueueAllocatesNothing) {
+    conflux::Synchronizer sync(rt_config(false));
+    sync.add_topic("/a");
+    sync.add_topic("/b");
+    sync.preallocate();
+
+    conflux::WorkerOptions options;
+    options.output_capacity = 16;
+    options.output_policy = conflux::OutputPolicy::DropOldest;
+    sync.start(options);
+
+    // The group's storage is sized by the first pop and reused afterwards
+    conflux::SyncGroup group;
+    int round = 0;
+    do {
+        push_round(sync, round++);
+    } while (!sync.pop_group(group, std::chrono::milliseconds(10)));
+    int popped = 1;
+
+    for (int i = 0; i < kRounds; ++i) {
+        push_round(sync, round++);
+        conflux::detail::NoAllocScope no_alloc(true);
+        while (sync.pop_group(group)) {
+            ++popped;
+        }
+        if (i % 64 == 0) {
+            std::this_thread::yield();
+        }
+    }
+    sync.stop();
+    EXPECT_GT(popped, 1);
+}
+
+}  // namespace
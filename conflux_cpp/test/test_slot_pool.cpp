@@ -0,0 +1,145 @@
+/*
+ * Conflux C++ Library - Slot Pool Tests
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#include "conflux/detail/slot_pool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using conflux::detail::SlotHandle;
+using conflux::detail::SlotPool;
+
+TEST(SlotHandleTest, RoundTripsThroughUserData) {
+    SlotHandle handle;
+    handle.stream = SlotHandle::kStreamMask;
+    handle.slot = SlotHandle::kSlotMask;
+    handle.generation = 12345;
+
+    SlotHandle unpacked = SlotHandle::from_user_data(handle.to_user_data());
+    EXPECT_EQ(unpacked.stream, handle.stream);
+    EXPECT_EQ(unpacked.slot, handle.slot);
+    EXPECT_EQ(unpacked.generation, handle.generation);
+}
+
+TEST(SlotPoolTest, AcquireFailsWhenExhausted) {
+    SlotPool<int> pool(3, 2);
+
+    auto first = pool.acquire(1);
+    auto second = pool.acquire(2);
+    ASSERT_TRUE(first && second);
+    EXPECT_EQ(first->stream, 3u);
+    EXPECT_NE(first->slot, second->slot);
+
+    int payload = 3;
+    EXPECT_FALSE(pool.acquire(std::move(payload)));
+
+    pool.release(*first);
+    auto third = pool.acquire(4);
+    ASSERT_TRUE(third);
+    EXPECT_EQ(*pool.get(*third), 4);
+    EXPECT_EQ(*pool.get(*second), 2);
+}
+
+TEST(SlotPoolTest, FailedAcquireLeavesPayload) {
+    SlotPool<std::unique_ptr<int>> pool(0, 1);
+    ASSERT_TRUE(pool.acquire(std::make_unique<int>(1)));
+
+    auto payload = std::make_unique<int>(2);
+    EXPECT_FALSE(pool.acquire(std::move(payload)));
+    ASSERT_TRUE(payload);
+    EXPECT_EQ(*payload, 2);
+}
+
+TEST(SlotPoolTest, StaleHandleDoesNotResolve) {
+    SlotPool<int> pool(0, 1);
+    auto stale = pool.acquire(1);
+    ASSERT_TRUE(stale);
+    EXPECT_EQ(pool.take(*stale), std::optional<int>(1));
+
+    // The same slot is reused for the next message
+    auto fresh = pool.acquire(2);
+    ASSERT_TRUE(fresh);
+    EXPECT_EQ(fresh->slot, stale->slot);
+    EXPECT_NE(fresh->generation, stale->generation);
+
+    EXPECT_EQ(pool.get(*stale), nullptr);
+    EXPECT_EQ(pool.take(*stale), std::nullopt);
+
+    // Releasing a stale handle leaves the current message alone
+    pool.release(*stale);
+    ASSERT_NE(pool.get(*fresh), nullptr);
+    EXPECT_EQ(*pool.get(*fresh), 2);
+    int payload = 3;
+    EXPECT_FALSE(pool.acquire(std::move(payload)));
+}
+
+TEST(SlotPoolTest, ConcurrentAcquireAndRelease) {
+    constexpr size_t kCapacity = 8;
+    constexpr int kThreads = 4;
+    constexpr int kIterations = 20000;
+
+    SlotPool<int> pool(0, kCapacity);
+    std::vector<std::atomic<int>> owners(kCapacity);
+    std::atomic<bool> overlap{false};
+    std::atomic<int> acquired{0};
+
+    // Every thread holds up to two slots at a time, so the pool runs dry
+    // and acquire() races with release() on the same free list
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < kIterations; ++i) {
+                std::optional<SlotHandle> held[2];
+                for (auto& handle : held) {
+                    int payload = t * kIterations + i;
+                    handle = pool.acquire(std::move(payload));
+                    if (!handle) {
+                        continue;
+                    }
+                    if (owners[handle->slot].exchange(t + 1) != 0) {
+                        overlap = true;
+                    }
+                    if (*pool.get(*handle) != t * kIterations + i) {
+                        overlap = true;
+                    }
+                    ++acquired;
+                }
+                for (auto& handle : held) {
+                    if (handle) {
+                        owners[handle->slot].store(0);
+                        pool.release(*handle);
+                    }
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_FALSE(overlap);
+    EXPECT_GT(acquired.load(), 0);
+
+    // Every slot is back on the free list exactly once
+    std::vector<bool> seen(kCapacity, false);
+    for (size_t i = 0; i < kCapacity; ++i) {
+        auto handle = pool.acquire(0);
+        ASSERT_TRUE(handle);
+        EXPECT_FALSE(seen[handle->slot]);
+        seen[handle->slot] = true;
+    }
+    int payload = 0;
+    EXPECT_FALSE(pool.acquire(std::move(payload)));
+}
+
+}  // namespace
@@ -0,0 +1,102 @@
+/*
+ * Conflux C++ Library - SPSC Queue Tests
+ *
+ * License: MIT OR Apache-2.0
+ */
+
+#include "conflux/detail/spsc_queue.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+namespace {
+
+using conflux::detail::SpscQueue;
+
+TEST(SpscQueueTest, EmptyQueueHasNoFront) {
+    SpscQueue<int> queue(4);
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(queue.size(), 0u);
+    EXPECT_EQ(queue.front(), nullptr);
+}
+
+TEST(SpscQueueTest, CapacityRoundsUpToPowerOfTwo) {
+    EXPECT_EQ(SpscQueue<int>(1).capacity(), 1u);
+    EXPECT_EQ(SpscQueue<int>(5).capacity(), 8u);
+    EXPECT_EQ(SpscQueue<int>(8).capacity(), 8u);
+}
+
+TEST(SpscQueueTest, RejectsPushWhenFull) {
+    SpscQueue<int> queue(4);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.try_push(i));
+    }
+    EXPECT_FALSE(queue.try_push(4));
+    EXPECT_EQ(queue.size(), 4u);
+
+    // Popping one makes room for exactly one more
+    ASSERT_NE(queue.front(), nullptr);
+    EXPECT_EQ(*queue.front(), 0);
+    queue.pop();
+    EXPECT_TRUE(queue.try_push(4));
+    EXPECT_FALSE(queue.try_push(5));
+}
+
+TEST(SpscQueueTest, KeepsOrderAcrossWrapAround) {
+    SpscQueue<int> queue(4);
+    int next_push = 0;
+    int next_pop = 0;
+    for (int round = 0; round < 10; ++round) {
+        while (queue.try_push(next_push)) {
+            ++next_push;
+        }
+        for (int i = 0; i < 3; ++i) {
+            ASSERT_NE(queue.front(), nullptr);
+            EXPECT_EQ(*queue.front(), next_pop++);
+            queue.pop();
+        }
+    }
+    while (const int* value = queue.front()) {
+        EXPECT_EQ(*value, next_pop++);
+        queue.pop();
+    }
+    EXPECT_EQ(next_pop, next_push);
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(SpscQueueTest, ConcurrentProducerAndConsumer) {
+    constexpr int kCount = 200000;
+    SpscQueue<int> queue(16);
+
+    // Yield when blocked, so that the test also finishes quickly on a
+    // single CPU
+    std::thread producer([&]() {
+        for (int i = 0; i < kCount;) {
+            if (queue.try_push(i)) {
+                ++i;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int expected = 0;
+    bool ordered = true;
+    while (expected < kCount) {
+        if (const int* value = queue.front()) {
+            ordered = ordered && *value == expected;
+            ++expected;
+            queue.pop();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(queue.front(), nullptr);
+}
+
+}  // namespace
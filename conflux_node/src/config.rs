@@ -116,6 +116,8 @@ impl Config {
             buf_size: self.sync.buffer_size,
             drop_policy,
             staleness_config,
+            match_policy: conflux_core::MatchPolicy::default(),
+            optional: Vec::new(),
         }
     }
 }
@@ -22,9 +22,9 @@ Example:
     ...     process(image, points)
 """
 
-from ._core import DropPolicy, SyncConfig, SyncGroup, Synchronizer
+from ._core import DropPolicy, MatchPolicy, SyncConfig, SyncGroup, Synchronizer
 
-__all__ = ["DropPolicy", "SyncConfig", "SyncGroup", "Synchronizer"]
+__all__ = ["DropPolicy", "MatchPolicy", "SyncConfig", "SyncGroup", "Synchronizer"]
 
 # Conditionally import ROS2Synchronizer and SyncStatistics if rclpy is available
 try:
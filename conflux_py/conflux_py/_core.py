@@ -22,6 +22,25 @@ class DropPolicy(IntEnum):
     """
 
 
+class MatchPolicy(IntEnum):
+    """Algorithm used to form groups."""
+
+    WINDOW = 0
+    """Group messages within the time window once the buffers span it.
+    A group is only emitted after a full window of newer data arrives.
+    """
+
+    APPROXIMATE = 1
+    """Pick one message per stream with minimal spread, as soon as every
+    stream has a message at or after the latest front message.
+    """
+
+    PIVOT = 2
+    """Pair each message of the pivot stream with the nearest message of
+    every other stream, as soon as it is bracketed.
+    """
+
+
 @dataclass
 class SyncConfig:
     """Configuration for the synchronizer.
@@ -31,11 +50,16 @@ class SyncConfig:
             Use None for infinite window (no time-based dropping).
         buffer_size: Maximum number of messages to buffer per stream.
         drop_policy: Policy for buffer overflow (DropPolicy.REJECT_NEW or DropPolicy.DROP_OLDEST).
+        match_policy: Algorithm used to form groups. The window, if any, still
+            bounds the spread of a group.
+        pivot_index: Index of the reference topic for MatchPolicy.PIVOT.
     """
 
     window_size_ms: Optional[int] = 50
     buffer_size: int = 64
     drop_policy: DropPolicy = DropPolicy.REJECT_NEW
+    match_policy: MatchPolicy = MatchPolicy.WINDOW
+    pivot_index: int = 0
 
     @classmethod
     def offline(cls, buffer_size: int = 100) -> "SyncConfig":
@@ -64,7 +88,8 @@ class SyncConfig:
     def __repr__(self) -> str:
         return (
             f"SyncConfig(window_size_ms={self.window_size_ms}, "
-            f"buffer_size={self.buffer_size}, drop_policy={self.drop_policy.name})"
+            f"buffer_size={self.buffer_size}, drop_policy={self.drop_policy.name}, "
+            f"match_policy={self.match_policy.name})"
         )
 
 
@@ -191,6 +216,8 @@ class Synchronizer:
             window_size_ms=self._config.window_size_ms,
             buffer_size=self._config.buffer_size,
             drop_policy=int(self._config.drop_policy),
+            match_policy=int(self._config.match_policy),
+            pivot_index=self._config.pivot_index,
         )
 
     def push(self, topic: str, timestamp_ns: int, message: Any) -> bool:
@@ -216,6 +243,28 @@ class Synchronizer:
 
         return self._ffi_sync.push(topic, timestamp_ns, message)
 
+    def set_optional(self, topic: str, deadline_ms: float) -> None:
+        """Mark a topic as optional, e.g. a sensor prone to outages.
+
+        Groups stop waiting for an optional topic once the other streams
+        run deadline_ms past them, in message time, and are emitted without
+        it; the topic is then missing from the SyncGroup. Call this before
+        pushing messages.
+
+        Args:
+            topic: The topic name.
+            deadline_ms: Deadline in milliseconds.
+
+        Raises:
+            KeyError: If the topic was not registered at creation.
+            ValueError: If deadline_ms is negative, no required topic would
+                remain, or the topic is the pivot of MatchPolicy.PIVOT.
+        """
+        if deadline_ms < 0:
+            raise ValueError("deadline_ms must be non-negative")
+
+        self._ffi_sync.set_optional(topic, int(deadline_ms * 1_000_000))
+
     def poll(self) -> Optional[SyncGroup]:
         """Poll for a synchronized group of messages.
 
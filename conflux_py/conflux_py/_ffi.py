@@ -30,6 +30,8 @@ class ConfluxResult:
     KEY_NOT_FOUND = 3
     NULL_POINTER = 4
     INTERNAL_ERROR = 5
+    LATE_MESSAGE = 6
+    OUT_OF_ORDER = 7
 
 
 class DropPolicy:
@@ -46,6 +48,23 @@ class DropPolicy:
     """
 
 
+class MatchPolicy:
+    """Algorithm used to form groups."""
+
+    WINDOW = 0
+    """Group messages within the time window once the buffers span it."""
+
+    APPROXIMATE = 1
+    """Pick one message per stream with minimal spread, as soon as every
+    stream has a message at or after the latest front message.
+    """
+
+    PIVOT = 2
+    """Pair each message of the pivot stream with the nearest message of
+    every other stream, as soon as it is bracketed.
+    """
+
+
 class ConfluxConfig(Structure):
     """Configuration for creating a synchronizer."""
 
@@ -53,6 +72,11 @@ class ConfluxConfig(Structure):
         ("window_size_ms", c_uint64),  # Use 0 for infinite window
         ("buffer_size", c_size_t),
         ("drop_policy", c_int32),  # DropPolicy enum value
+        ("window_size_ns", c_uint64),  # Overrides window_size_ms when nonzero
+        ("staleness", c_int32),  # StalenessPreset enum value
+        ("staleness_timeout_ns", c_uint64),  # 0 uses the time window
+        ("match_policy", c_int32),  # MatchPolicy enum value
+        ("pivot_index", c_size_t),  # Reference stream for MatchPolicy.PIVOT
     ]
 
 
@@ -123,6 +147,9 @@ if _lib_path:
         _lib.conflux_push_message.argtypes = [c_void_p, c_char_p, c_int64, c_void_p]
         _lib.conflux_push_message.restype = c_int32
 
+        _lib.conflux_set_optional.argtypes = [c_void_p, c_size_t, c_uint64]
+        _lib.conflux_set_optional.restype = c_int32
+
         _lib.conflux_poll.argtypes = [c_void_p, POLL_CALLBACK, c_void_p]
         _lib.conflux_poll.restype = c_int32
 
@@ -161,6 +188,8 @@ class FFISynchronizer:
         window_size_ms: Optional[int] = 50,
         buffer_size: int = 64,
         drop_policy: int = DropPolicy.REJECT_NEW,
+        match_policy: int = MatchPolicy.WINDOW,
+        pivot_index: int = 0,
     ):
         """Create a new synchronizer.
 
@@ -169,10 +198,12 @@ class FFISynchronizer:
             window_size_ms: Time window in milliseconds. Use None or 0 for infinite window.
             buffer_size: Maximum messages to buffer per topic.
             drop_policy: Policy for buffer overflow (DropPolicy.REJECT_NEW or DropPolicy.DROP_OLDEST).
+            match_policy: Algorithm used to form groups (a MatchPolicy value).
+            pivot_index: Index in topics of the reference stream for MatchPolicy.PIVOT.
 
         Raises:
             RuntimeError: If the FFI library is not available.
-            ValueError: If topics is empty.
+            ValueError: If topics is empty or pivot_index is out of range.
         """
         if not is_available():
             raise RuntimeError(
@@ -186,11 +217,16 @@ class FFISynchronizer:
         self._topics = list(topics)
         self._handle: Optional[c_void_p] = None
 
+        if match_policy == MatchPolicy.PIVOT and not 0 <= pivot_index < len(topics):
+            raise ValueError("pivot_index must name one of the topics")
+
         # Create config (0 means infinite window)
         config = ConfluxConfig(
             window_size_ms=window_size_ms if window_size_ms is not None else 0,
             buffer_size=buffer_size,
             drop_policy=drop_policy,
+            match_policy=match_policy,
+            pivot_index=pivot_index,
         )
 
         # Create key array
@@ -208,7 +244,8 @@ class FFISynchronizer:
 
         # Store references to prevent garbage collection of message objects
         self._message_refs: dict[int, object] = {}
-        self._next_id = 0
+        # Start at 1: an ID of 0 would cross the FFI as a null user_data
+        self._next_id = 1
 
     def __del__(self):
         """Clean up the synchronizer."""
@@ -257,6 +294,31 @@ class FFISynchronizer:
 
         return True
 
+    def set_optional(self, topic: str, deadline_ns: int) -> None:
+        """Mark a topic as optional.
+
+        Groups are emitted without the topic once the other streams run
+        deadline_ns past them without a usable message from it.
+
+        Args:
+            topic: The topic name.
+            deadline_ns: Deadline in nanoseconds of message time.
+
+        Raises:
+            KeyError: If the topic was not registered.
+            ValueError: If no required topic would remain, or the topic is
+                the pivot of MatchPolicy.PIVOT.
+        """
+        if not self._handle:
+            raise RuntimeError("Synchronizer has been freed")
+
+        if topic not in self._topics:
+            raise KeyError(f"Unknown topic: {topic}")
+
+        result = _lib.conflux_set_optional(self._handle, self._topics.index(topic), deadline_ns)
+        if result != ConfluxResult.OK:
+            raise ValueError(f"Cannot make {topic} optional")
+
     def poll(self) -> Optional[dict[str, tuple[int, object]]]:
         """Poll for a synchronized group.
 
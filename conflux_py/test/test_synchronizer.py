@@ -128,6 +128,59 @@ class TestSynchronizer:
         assert "topic1" in result
         assert "topic2" in result
 
+    def test_poll_pivot_policy(self):
+        """Test that the pivot policy matches once the pivot is bracketed."""
+        from conflux_py import MatchPolicy, SyncConfig, Synchronizer
+
+        config = SyncConfig(
+            window_size_ms=100, buffer_size=10, match_policy=MatchPolicy.PIVOT, pivot_index=0
+        )
+        sync = Synchronizer(["topic1", "topic2"], config)
+
+        sync.push("topic1", 1_000_000_000, {"data": "pivot"})
+        sync.push("topic2", 990_000_000, {"data": "before"})
+        assert sync.poll() is None
+
+        # Bracketed before the buffers span the 100 ms window
+        sync.push("topic2", 1_020_000_000, {"data": "after"})
+        result = sync.poll()
+        assert result is not None
+        assert result["topic2"] == {"data": "before"}
+
+    def test_invalid_pivot_index(self):
+        """Test that a pivot index outside the topics raises error."""
+        from conflux_py import MatchPolicy, SyncConfig, Synchronizer
+
+        config = SyncConfig(match_policy=MatchPolicy.PIVOT, pivot_index=2)
+        with pytest.raises(ValueError, match="pivot_index"):
+            Synchronizer(["topic1", "topic2"], config)
+
+    def test_optional_topic_partial_group(self):
+        """Test that an optional topic is left out once its deadline passes."""
+        from conflux_py import SyncConfig, Synchronizer
+
+        config = SyncConfig(window_size_ms=100, buffer_size=10)
+        sync = Synchronizer(["topic1", "topic2"], config)
+        sync.set_optional("topic2", 50)
+
+        for step in range(3):
+            sync.push("topic1", 1_000_000_000 + step * 100_000_000, {"step": step})
+
+        result = sync.poll()
+        assert result is not None
+        assert "topic1" in result
+        assert "topic2" not in result
+        assert len(result) == 1
+
+    def test_optional_all_topics(self):
+        """Test that one topic must stay required."""
+        from conflux_py import Synchronizer
+
+        sync = Synchronizer(["topic1", "topic2"])
+        sync.set_optional("topic1", 10)
+        with pytest.raises(ValueError):
+            sync.set_optional("topic2", 10)
+
     def test_sync_group_access(self):
         """Test SyncGroup access methods."""
         from conflux_py import SyncConfig, Synchronizer
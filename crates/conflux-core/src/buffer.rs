@@ -3,11 +3,16 @@ use std::{collections::VecDeque, time::Duration};
 
 /// A buffer to store a sequence of messages with monotonically
 /// increasing timestamps.
+///
+/// Timestamps are stored in a ring of their own, next to the ring of
+/// messages, so searches by time only touch the timestamps and the
+/// messages before a point in time are found by binary search.
 #[derive(Debug)]
 pub struct Buffer<T>
 where
     T: WithTimestamp,
 {
+    timestamps: VecDeque<Duration>,
     buffer: VecDeque<T>,
     last_ts: Option<Duration>,
 }
@@ -18,6 +23,7 @@ where
 {
     pub fn with_capacity(capacity: usize) -> Self {
         Self {
+            timestamps: VecDeque::with_capacity(capacity),
             buffer: VecDeque::with_capacity(capacity),
             last_ts: None,
         }
@@ -40,11 +46,34 @@ where
     }
 
     pub fn pop_front(&mut self) -> Option<T> {
+        self.timestamps.pop_front();
         self.buffer.pop_front()
     }
 
+    /// Get the message at position `index`, counted from the oldest.
+    pub fn get(&self, index: usize) -> Option<&T> {
+        self.buffer.get(index)
+    }
+
+    /// Get the timestamp of the message at position `index`, counted from
+    /// the oldest.
+    pub fn timestamp(&self, index: usize) -> Option<Duration> {
+        self.timestamps.get(index).copied()
+    }
+
+    /// Get the position of the first message at or after `ts`, or the
+    /// length of the buffer if there is none, in O(log n).
+    pub fn lower_bound(&self, ts: Duration) -> usize {
+        self.timestamps.partition_point(|&item_ts| item_ts < ts)
+    }
+
+    /// Iterate over the buffered messages, oldest first.
+    pub fn iter(&self) -> impl Iterator<Item = &T> {
+        self.buffer.iter()
+    }
+
     pub fn front_entry(&mut self) -> Option<FrontEntry<'_, T>> {
-        let item = self.buffer.pop_front()?;
+        let item = self.pop_front()?;
         Some(FrontEntry {
             buffer: self,
             item: Some(item),
@@ -70,58 +99,69 @@ where
     //         .or(self.last_ts)
     // }
 
-    // pub fn last_ts(&self) -> Option<Duration> {
-    //     self.last_ts
-    // }
+    /// Timestamp of the last message pushed, even if it has since been
+    /// removed. Later pushes must be stamped after it.
+    pub fn last_ts(&self) -> Option<Duration> {
+        self.last_ts
+    }
+
+    /// Reject later pushes stamped at or before `ts`, as if a message with
+    /// that timestamp had been pushed. Never lowers the last timestamp.
+    pub fn raise_last_ts(&mut self, ts: Duration) {
+        self.last_ts = self.last_ts.max(Some(ts));
+    }
 
     /// Drops messages before the a specific timestamp and returns the
     /// number of dropped messages.
     pub fn drop_before(&mut self, ts: Duration) -> usize {
-        let mut count = 0;
-
-        loop {
-            let Some(entry) = self.front_entry() else {
-                break;
-            };
-
-            if entry.value().timestamp() >= ts {
-                break;
-            } else {
-                let _ = entry.take();
-                count += 1;
-            }
-        }
+        self.drop_before_with(ts, |_| {})
+    }
 
+    /// Same as [drop_before](Self::drop_before), but hands every dropped
+    /// message to `on_drop`.
+    pub fn drop_before_with(&mut self, ts: Duration, on_drop: impl FnMut(T)) -> usize {
+        let count = self.lower_bound(ts);
+        self.drop_front(count, on_drop);
         count
     }
 
     /// Drop expired messages based on their timeout and reference timestamp.
     /// Returns the number of dropped messages.
     pub fn drop_expired(&mut self, reference_timestamp: Duration) -> usize {
-        let mut count = 0;
-
-        loop {
-            let Some(entry) = self.front_entry() else {
-                break;
-            };
-
-            let message = entry.value();
-            let message_time = message.timestamp();
-
-            // Check if message has expired based on its timeout
-            if let Some(timeout) = message.timeout()
-                && reference_timestamp.saturating_sub(message_time) >= timeout
-            {
-                let _ = entry.take();
-                count += 1;
-                continue; // Continue checking next message
-            }
+        self.drop_expired_with(reference_timestamp, |_| {})
+    }
+
+    /// Same as [drop_expired](Self::drop_expired), but hands every dropped
+    /// message to `on_drop`.
+    pub fn drop_expired_with(
+        &mut self,
+        reference_timestamp: Duration,
+        on_drop: impl FnMut(T),
+    ) -> usize {
+        // Timeouts differ between messages, so expiry is not ordered like
+        // timestamps; stop at the first message that has not expired
+        let count = self
+            .buffer
+            .iter()
+            .zip(&self.timestamps)
+            .take_while(|&(message, &message_time)| {
+                message.timeout().is_some_and(|timeout| {
+                    reference_timestamp.saturating_sub(message_time) >= timeout
+                })
+            })
+            .count();
+        self.drop_front(count, on_drop);
+        count
+    }
 
-            // Message not expired or has no timeout - stop here since messages are ordered
-            break;
+    /// Remove the `count` oldest messages at once, handing each to
+    /// `on_drop`.
+    fn drop_front(&mut self, count: usize, on_drop: impl FnMut(T)) {
+        if count == 0 {
+            return;
         }
-
-        count
+        self.timestamps.drain(..count);
+        self.buffer.drain(..count).for_each(on_drop);
     }
 
     /// Try to push a message into the buffer.
@@ -141,6 +181,7 @@ where
         }
 
         self.last_ts = Some(timestamp);
+        self.timestamps.push_back(timestamp);
         self.buffer.push_back(item);
         Ok(())
     }
@@ -173,6 +214,7 @@ where
 {
     fn drop(&mut self) {
         if let Some(item) = self.item.take() {
+            self.buffer.timestamps.push_front(item.timestamp());
             self.buffer.buffer.push_front(item);
         }
     }
@@ -371,6 +413,72 @@ mod tests {
         );
     }
 
+    #[test]
+    fn test_buffer_drop_before_with_reports_dropped() {
+        let mut buffer = Buffer::with_capacity(5);
+        for msg in create_messages(&[1000, 1500, 2000, 2500]) {
+            buffer.try_push(msg).unwrap();
+        }
+
+        let mut dropped = Vec::new();
+        let count = buffer.drop_before_with(Duration::from_millis(2000), |msg| {
+            dropped.push(msg.timestamp())
+        });
+
+        assert_eq!(count, 2);
+        assert_eq!(
+            dropped,
+            vec![Duration::from_millis(1000), Duration::from_millis(1500)]
+        );
+        assert_eq!(
+            buffer.front().unwrap().timestamp(),
+            Duration::from_millis(2000)
+        );
+    }
+
+    #[test]
+    fn test_buffer_lower_bound() {
+        let mut buffer = Buffer::with_capacity(4);
+        assert_eq!(buffer.lower_bound(Duration::from_millis(1000)), 0);
+
+        for msg in create_messages(&[1000, 1500, 2000, 2500]) {
+            buffer.try_push(msg).unwrap();
+        }
+
+        assert_eq!(buffer.lower_bound(Duration::from_millis(500)), 0);
+        assert_eq!(buffer.lower_bound(Duration::from_millis(1500)), 1);
+        assert_eq!(buffer.lower_bound(Duration::from_millis(1501)), 2);
+        assert_eq!(buffer.lower_bound(Duration::from_millis(3000)), 4);
+        assert_eq!(buffer.timestamp(2), Some(Duration::from_millis(2000)));
+        assert_eq!(buffer.timestamp(4), None);
+    }
+
+    #[test]
+    fn test_buffer_timestamps_follow_messages() {
+        let mut buffer = Buffer::with_capacity(3);
+
+        // Wrap the rings around their capacity
+        for ts in (1..=10).map(|i| i * 100) {
+            if buffer.len() == 3 {
+                buffer.pop_front();
+            }
+            buffer.try_push(create_message(ts)).unwrap();
+        }
+        assert_eq!(buffer.lower_bound(Duration::from_millis(850)), 1);
+
+        // A front entry that is not taken goes back with its timestamp
+        assert!(buffer.front_entry().is_some());
+        assert_eq!(buffer.timestamp(0), Some(Duration::from_millis(800)));
+
+        let dropped = buffer.drop_before(Duration::from_millis(1000));
+        assert_eq!(dropped, 2);
+        assert_eq!(buffer.timestamp(0), Some(Duration::from_millis(1000)));
+        assert_eq!(
+            buffer.front().unwrap().timestamp(),
+            Duration::from_millis(1000)
+        );
+    }
+
     #[test]
     fn test_buffer_try_push_valid_timestamp() {
         let mut buffer = Buffer::with_capacity(3);
@@ -14,6 +14,28 @@ pub enum DropPolicy {
     DropOldest,
 }
 
+/// Algorithm used by [try_match](crate::state::State::try_match) to form
+/// groups.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum MatchPolicy {
+    /// Group the earliest messages that fit within the window, once the
+    /// buffers span a full window of lookahead.
+    #[default]
+    Window,
+
+    /// Pick one message per stream around the latest front message so
+    /// that the spread between the group's timestamps is minimal, as soon
+    /// as every stream has a message at or after it. Groups wider than the
+    /// window, if finite, are not emitted.
+    Approximate,
+
+    /// Pair each message of the stream at this buffer index with the
+    /// nearest message of every other stream, as soon as a later message
+    /// on each stream brackets it. Pivot messages with no partner within
+    /// the window, if finite, are dropped.
+    Pivot(usize),
+}
+
 /// Configuration parameters that are passed to [sync](crate::sync());
 #[derive(Debug, Clone)]
 pub struct Config {
@@ -28,6 +50,14 @@ pub struct Config {
     pub drop_policy: DropPolicy,
     /// Staleness detection configuration (optional)
     pub staleness_config: Option<StalenessConfig>,
+    /// Algorithm used to form groups.
+    pub match_policy: MatchPolicy,
+    /// Streams, by position in the keys, that may be missing from a
+    /// group, each with its deadline. A group waits for an empty optional
+    /// stream until the newest buffered message is the deadline past the
+    /// group, then is emitted without it. At least one stream must stay
+    /// required.
+    pub optional: Vec<(usize, Duration)>,
 }
 
 impl Config {
@@ -45,6 +75,8 @@ impl Config {
             buf_size,
             drop_policy,
             staleness_config: Some(staleness_config),
+            match_policy: MatchPolicy::default(),
+            optional: Vec::new(),
         }
     }
 
@@ -60,6 +92,8 @@ impl Config {
             buf_size,
             drop_policy: DropPolicy::default(),
             staleness_config: None,
+            match_policy: MatchPolicy::default(),
+            optional: Vec::new(),
         }
     }
 
@@ -72,6 +106,8 @@ impl Config {
             buf_size,
             drop_policy: DropPolicy::RejectNew,
             staleness_config: None,
+            match_policy: MatchPolicy::default(),
+            optional: Vec::new(),
         }
     }
 
@@ -84,6 +120,8 @@ impl Config {
             buf_size,
             drop_policy: DropPolicy::DropOldest,
             staleness_config: None,
+            match_policy: MatchPolicy::default(),
+            optional: Vec::new(),
         }
     }
 
@@ -93,6 +131,18 @@ impl Config {
         self
     }
 
+    /// Set the match policy
+    pub fn with_match_policy(mut self, match_policy: MatchPolicy) -> Self {
+        self.match_policy = match_policy;
+        self
+    }
+
+    /// Mark the stream at position `index` of the keys as optional
+    pub fn with_optional(mut self, index: usize, deadline: Duration) -> Self {
+        self.optional.push((index, deadline));
+        self
+    }
+
     /// Enable staleness detection on an existing config
     pub fn enable_staleness(mut self, staleness_config: StalenessConfig) -> Self {
         self.staleness_config = Some(staleness_config);
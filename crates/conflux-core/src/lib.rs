@@ -56,14 +56,15 @@
 
 pub mod buffer;
 mod config;
+pub mod matcher;
 pub mod staleness;
 pub mod state;
 mod sync;
 mod types;
 mod utils;
 
-pub use config::{Config, DropPolicy};
+pub use config::{Config, DropPolicy, MatchPolicy};
 pub use staleness::{StalenessConfig, StalenessDetector, StalenessStats};
-pub use state::PushError;
+pub use state::{Eviction, EvictionReason, PushError};
 pub use sync::sync;
 pub use types::*;
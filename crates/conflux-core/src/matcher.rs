@@ -0,0 +1,503 @@
+//! Incremental matching on top of [State].
+//!
+//! [State::try_match] scans every buffer on each call to find the
+//! earliest and latest buffered timestamps, and returns a freshly
+//! allocated map. [IndexedMatcher] keeps those bounds in tournament trees
+//! updated on each push, so polls that cannot produce a group return
+//! without looking at the buffers, and writes groups into a caller-owned
+//! vector indexed by stream.
+
+use crate::{
+    config::MatchPolicy,
+    state::{Eviction, PushError, State},
+    types::{Key, WithTimestamp},
+};
+use std::time::Duration;
+
+/// A [State] indexed for matching without rescanning its buffers.
+///
+/// Two tournament trees over the required streams hold the latest front
+/// timestamp and the earliest back timestamp, and counters track how many
+/// required buffers are empty or hold a single message. A push refreshes
+/// one leaf in O(log n), which answers [is_ready](Self::is_ready),
+/// [is_empty](Self::is_empty) and the first check of every match policy
+/// in O(1). When that check fails, or a match attempt finds nothing, the
+/// matcher remembers it and declines further attempts until a message
+/// arrives.
+#[derive(Debug)]
+pub struct IndexedMatcher<K, T>
+where
+    K: Key,
+    T: WithTimestamp + Clone,
+{
+    state: State<K, T>,
+
+    /// Max-tree of front timestamps, leaves at `[n, 2n)`.
+    heads: Vec<Duration>,
+
+    /// Min-tree of back timestamps, leaves at `[n, 2n)`.
+    tails: Vec<Duration>,
+
+    /// Buffer length of each stream as last indexed.
+    lens: Vec<usize>,
+
+    /// Number of required streams.
+    required: usize,
+
+    /// Number of required streams with an empty buffer.
+    empty: usize,
+
+    /// Number of required streams holding exactly one message.
+    single: usize,
+
+    /// Positions picked by the last match plan, reused across matches.
+    picks: Vec<Option<usize>>,
+
+    /// Set when no group can form until the next push.
+    exhausted: bool,
+}
+
+impl<K, T> IndexedMatcher<K, T>
+where
+    K: Key,
+    T: WithTimestamp + Clone,
+{
+    /// Index a state for matching.
+    pub fn new(state: State<K, T>) -> Self {
+        let n = state.buffers.len();
+        let mut matcher = Self {
+            state,
+            heads: vec![Duration::ZERO; 2 * n.max(1)],
+            tails: vec![Duration::MAX; 2 * n.max(1)],
+            lens: vec![0; n],
+            required: 0,
+            empty: 0,
+            single: 0,
+            picks: Vec::with_capacity(n),
+            exhausted: false,
+        };
+        matcher.rebuild();
+        matcher
+    }
+
+    /// Get the indexed state.
+    pub fn state(&self) -> &State<K, T> {
+        &self.state
+    }
+
+    /// Modify the state, then rebuild the index in O(n).
+    ///
+    /// Use this for changes other than pushes, such as processing
+    /// staleness expiration or changing stream deadlines.
+    pub fn update<R>(&mut self, f: impl FnOnce(&mut State<K, T>) -> R) -> R {
+        let result = f(&mut self.state);
+        self.rebuild();
+        self.exhausted = false;
+        result
+    }
+
+    /// Unwrap the indexed state.
+    pub fn into_state(self) -> State<K, T> {
+        self.state
+    }
+
+    /// Insert a message with [State::push] and refresh its stream's
+    /// leaf in O(log n).
+    pub fn push(&mut self, key: K, item: T) -> Result<(), PushError<T>> {
+        let index = self.state.buffers.get_index_of(&key);
+        let result = self.state.push(key, item);
+        if let Some(index) = index {
+            self.refresh(index);
+        }
+        self.exhausted = false;
+        result
+    }
+
+    /// Take the messages evicted since the last call, as
+    /// [State::take_evictions].
+    pub fn take_evictions(&mut self) -> Vec<Eviction<K, T>> {
+        self.state.take_evictions()
+    }
+
+    /// Drain the messages evicted since the last call, as
+    /// [State::drain_evictions].
+    pub fn drain_evictions(&mut self) -> impl Iterator<Item = Eviction<K, T>> + '_ {
+        self.state.drain_evictions()
+    }
+
+    /// Try to match one group, following the state's
+    /// [match_policy](State::match_policy).
+    ///
+    /// On success `out` holds one entry per stream in buffer order, None
+    /// for optional streams left out of the group, and true is returned.
+    /// `out` is cleared and refilled, so its allocation is reused across
+    /// calls. On failure `out` is left untouched.
+    pub fn try_match_into(&mut self, out: &mut Vec<Option<T>>) -> bool {
+        if self.exhausted {
+            return false;
+        }
+        if !self.may_match() {
+            self.exhausted = true;
+            return false;
+        }
+
+        let matched = self.state.plan_match(&mut self.picks);
+        if matched {
+            out.clear();
+            out.resize(self.lens.len(), None);
+            self.state
+                .take_picks_with(&self.picks, |index, _, item| out[index] = Some(item));
+        }
+
+        // Matching touches the front of every stream, so the index is
+        // rebuilt rather than refreshed leaf by leaf
+        self.rebuild();
+        self.exhausted = !matched;
+        matched
+    }
+
+    /// Checks if every required buffer holds at least two messages, as
+    /// [State::is_ready].
+    pub fn is_ready(&self) -> bool {
+        self.empty == 0 && self.single == 0
+    }
+
+    /// Checks if any required buffer is empty, as [State::is_empty].
+    pub fn is_empty(&self) -> bool {
+        self.empty > 0
+    }
+
+    /// Checks if all required buffers hold exactly one message, as
+    /// [State::all_one].
+    pub fn all_one(&self) -> bool {
+        self.single == self.required
+    }
+
+    /// Gets the latest front timestamp among the required buffers, or None
+    /// if any of them is empty.
+    pub fn inf_timestamp(&self) -> Option<Duration> {
+        (self.empty == 0).then(|| self.heads[1])
+    }
+
+    /// Gets the earliest back timestamp among the required buffers, or
+    /// None if any of them is empty.
+    pub fn sup_timestamp(&self) -> Option<Duration> {
+        (self.empty == 0).then(|| self.tails[1])
+    }
+
+    /// Checks the condition every match policy tests before anything is
+    /// evicted. When it fails, [State::plan_match] would return without
+    /// touching the buffers.
+    fn may_match(&self) -> bool {
+        let (Some(inf_ts), Some(sup_ts)) = (self.inf_timestamp(), self.sup_timestamp()) else {
+            return false;
+        };
+
+        match self.state.match_policy {
+            MatchPolicy::Window => self
+                .state
+                .window_size
+                .is_none_or(|ws| self.all_one() || inf_ts.saturating_add(ws) <= sup_ts),
+            MatchPolicy::Approximate => sup_ts >= inf_ts,
+            MatchPolicy::Pivot(pivot) => self
+                .state
+                .buffers
+                .get_index(pivot)
+                .and_then(|(_, buffer)| buffer.front())
+                .is_some_and(|front| front.timestamp() <= sup_ts),
+        }
+    }
+
+    /// Recompute every leaf and inner node.
+    fn rebuild(&mut self) {
+        let n = self.lens.len();
+        self.required = 0;
+        self.empty = 0;
+        self.single = 0;
+
+        for (index, buffer) in self.state.buffers.values().enumerate() {
+            let leaf = n + index;
+            self.lens[index] = buffer.len();
+            if self.state.deadline(index).is_some() {
+                self.heads[leaf] = Duration::ZERO;
+                self.tails[leaf] = Duration::MAX;
+                continue;
+            }
+
+            self.required += 1;
+            match buffer.len() {
+                0 => self.empty += 1,
+                1 => self.single += 1,
+                _ => {}
+            }
+            self.heads[leaf] = buffer.front().map_or(Duration::ZERO, |m| m.timestamp());
+            self.tails[leaf] = buffer.back().map_or(Duration::MAX, |m| m.timestamp());
+        }
+
+        // Max and min are commutative, so the bottom-up tree needs no
+        // padding to a power of two: every leaf reaches the root once
+        for node in (1..n).rev() {
+            self.heads[node] = self.heads[2 * node].max(self.heads[2 * node + 1]);
+            self.tails[node] = self.tails[2 * node].min(self.tails[2 * node + 1]);
+        }
+    }
+
+    /// Refresh the leaf of one stream and its ancestors.
+    fn refresh(&mut self, index: usize) {
+        if self.state.deadline(index).is_some() {
+            self.lens[index] = self
+                .state
+                .buffers
+                .get_index(index)
+                .map_or(0, |(_, b)| b.len());
+            return;
+        }
+
+        let n = self.lens.len();
+        let (_, buffer) = self.state.buffers.get_index(index).unwrap();
+        let (len, head, tail) = (
+            buffer.len(),
+            buffer.front().map_or(Duration::ZERO, |m| m.timestamp()),
+            buffer.back().map_or(Duration::MAX, |m| m.timestamp()),
+        );
+        self.count(self.lens[index], -1);
+        self.count(len, 1);
+        self.lens[index] = len;
+
+        let mut node = n + index;
+        self.heads[node] = head;
+        self.tails[node] = tail;
+        while node > 1 {
+            node /= 2;
+            self.heads[node] = self.heads[2 * node].max(self.heads[2 * node + 1]);
+            self.tails[node] = self.tails[2 * node].min(self.tails[2 * node + 1]);
+        }
+    }
+
+    /// Add `delta` to the counter the buffer length falls in.
+    fn count(&mut self, len: usize, delta: isize) {
+        let counter = match len {
+            0 => &mut self.empty,
+            1 => &mut self.single,
+            _ => return,
+        };
+        *counter = counter.wrapping_add_signed(delta);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::{buffer::Buffer, config::DropPolicy};
+    use indexmap::IndexMap;
+    use std::sync::Arc;
+    use tokio::sync::Notify;
+
+    #[derive(Debug, Clone, PartialEq, Eq)]
+    struct TestMessage(Duration);
+
+    impl WithTimestamp for TestMessage {
+        fn timestamp(&self) -> Duration {
+            self.0
+        }
+    }
+
+    fn msg(timestamp_ms: u64) -> TestMessage {
+        TestMessage(Duration::from_millis(timestamp_ms))
+    }
+
+    fn create_test_state(
+        key_count: usize,
+        window_size_ms: u64,
+        match_policy: MatchPolicy,
+    ) -> State<usize, TestMessage> {
+        let buffers: IndexMap<_, _> = (0..key_count)
+            .map(|index| (index, Buffer::with_capacity(16)))
+            .collect();
+
+        State {
+            buffers,
+            commit_ts: None,
+            buf_size: 16,
+            window_size: Some(Duration::from_millis(window_size_ms)),
+            drop_policy: DropPolicy::DropOldest,
+            feedback_tx: None,
+            staleness_detector: None,
+            space_notify: Arc::new(Notify::new()),
+            evicted: None,
+            match_policy,
+            deadlines: Vec::new(),
+        }
+    }
+
+    /// Member timestamps of a group, indexed by stream.
+    type Group = Vec<Option<Duration>>;
+
+    /// Feed the same interleaved pushes to a plain state and a matcher,
+    /// polling after each one, and collect the groups by timestamp.
+    fn run_both(
+        key_count: usize,
+        match_policy: MatchPolicy,
+        optional: &[(usize, u64)],
+        pushes: &[(usize, u64)],
+    ) -> (Vec<Group>, Vec<Group>) {
+        let mut state = create_test_state(key_count, 50, match_policy);
+        state.deadlines = vec![None; key_count];
+        for &(index, deadline_ms) in optional {
+            state.deadlines[index] = Some(Duration::from_millis(deadline_ms));
+        }
+        let mut plain = create_test_state(key_count, 50, match_policy);
+        plain.deadlines = state.deadlines.clone();
+        let mut matcher = IndexedMatcher::new(state);
+
+        let mut expected = Vec::new();
+        let mut actual = Vec::new();
+        let mut out = Vec::new();
+        for &(index, ts) in pushes {
+            let plain_result = plain.push(index, msg(ts));
+            let result = matcher.push(index, msg(ts));
+            assert_eq!(plain_result.is_ok(), result.is_ok());
+            assert_eq!(plain.is_ready(), matcher.is_ready());
+            assert_eq!(plain.is_empty(), matcher.is_empty());
+
+            while let Some(group) = plain.try_match() {
+                expected.push(
+                    (0..key_count)
+                        .map(|index| group.get(&index).map(|m| m.0))
+                        .collect(),
+                );
+            }
+            while matcher.try_match_into(&mut out) {
+                actual.push(out.iter().map(|m| m.as_ref().map(|m| m.0)).collect());
+            }
+        }
+        (expected, actual)
+    }
+
+    /// Interleaved pushes of jittered streams at different rates.
+    fn jittered_pushes(key_count: usize) -> Vec<(usize, u64)> {
+        let mut pushes = Vec::new();
+        for tick in 0..200u64 {
+            for index in 0..key_count {
+                let period = 10 + 5 * index as u64;
+                if (tick * 10) % period == 0 {
+                    let jitter = (tick * 7 + index as u64 * 13) % 9;
+                    pushes.push((index, 1000 + tick * 10 + jitter));
+                }
+            }
+        }
+        pushes
+    }
+
+    #[test]
+    fn test_matcher_agrees_with_state_window() {
+        let pushes = jittered_pushes(5);
+        let (expected, actual) = run_both(5, MatchPolicy::Window, &[], &pushes);
+        assert!(!expected.is_empty());
+        assert_eq!(expected, actual);
+    }
+
+    #[test]
+    fn test_matcher_agrees_with_state_approximate() {
+        let pushes = jittered_pushes(5);
+        let (expected, actual) = run_both(5, MatchPolicy::Approximate, &[], &pushes);
+        assert!(!expected.is_empty());
+        assert_eq!(expected, actual);
+    }
+
+    #[test]
+    fn test_matcher_agrees_with_state_pivot() {
+        let pushes = jittered_pushes(5);
+        let (expected, actual) = run_both(5, MatchPolicy::Pivot(2), &[], &pushes);
+        assert!(!expected.is_empty());
+        assert_eq!(expected, actual);
+    }
+
+    #[test]
+    fn test_matcher_agrees_with_state_optional() {
+        // Stream 3 goes silent halfway through
+        let pushes: Vec<_> = jittered_pushes(4)
+            .into_iter()
+            .filter(|&(index, ts)| index != 3 || ts < 2000)
+            .collect();
+        let (expected, actual) = run_both(4, MatchPolicy::Window, &[(3, 30)], &pushes);
+        assert!(expected.iter().any(|group| group[3].is_none()));
+        assert_eq!(expected, actual);
+    }
+
+    #[test]
+    fn test_matcher_readiness() {
+        let mut matcher = IndexedMatcher::new(create_test_state(3, 50, MatchPolicy::Window));
+        assert!(matcher.is_empty());
+        assert!(!matcher.is_ready());
+        assert_eq!(matcher.inf_timestamp(), None);
+
+        matcher.push(0, msg(1010)).unwrap();
+        matcher.push(1, msg(1020)).unwrap();
+        assert!(matcher.is_empty());
+        matcher.push(2, msg(1005)).unwrap();
+        assert!(!matcher.is_empty());
+        assert!(matcher.all_one());
+        assert_eq!(matcher.inf_timestamp(), Some(Duration::from_millis(1020)));
+        assert_eq!(matcher.sup_timestamp(), Some(Duration::from_millis(1005)));
+
+        matcher.push(0, msg(1030)).unwrap();
+        matcher.push(1, msg(1040)).unwrap();
+        assert!(!matcher.is_ready());
+        matcher.push(2, msg(1025)).unwrap();
+        assert!(matcher.is_ready());
+        assert_eq!(matcher.sup_timestamp(), Some(Duration::from_millis(1025)));
+    }
+
+    #[test]
+    fn test_matcher_reuses_output() {
+        let mut matcher = IndexedMatcher::new(create_test_state(2, 50, MatchPolicy::Window));
+        let mut out = Vec::with_capacity(2);
+        let capacity = out.capacity();
+
+        for ts in [1000, 1100, 1200, 1300] {
+            matcher.push(0, msg(ts)).unwrap();
+            matcher.push(1, msg(ts + 3)).unwrap();
+        }
+
+        let mut groups = 0;
+        while matcher.try_match_into(&mut out) {
+            assert_eq!(out.len(), 2);
+            assert_eq!(out.capacity(), capacity);
+            groups += 1;
+        }
+        assert_eq!(groups, 4);
+        assert_eq!(out[0], Some(msg(1300)));
+        assert_eq!(out[1], Some(msg(1303)));
+    }
+
+    #[test]
+    fn test_matcher_exhausted_until_push() {
+        let mut matcher = IndexedMatcher::new(create_test_state(2, 50, MatchPolicy::Window));
+        let mut out = Vec::new();
+
+        matcher.push(0, msg(1000)).unwrap();
+        matcher.push(0, msg(1100)).unwrap();
+        matcher.push(1, msg(1010)).unwrap();
+        assert!(!matcher.try_match_into(&mut out));
+        assert!(matcher.exhausted);
+
+        // Later pushes clear the memo
+        matcher.push(1, msg(1110)).unwrap();
+        assert!(!matcher.exhausted);
+        assert!(matcher.try_match_into(&mut out));
+        assert_eq!(out, vec![Some(msg(1000)), Some(msg(1010))]);
+    }
+
+    #[test]
+    fn test_matcher_update_rebuilds() {
+        let mut matcher = IndexedMatcher::new(create_test_state(2, 50, MatchPolicy::Window));
+        matcher.push(0, msg(1000)).unwrap();
+        assert!(matcher.is_empty());
+
+        matcher.update(|state| state.deadlines = vec![None, Some(Duration::from_millis(10))]);
+        assert!(!matcher.is_empty());
+        assert!(matcher.all_one());
+        assert_eq!(matcher.inf_timestamp(), Some(Duration::from_millis(1000)));
+    }
+}
@@ -112,7 +112,6 @@ where
 {
     heap: BinaryHeap<StalenessEntry<K, T>>,
     config: StalenessConfig,
-    reference_time: Instant,
 }
 
 impl<K, T> ConstrainedHeap<K, T>
@@ -124,7 +123,6 @@ where
         Self {
             heap: BinaryHeap::with_capacity(config.heap_max_size),
             config,
-            reference_time: Instant::now(),
         }
     }
 
@@ -136,8 +134,9 @@ where
         message: T,
         staleness_timeout: Duration,
     ) -> Result<(), (K, T)> {
-        let expiration_time = self.reference_time + staleness_timeout;
+        // Timeouts count from the moment the message is added
         let now = Instant::now();
+        let expiration_time = now + staleness_timeout;
 
         // Check temporal constraint
         if expiration_time.saturating_duration_since(now) > self.config.heap_time_horizon {
@@ -1,6 +1,6 @@
 use crate::{
     buffer::Buffer,
-    config::DropPolicy,
+    config::{DropPolicy, MatchPolicy},
     staleness::StalenessDetector,
     types::{Feedback, Key, WithTimestamp},
 };
@@ -36,6 +36,31 @@ impl<T> PushError<T> {
     }
 }
 
+/// The reason a buffered message was discarded without being emitted.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum EvictionReason {
+    /// Dropped by [try_match](State::try_match) because it fell before
+    /// the time window, or was passed over for a closer message.
+    Window,
+    /// Evicted by [DropPolicy::DropOldest] to make room for a new message.
+    Overflow,
+    /// Expired by the staleness detector.
+    Stale,
+    /// Expired by its own [timeout](WithTimestamp::timeout).
+    Expired,
+    /// Dropped by [drop_min](State::drop_min) because no group could be
+    /// formed.
+    Unmatched,
+}
+
+/// A message discarded from a buffer, recorded in [State::evicted].
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct Eviction<K, T> {
+    pub key: K,
+    pub item: T,
+    pub reason: EvictionReason,
+}
+
 /// The internal state maintained by [sync](crate::sync).
 #[derive(Debug)]
 pub struct State<K, T>
@@ -69,6 +94,21 @@ where
     /// Notifier for signaling when buffer space becomes available.
     /// Used by push_blocking() to wait for space.
     pub space_notify: Arc<Notify>,
+
+    /// Messages discarded without being emitted. None disables
+    /// recording. The owner drains it with
+    /// [take_evictions](State::take_evictions) to release resources
+    /// attached to the messages.
+    pub evicted: Option<Vec<Eviction<K, T>>>,
+
+    /// Algorithm used by [try_match](State::try_match) to form groups.
+    pub match_policy: MatchPolicy,
+
+    /// Deadline of each optional stream, indexed like the buffers.
+    /// Streams with None, or past the end, are required. A group is only
+    /// formed once every required stream has a message; an optional stream
+    /// is left out once its deadline passes without a usable message.
+    pub deadlines: Vec<Option<Duration>>,
 }
 
 impl<K, T> State<K, T>
@@ -124,10 +164,71 @@ where
         }
     }
 
+    /// Check if the buffer at `index` has room for another message, as
+    /// reported in [Feedback::accepted_keys].
+    pub fn accepts(&self, index: usize) -> bool {
+        self.buffers
+            .get_index(index)
+            .is_some_and(|(_key, buffer)| buffer.len() < self.buf_size)
+    }
+
+    /// The timestamp a message for the buffer at `index` must be stamped
+    /// after to be accepted, or None if any timestamp is. Messages at or
+    /// before it are rejected as late or out of order.
+    pub fn accepted_after(&self, index: usize) -> Option<Duration> {
+        let last_ts = self
+            .buffers
+            .get_index(index)
+            .and_then(|(_key, buffer)| buffer.last_ts());
+        self.commit_ts.max(last_ts)
+    }
+
+    /// Raise the commit timestamp and the last timestamp of each buffer,
+    /// indexed like the buffers, e.g. when restoring a snapshot. Values
+    /// already past the given ones are kept, so an old message is never let
+    /// back in.
+    pub fn raise_watermarks(&mut self, commit_ts: Option<Duration>, last_ts: &[Option<Duration>]) {
+        self.commit_ts = self.commit_ts.max(commit_ts);
+        for (buffer, ts) in self.buffers.values_mut().zip(last_ts) {
+            if let Some(ts) = *ts {
+                buffer.raise_last_ts(ts);
+            }
+        }
+    }
+
+    /// Try to group up one message from each buffer, following the
+    /// [match_policy](State::match_policy).
+    pub fn try_match(&mut self) -> Option<IndexMap<K, T>> {
+        let mut picks = Vec::with_capacity(self.buffers.len());
+        if !self.plan_match(&mut picks) {
+            return None;
+        }
+
+        let mut items = IndexMap::with_capacity(picks.len());
+        self.take_picks_with(&picks, |_, key, item| {
+            items.insert(key.clone(), item);
+        });
+        Some(items)
+    }
+
+    /// Find the next group without taking it out of the buffers.
+    ///
+    /// Messages that can never join a group are evicted on the way. On
+    /// success `picks` holds the position of each stream's member, or None
+    /// for a stream left out, ready for [take_picks_with](State::take_picks_with).
+    pub(crate) fn plan_match(&mut self, picks: &mut Vec<Option<usize>>) -> bool {
+        picks.clear();
+        match self.match_policy {
+            MatchPolicy::Window => self.plan_window(picks).is_some(),
+            MatchPolicy::Approximate => self.plan_approximate(picks).is_some(),
+            MatchPolicy::Pivot(pivot) => self.plan_pivot(pivot, picks).is_some(),
+        }
+    }
+
     /// Try to group up messages within a time window.
     /// If window_size is None (infinite window), messages are matched
     /// without time-based dropping.
-    pub fn try_match(&mut self) -> Option<IndexMap<K, T>> {
+    fn plan_window(&mut self, picks: &mut Vec<Option<usize>>) -> Option<()> {
         let inf_ts = loop {
             let (_, inf_ts) = self.inf_timestamp()?;
 
@@ -146,8 +247,11 @@ where
                 let window_start = inf_ts.saturating_sub(window_size);
 
                 // Drop messages before the time window (only for finite window)
-                let dropped = self.buffers.values_mut().any(|buffer| {
-                    let count = buffer.drop_before(window_start);
+                let evicted = &mut self.evicted;
+                let dropped = self.buffers.iter_mut().any(|(key, buffer)| {
+                    let count = buffer.drop_before_with(window_start, |item| {
+                        record_eviction(evicted, key, item, EvictionReason::Window)
+                    });
                     count > 0
                 });
 
@@ -160,40 +264,332 @@ where
             }
         };
 
-        // Pop one message from each buffer
-        let items: IndexMap<_, _> = self
-            .buffers
-            .iter_mut()
-            .map(|(key, buffer)| {
-                let item = buffer.pop_front().unwrap();
-                // For finite window, verify message is within bounds
-                if let Some(window_size) = self.window_size {
-                    let window_end = inf_ts.saturating_add(window_size);
-                    assert!(item.timestamp() <= window_end);
+        // Take the front of each buffer. An optional stream joins if its
+        // front fits in the window, and is otherwise left out; an empty one
+        // is waited for until its deadline passes. The window is anchored
+        // at the earliest required front, so that the group's spread stays
+        // within window_size.
+        let earliest_ts = self
+            .required()
+            .filter_map(|(_, buffer)| Some(buffer.front()?.timestamp()))
+            .min()
+            .unwrap_or(inf_ts);
+        let window_end = self.window_size.map(|ws| earliest_ts.saturating_add(ws));
+        for (index, buffer) in self.buffers.values().enumerate() {
+            let fits = buffer
+                .front()
+                .map(|front| window_end.is_none_or(|end| front.timestamp() <= end));
+            let pick = match (self.deadline(index), fits) {
+                (None, fits) => {
+                    // Holds by the choice of inf_ts; should that ever
+                    // change, wait for more messages rather than panic
+                    // across the C ABI
+                    debug_assert_eq!(fits, Some(true));
+                    if fits != Some(true) {
+                        return None;
+                    }
+                    Some(0)
                 }
-                (key.clone(), item)
-            })
-            .collect();
+                (Some(_), Some(fits)) => fits.then_some(0),
+                (Some(deadline), None) => {
+                    if !self.deadline_passed(deadline, inf_ts) {
+                        return None;
+                    }
+                    None
+                }
+            };
+            picks.push(pick);
+        }
+
+        Some(())
+    }
+
+    /// Match around the latest front message with minimal spread.
+    ///
+    /// Every group must contain a message at or after the latest front
+    /// timestamp `ref_ts`, and no message older than the last one at or
+    /// before `ref_ts` can improve on it, so each stream only has two
+    /// candidates: the last message at or before `ref_ts` and the first one
+    /// after it. Once every stream holds a message at or after `ref_ts`,
+    /// the candidates are final and the best combination is emitted.
+    fn plan_approximate(&mut self, picks: &mut Vec<Option<usize>>) -> Option<()> {
+        loop {
+            let (_, ref_ts) = self.inf_timestamp()?;
+
+            // Position of each stream's first candidate after ref_ts, or None
+            // for an optional stream left out of the group. Distances are
+            // derived from it on demand, so matching allocates nothing.
+            picks.clear();
+            for (index, buffer) in self.buffers.values().enumerate() {
+                let deadline = self.deadline(index);
+                let Some((after, _)) = first_at_or_after(buffer, ref_ts) else {
+                    match deadline {
+                        Some(deadline) if self.deadline_passed(deadline, ref_ts) => {
+                            // Past the deadline the newest message is the
+                            // only candidate left, if it fits in the window
+                            let fits = buffer.back().is_some_and(|last| {
+                                self.window_size
+                                    .is_none_or(|ws| ref_ts - last.timestamp() <= ws)
+                            });
+                            picks.push(fits.then_some(buffer.len()));
+                            continue;
+                        }
+                        _ => return None,
+                    }
+                };
+                let (above, below) = self.candidate_distances(index, after, ref_ts);
+
+                // An optional stream with no candidate in the window sits out
+                if deadline.is_some()
+                    && let Some(window_size) = self.window_size
+                    && above > window_size
+                    && below.is_none_or(|below| below > window_size)
+                {
+                    picks.push(None);
+                    continue;
+                }
+                picks.push(Some(after));
+            }
+
+            // Take every candidate above ref_ts whose distance is at most
+            // `upper` and the others below it; try each distance as `upper`
+            let distances = || {
+                picks.iter().enumerate().filter_map(|(index, pick)| {
+                    pick.map(|after| self.candidate_distances(index, after, ref_ts))
+                })
+            };
+            let spread_for = |upper: Duration| {
+                distances()
+                    .filter(|(above, _)| *above > upper)
+                    .try_fold(upper, |spread, (_, below)| {
+                        below.map(|below| spread.max(upper + below))
+                    })
+            };
+            let upper = distances()
+                .map(|(above, _)| above)
+                .filter(|&above| above != Duration::MAX)
+                .filter_map(|upper| Some((spread_for(upper)?, upper)))
+                .min()
+                .map(|(_, upper)| upper)?;
+
+            for (index, pick) in picks.iter_mut().enumerate() {
+                if let Some(after) = pick
+                    && self.candidate_distances(index, *after, ref_ts).0 > upper
+                {
+                    *after -= 1;
+                }
+            }
+
+            if let Some(window_size) = self.window_size
+                && self.pick_spread(picks) > window_size
+            {
+                // No group around ref_ts fits; move on past the oldest front
+                self.drop_front_min(EvictionReason::Window);
+                continue;
+            }
+
+            return Some(());
+        }
+    }
+
+    /// Distances above and below `ref_ts` of a stream's candidates, given
+    /// the position of its first message after `ref_ts`. A position past
+    /// the end stands for a stream with only the message below.
+    fn candidate_distances(
+        &self,
+        index: usize,
+        after: usize,
+        ref_ts: Duration,
+    ) -> (Duration, Option<Duration>) {
+        let buffer = &self.buffers[index];
+        if after == buffer.len() {
+            return (
+                Duration::MAX,
+                Some(ref_ts - nth_timestamp(buffer, after - 1)),
+            );
+        }
+        let after_ts = nth_timestamp(buffer, after);
+        let below =
+            (after > 0 && after_ts > ref_ts).then(|| ref_ts - nth_timestamp(buffer, after - 1));
+        (after_ts - ref_ts, below)
+    }
+
+    /// Match the pivot stream's front message with the nearest message of
+    /// every other stream.
+    ///
+    /// Streams receive messages in timestamp order, so once a stream holds
+    /// a message at or after the pivot's, its nearest message is either
+    /// that one or the one before it, and later pushes cannot change that.
+    fn plan_pivot(&mut self, pivot: usize, picks: &mut Vec<Option<usize>>) -> Option<()> {
+        loop {
+            let pivot_ts = self.buffers.get_index(pivot)?.1.front()?.timestamp();
+
+            picks.clear();
+            for (index, buffer) in self.buffers.values().enumerate() {
+                if index == pivot {
+                    picks.push(Some(0));
+                    continue;
+                }
+
+                // Wait until a message at or after the pivot brackets it,
+                // or an optional stream's deadline passes
+                let deadline = self.deadline(index);
+                let Some((after, after_ts)) = first_at_or_after(buffer, pivot_ts) else {
+                    match deadline {
+                        Some(deadline) if self.deadline_passed(deadline, pivot_ts) => {
+                            // Past the deadline the newest message is the
+                            // nearest one, if it fits in the window
+                            let last = buffer.len().checked_sub(1).filter(|&last| {
+                                self.window_size
+                                    .is_none_or(|ws| pivot_ts - nth_timestamp(buffer, last) <= ws)
+                            });
+                            picks.push(last);
+                            continue;
+                        }
+                        _ => return None,
+                    }
+                };
+                let pick = if after > 0
+                    && pivot_ts - nth_timestamp(buffer, after - 1) <= after_ts - pivot_ts
+                {
+                    after - 1
+                } else {
+                    after
+                };
+
+                // An optional stream with no partner in the window sits out
+                let fits = self.window_size.is_none_or(|window_size| {
+                    nth_timestamp(buffer, pick).abs_diff(pivot_ts) <= window_size
+                });
+                picks.push((fits || deadline.is_none()).then_some(pick));
+            }
+
+            if let Some(window_size) = self.window_size {
+                let too_far = self
+                    .buffers
+                    .values()
+                    .zip(picks.iter())
+                    .any(|(buffer, pick)| {
+                        pick.is_some_and(|pick| {
+                            nth_timestamp(buffer, pick).abs_diff(pivot_ts) > window_size
+                        })
+                    });
+                if too_far {
+                    // The pivot message has no partner on some stream
+                    let (key, buffer) = self.buffers.get_index_mut(pivot)?;
+                    if let Some(item) = buffer.pop_front() {
+                        record_eviction(&mut self.evicted, key, item, EvictionReason::Unmatched);
+                    }
+                    continue;
+                }
+            }
+
+            return Some(());
+        }
+    }
+
+    /// Get the spread between the newest and oldest picked message.
+    fn pick_spread(&self, picks: &[Option<usize>]) -> Duration {
+        let timestamps = self
+            .buffers
+            .values()
+            .zip(picks)
+            .filter_map(|(buffer, pick)| Some(nth_timestamp(buffer, (*pick)?)));
+        let (min, max) = timestamps.fold((Duration::MAX, Duration::ZERO), |(min, max), ts| {
+            (min.min(ts), max.max(ts))
+        });
+        max.saturating_sub(min)
+    }
+
+    /// Drop the front message with the minimum timestamp.
+    fn drop_front_min(&mut self, reason: EvictionReason) {
+        let Some((key, _)) = self.min_timestamp() else {
+            return;
+        };
+        if let Some(item) = self
+            .buffers
+            .get_mut(&key)
+            .and_then(|buffer| buffer.pop_front())
+        {
+            record_eviction(&mut self.evicted, &key, item, reason);
+        }
+    }
 
-        // update commit timestamp
-        let new_commit_ts = items.values().map(|item| item.timestamp()).min().unwrap();
+    /// Emit the message at position `picks[i]` of each buffer `i` through
+    /// `emit` with its buffer index and key, dropping the messages before
+    /// it, and commit the group. Streams picked as None are left out of the
+    /// group.
+    pub(crate) fn take_picks_with<F>(&mut self, picks: &[Option<usize>], mut emit: F)
+    where
+        F: FnMut(usize, &K, T),
+    {
+        let evicted = &mut self.evicted;
+        let mut new_commit_ts: Option<Duration> = None;
+        for (index, ((key, buffer), &pick)) in self.buffers.iter_mut().zip(picks).enumerate() {
+            let Some(pick) = pick else {
+                continue;
+            };
+            for _ in 0..pick {
+                if let Some(item) = buffer.pop_front() {
+                    record_eviction(evicted, key, item, EvictionReason::Window);
+                }
+            }
+            let item = buffer.pop_front().unwrap();
+            let ts = item.timestamp();
+            new_commit_ts = Some(new_commit_ts.map_or(ts, |commit_ts| commit_ts.min(ts)));
+            emit(index, key, item);
+        }
+        let new_commit_ts = new_commit_ts.unwrap();
         self.commit_ts = Some(new_commit_ts);
 
+        // Messages of left-out streams before the commit timestamp could
+        // only join a group older than this one
+        for ((key, buffer), pick) in self.buffers.iter_mut().zip(picks) {
+            if pick.is_none() {
+                buffer.drop_before_with(new_commit_ts, |item| {
+                    record_eviction(evicted, key, item, EvictionReason::Window)
+                });
+            }
+        }
+
         // Notify waiters that buffer space is now available
         self.space_notify.notify_waiters();
+    }
 
-        Some(items)
+    /// Gets the deadline of the stream at a buffer index, or None if the
+    /// stream is required.
+    pub fn deadline(&self, index: usize) -> Option<Duration> {
+        self.deadlines.get(index).copied().flatten()
+    }
+
+    /// Iterates over the buffers of the required streams.
+    fn required(&self) -> impl Iterator<Item = (&K, &Buffer<T>)> {
+        self.buffers
+            .iter()
+            .enumerate()
+            .filter(|&(index, _)| self.deadline(index).is_none())
+            .map(|(_, entry)| entry)
     }
 
-    /// Gets the minimum of the maximum timestamps from each buffer.
-    /// Returns None if any buffer is empty.
+    /// Checks whether an optional stream has waited `deadline` for a
+    /// group at `ref_ts`, i.e. the newest buffered message is at least
+    /// that far past it.
+    fn deadline_passed(&self, deadline: Duration, ref_ts: Duration) -> bool {
+        self.buffers
+            .values()
+            .filter_map(|buffer| Some(buffer.back()?.timestamp()))
+            .max()
+            .is_some_and(|newest| newest >= ref_ts.saturating_add(deadline))
+    }
+
+    /// Gets the minimum of the maximum timestamps from each required
+    /// buffer. Returns None if any required buffer is empty.
     pub fn sup_timestamp(&self) -> Option<(K, Duration)> {
         // First check all buffers have messages
-        if self.buffers.values().any(|b| b.is_empty()) {
+        if self.required().any(|(_, b)| b.is_empty()) {
             return None;
         }
-        self.buffers
-            .iter()
+        self.required()
             .filter_map(|(key, buffer)| {
                 // Get the latest timestamp
                 let ts = buffer.back()?.timestamp();
@@ -202,15 +598,14 @@ where
             .min_by_key(|(_, ts)| *ts)
     }
 
-    /// Gets the maximum of the minimum timestamps from each buffer.
-    /// Returns None if any buffer is empty.
+    /// Gets the maximum of the minimum timestamps from each required
+    /// buffer. Returns None if any required buffer is empty.
     pub fn inf_timestamp(&self) -> Option<(K, Duration)> {
         // First check all buffers have messages
-        if self.buffers.values().any(|b| b.is_empty()) {
+        if self.required().any(|(_, b)| b.is_empty()) {
             return None;
         }
-        self.buffers
-            .iter()
+        self.required()
             .filter_map(|(key, buffer)| {
                 // Get the earliest timestamp
                 let ts = buffer.front()?.timestamp();
@@ -231,22 +626,21 @@ where
             .min_by_key(|(_, ts)| *ts)
     }
 
-    /// Checks if every buffer size reaches the limit.
+    /// Checks if every required buffer size reaches the limit.
     pub fn is_full(&self) -> bool {
-        self.buffers
-            .values()
-            .all(|buffer| buffer.len() >= self.buf_size)
+        self.required()
+            .all(|(_, buffer)| buffer.len() >= self.buf_size)
     }
 
-    /// Checks if every buffer receives at least two messages.
+    /// Checks if every required buffer receives at least two messages.
     pub fn is_ready(&self) -> bool {
-        self.buffers.values().all(|buffer| buffer.len() >= 2)
+        self.required().all(|(_, buffer)| buffer.len() >= 2)
     }
 
-    /// Checks if there are buffers which are empty.
+    /// Checks if there are required buffers which are empty.
     pub fn is_empty(&self) -> bool {
         // self.buffers.values().all(|buffer| buffer.is_empty())
-        let buffers = self.buffers.iter();
+        let buffers = self.required();
         for item in buffers {
             let (_key, buffer) = item;
             if buffer.is_empty() {
@@ -258,9 +652,9 @@ where
         false
     }
 
-    /// Checks if all buffers have only one data left.
+    /// Checks if all required buffers have only one data left.
     pub fn all_one(&self) -> bool {
-        self.buffers.values().all(|buffer| buffer.len() == 1)
+        self.required().all(|(_, buffer)| buffer.len() == 1)
     }
     /// Remove the message with the minimum timestamp among all
     /// buffers. Returns true if a message is dropped.
@@ -269,11 +663,13 @@ where
             return false;
         };
 
-        self.buffers.values_mut().for_each(|buffer| {
+        let evicted = &mut self.evicted;
+        self.buffers.iter_mut().for_each(|(key, buffer)| {
             if let Some(front) = buffer.front()
                 && front.timestamp() == min_ts
+                && let Some(item) = buffer.pop_front()
             {
-                buffer.pop_front();
+                record_eviction(evicted, key, item, EvictionReason::Unmatched);
             }
         });
 
@@ -283,12 +679,35 @@ where
     /// Drop expired messages from all buffers based on reference timestamp.
     /// Returns the total number of dropped messages.
     pub fn drop_expired_messages(&mut self, reference_timestamp: Duration) -> usize {
+        let evicted = &mut self.evicted;
         self.buffers
-            .values_mut()
-            .map(|buffer| buffer.drop_expired(reference_timestamp))
+            .iter_mut()
+            .map(|(key, buffer)| {
+                buffer.drop_expired_with(reference_timestamp, |item| {
+                    record_eviction(evicted, key, item, EvictionReason::Expired)
+                })
+            })
             .sum()
     }
 
+    /// Take the messages evicted since the last call. Returns an empty
+    /// vector if recording is disabled.
+    pub fn take_evictions(&mut self) -> Vec<Eviction<K, T>> {
+        match &mut self.evicted {
+            Some(evicted) => std::mem::take(evicted),
+            None => Vec::new(),
+        }
+    }
+
+    /// Drain the messages evicted since the last call, keeping the
+    /// recording vector's allocation for the next ones. Yields nothing if
+    /// recording is disabled.
+    pub fn drain_evictions(&mut self) -> impl Iterator<Item = Eviction<K, T>> + '_ {
+        self.evicted
+            .iter_mut()
+            .flat_map(|evicted| evicted.drain(..))
+    }
+
     /// Insert a message to the queue identified by the key.
     /// Returns Ok(()) on success, or a PushError on failure.
     pub fn push(&mut self, key: K, item: T) -> Result<(), PushError<T>> {
@@ -312,7 +731,9 @@ where
                     return Err(PushError::BufferFull(item));
                 }
                 DropPolicy::DropOldest => {
-                    buffer.pop_front();
+                    if let Some(oldest) = buffer.pop_front() {
+                        record_eviction(&mut self.evicted, &key, oldest, EvictionReason::Overflow);
+                    }
                 }
             }
         }
@@ -399,8 +820,9 @@ where
                     // This is a limitation of the current buffer implementation
                     if let Some(front_msg) = buffer.front()
                         && front_msg.timestamp() == expired_message.timestamp()
+                        && let Some(item) = buffer.pop_front()
                     {
-                        buffer.pop_front();
+                        record_eviction(&mut self.evicted, &key, item, EvictionReason::Stale);
                         removed_count += 1;
                     }
                 }
@@ -413,6 +835,42 @@ where
     }
 }
 
+/// Find the first message at or after `ts`, returning its position and
+/// timestamp.
+fn first_at_or_after<T>(buffer: &Buffer<T>, ts: Duration) -> Option<(usize, Duration)>
+where
+    T: WithTimestamp,
+{
+    let index = buffer.lower_bound(ts);
+    Some((index, buffer.timestamp(index)?))
+}
+
+/// Get the timestamp of the message at position `index`.
+fn nth_timestamp<T>(buffer: &Buffer<T>, index: usize) -> Duration
+where
+    T: WithTimestamp,
+{
+    buffer.timestamp(index).unwrap()
+}
+
+/// Append an eviction record if recording is enabled.
+fn record_eviction<K, T>(
+    evicted: &mut Option<Vec<Eviction<K, T>>>,
+    key: &K,
+    item: T,
+    reason: EvictionReason,
+) where
+    K: Clone,
+{
+    if let Some(evicted) = evicted {
+        evicted.push(Eviction {
+            key: key.clone(),
+            item,
+            reason,
+        });
+    }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -459,6 +917,9 @@ mod tests {
             feedback_tx: None,
             staleness_detector: None,
             space_notify: Arc::new(Notify::new()),
+            evicted: None,
+            match_policy: MatchPolicy::Window,
+            deadlines: Vec::new(),
         }
     }
 
@@ -480,6 +941,9 @@ mod tests {
             feedback_tx: None,
             staleness_detector: None,
             space_notify: Arc::new(Notify::new()),
+            evicted: None,
+            match_policy: MatchPolicy::Window,
+            deadlines: Vec::new(),
         }
     }
 
@@ -497,6 +961,9 @@ mod tests {
             feedback_tx: None,
             staleness_detector: None,
             space_notify: Arc::new(Notify::new()),
+            evicted: None,
+            match_policy: MatchPolicy::Window,
+            deadlines: Vec::new(),
         }
     }
 
@@ -727,6 +1194,9 @@ mod tests {
             feedback_tx: None,
             staleness_detector: None,
             space_notify: Arc::new(Notify::new()),
+            evicted: None,
+            match_policy: MatchPolicy::Window,
+            deadlines: Vec::new(),
         }
     }
 
@@ -880,6 +1350,308 @@ mod tests {
         assert!(state.push("A", create_message(1700)).is_ok());
     }
 
+    #[test]
+    fn test_drop_oldest_records_eviction() {
+        let mut state = create_test_state_with_policy(2, 100, DropPolicy::DropOldest);
+        state.evicted = Some(Vec::new());
+
+        for ts in [1500, 1600, 1700] {
+            state.push("A", create_message(ts)).unwrap();
+        }
+
+        let evictions = state.take_evictions();
+        assert_eq!(evictions.len(), 1);
+        assert_eq!(evictions[0].key, "A");
+        assert_eq!(evictions[0].item.timestamp(), Duration::from_millis(1500));
+        assert_eq!(evictions[0].reason, EvictionReason::Overflow);
+        assert!(state.take_evictions().is_empty());
+    }
+
+    #[test]
+    fn test_try_match_records_window_evictions() {
+        let mut state = create_test_state(10, 100);
+        state.evicted = Some(Vec::new());
+
+        state.push("A", create_message(1500)).unwrap();
+        state.push("A", create_message(2010)).unwrap();
+        state.push("A", create_message(2200)).unwrap();
+        state.push("B", create_message(2000)).unwrap();
+        state.push("B", create_message(2200)).unwrap();
+
+        let group = state.try_match().unwrap();
+        assert_eq!(group["A"].timestamp(), Duration::from_millis(2010));
+
+        let evictions = state.take_evictions();
+        assert_eq!(evictions.len(), 1);
+        assert_eq!(evictions[0].key, "A");
+        assert_eq!(evictions[0].item.timestamp(), Duration::from_millis(1500));
+        assert_eq!(evictions[0].reason, EvictionReason::Window);
+    }
+
+    #[test]
+    fn test_drain_evictions_keeps_allocation() {
+        let mut state = create_test_state_with_policy(2, 100, DropPolicy::DropOldest);
+        state.evicted = Some(Vec::with_capacity(4));
+
+        for ts in [1500, 1600, 1700, 1800] {
+            state.push("A", create_message(ts)).unwrap();
+        }
+
+        let drained: Vec<_> = state
+            .drain_evictions()
+            .map(|e| e.item.timestamp())
+            .collect();
+        assert_eq!(
+            drained,
+            vec![Duration::from_millis(1500), Duration::from_millis(1600)]
+        );
+        let evicted = state.evicted.as_ref().unwrap();
+        assert!(evicted.is_empty());
+        assert_eq!(evicted.capacity(), 4);
+    }
+
+    #[test]
+    fn test_evictions_not_recorded_when_disabled() {
+        let mut state = create_test_state_with_policy(2, 100, DropPolicy::DropOldest);
+
+        for ts in [1500, 1600, 1700] {
+            state.push("A", create_message(ts)).unwrap();
+        }
+
+        assert!(state.evicted.is_none());
+        assert!(state.take_evictions().is_empty());
+    }
+
+    // ============================================
+    // Match Policy Tests
+    // ============================================
+
+    #[test]
+    fn test_approximate_matches_nearest_without_full_window() {
+        let mut state = create_test_state(10, 100);
+        state.match_policy = MatchPolicy::Approximate;
+        state.evicted = Some(Vec::new());
+
+        state.push("A", create_message(2000)).unwrap();
+        state.push("B", create_message(2040)).unwrap();
+        assert!(state.try_match().is_none());
+
+        // Every stream now holds a message at or after 2040
+        state.push("A", create_message(2100)).unwrap();
+        state.push("B", create_message(2090)).unwrap();
+
+        let group = state.try_match().unwrap();
+        assert_eq!(group["A"].timestamp(), Duration::from_millis(2000));
+        assert_eq!(group["B"].timestamp(), Duration::from_millis(2040));
+        assert!(state.take_evictions().is_empty());
+
+        // B has nothing at or after 2100 yet
+        assert!(state.try_match().is_none());
+        state.push("B", create_message(2120)).unwrap();
+
+        let group = state.try_match().unwrap();
+        assert_eq!(group["A"].timestamp(), Duration::from_millis(2100));
+        assert_eq!(group["B"].timestamp(), Duration::from_millis(2090));
+
+        let evictions = state.take_evictions();
+        assert!(evictions.is_empty());
+        assert_eq!(state.buffers["B"].len(), 1);
+    }
+
+    #[test]
+    fn test_approximate_drops_messages_outside_window() {
+        let mut state = create_test_state(10, 100);
+        state.match_policy = MatchPolicy::Approximate;
+        state.evicted = Some(Vec::new());
+
+        state.push("A", create_message(2000)).unwrap();
+        state.push("A", create_message(2600)).unwrap();
+        state.push("B", create_message(2450)).unwrap();
+        state.push("B", create_message(2650)).unwrap();
+
+        let group = state.try_match().unwrap();
+        assert_eq!(group["A"].timestamp(), Duration::from_millis(2600));
+        assert_eq!(group["B"].timestamp(), Duration::from_millis(2650));
+
+        let evictions = state.take_evictions();
+        assert_eq!(evictions.len(), 2);
+        assert!(evictions.iter().all(|e| e.reason == EvictionReason::Window));
+    }
+
+    #[test]
+    fn test_pivot_matches_nearest_once_bracketed() {
+        let mut state = create_test_state(10, 100);
+        state.match_policy = MatchPolicy::Pivot(0);
+        state.evicted = Some(Vec::new());
+
+        state.push("A", create_message(2000)).unwrap();
+        state.push("B", create_message(1960)).unwrap();
+        assert!(state.try_match().is_none());
+
+        state.push("B", create_message(2030)).unwrap();
+        let group = state.try_match().unwrap();
+        assert_eq!(group["A"].timestamp(), Duration::from_millis(2000));
+        assert_eq!(group["B"].timestamp(), Duration::from_millis(2030));
+
+        let evictions = state.take_evictions();
+        assert_eq!(evictions.len(), 1);
+        assert_eq!(evictions[0].key, "B");
+        assert_eq!(evictions[0].reason, EvictionReason::Window);
+    }
+
+    #[test]
+    fn test_pivot_drops_unmatched_pivot_message() {
+        let mut state = create_test_state(10, 100);
+        state.match_policy = MatchPolicy::Pivot(0);
+        state.evicted = Some(Vec::new());
+
+        state.push("A", create_message(1500)).unwrap();
+        state.push("A", create_message(1690)).unwrap();
+        state.push("B", create_message(1700)).unwrap();
+
+        // Nothing on B lies within 100ms of 1500
+        let group = state.try_match().unwrap();
+        assert_eq!(group["A"].timestamp(), Duration::from_millis(1690));
+        assert_eq!(group["B"].timestamp(), Duration::from_millis(1700));
+
+        let evictions = state.take_evictions();
+        assert_eq!(evictions.len(), 1);
+        assert_eq!(evictions[0].key, "A");
+        assert_eq!(evictions[0].reason, EvictionReason::Unmatched);
+    }
+
+    // ============================================
+    // Optional Stream Tests
+    // ============================================
+
+    #[test]
+    fn test_optional_stream_left_out_after_deadline() {
+        let mut state = create_test_state(10, 100);
+        state.deadlines = vec![None, Some(Duration::from_millis(50))];
+
+        state.push("A", create_message(2000)).unwrap();
+
+        // Within B's deadline the group keeps waiting
+        state.push("A", create_message(2040)).unwrap();
+        assert!(state.try_match().is_none());
+
+        state.push("A", create_message(2100)).unwrap();
+        let group = state.try_match().unwrap();
+        assert_eq!(group.len(), 1);
+        assert_eq!(group["A"].timestamp(), Duration::from_millis(2000));
+        assert!(!group.contains_key("B"));
+    }
+
+    #[test]
+    fn test_optional_stream_joins_when_present() {
+        let mut state = create_test_state(10, 100);
+        state.deadlines = vec![None, Some(Duration::from_millis(50))];
+
+        state.push("A", create_message(2000)).unwrap();
+        state.push("B", create_message(2010)).unwrap();
+        state.push("A", create_message(2100)).unwrap();
+
+        let group = state.try_match().unwrap();
+        assert_eq!(group.len(), 2);
+        assert_eq!(group["B"].timestamp(), Duration::from_millis(2010));
+    }
+
+    #[test]
+    fn test_optional_stream_resuming_later_is_left_out() {
+        let mut state = create_test_state(10, 100);
+        state.deadlines = vec![None, Some(Duration::from_millis(50))];
+
+        state.push("A", create_message(2000)).unwrap();
+        state.push("A", create_message(2100)).unwrap();
+        state.push("B", create_message(2500)).unwrap();
+
+        // B's front is far past the group, so it does not pull A forward
+        let group = state.try_match().unwrap();
+        assert_eq!(group.len(), 1);
+        assert_eq!(group["A"].timestamp(), Duration::from_millis(2000));
+        assert_eq!(state.buffers["B"].len(), 1);
+    }
+
+    #[test]
+    fn test_optional_stream_stays_within_window_of_earliest_front() {
+        let mut state = create_test_state(10, 100);
+        state.buffers.insert("C", Buffer::with_capacity(10));
+        state.deadlines = vec![None, None, Some(Duration::from_millis(50))];
+
+        state.push("A", create_message(2000)).unwrap();
+        state.push("B", create_message(2090)).unwrap();
+        state.push("C", create_message(2150)).unwrap();
+        state.push("A", create_message(2200)).unwrap();
+        state.push("B", create_message(2250)).unwrap();
+
+        // C lies within the window after B's front, but 150ms after A's
+        let group = state.try_match().unwrap();
+        assert_eq!(group.len(), 2);
+        assert_eq!(group["A"].timestamp(), Duration::from_millis(2000));
+        assert_eq!(group["B"].timestamp(), Duration::from_millis(2090));
+        assert!(!group.contains_key("C"));
+        assert_eq!(state.buffers["C"].len(), 1);
+    }
+
+    #[test]
+    fn test_required_stream_still_blocks() {
+        let mut state = create_test_state(10, 100);
+        state.deadlines = vec![Some(Duration::from_millis(50)), None];
+
+        for ts in [2000, 2100, 2200] {
+            state.push("A", create_message(ts)).unwrap();
+        }
+        assert!(state.is_empty());
+        assert!(state.try_match().is_none());
+    }
+
+    #[test]
+    fn test_optional_stream_with_pivot_policy() {
+        let mut state = create_test_state(10, 100);
+        state.match_policy = MatchPolicy::Pivot(0);
+        state.deadlines = vec![None, Some(Duration::from_millis(50))];
+        state.evicted = Some(Vec::new());
+
+        state.push("A", create_message(2000)).unwrap();
+        state.push("B", create_message(1950)).unwrap();
+        assert!(state.try_match().is_none());
+
+        state.push("A", create_message(2060)).unwrap();
+        let group = state.try_match().unwrap();
+        assert_eq!(group.len(), 2);
+        assert_eq!(group["B"].timestamp(), Duration::from_millis(1950));
+
+        // B has nothing left near 2060 once the deadline passes
+        assert!(state.try_match().is_none());
+        state.push("A", create_message(2120)).unwrap();
+        let group = state.try_match().unwrap();
+        assert_eq!(group.len(), 1);
+        assert_eq!(group["A"].timestamp(), Duration::from_millis(2060));
+        assert!(state.take_evictions().is_empty());
+    }
+
+    #[test]
+    fn test_optional_stream_with_approximate_policy() {
+        let mut state = create_test_state(10, 100);
+        state.match_policy = MatchPolicy::Approximate;
+        state.deadlines = vec![None, Some(Duration::from_millis(50))];
+        state.evicted = Some(Vec::new());
+
+        state.push("B", create_message(1500)).unwrap();
+        state.push("A", create_message(2000)).unwrap();
+        state.push("A", create_message(2060)).unwrap();
+
+        // B's only message is long before the group and is dropped with it
+        let group = state.try_match().unwrap();
+        assert_eq!(group.len(), 1);
+        assert_eq!(group["A"].timestamp(), Duration::from_millis(2000));
+        assert!(state.buffers["B"].is_empty());
+
+        let evictions = state.take_evictions();
+        assert_eq!(evictions.len(), 1);
+        assert_eq!(evictions[0].key, "B");
+    }
+
     // ============================================
     // Infinite Window Tests
     // ============================================
@@ -1167,4 +1939,59 @@ mod tests {
             "try_match should notify waiters"
         );
     }
+
+    #[test]
+    fn test_feedback_accessors() {
+        let mut state = create_test_state(2, 100);
+
+        // Nothing pushed: only the commit timestamp bounds new messages
+        assert!(state.accepts(0));
+        assert_eq!(state.accepted_after(0), Some(Duration::from_millis(1000)));
+
+        state.push("A", create_message(1500)).unwrap();
+        state.push("A", create_message(1700)).unwrap();
+        state.push("B", create_message(1510)).unwrap();
+
+        assert!(!state.accepts(0));
+        assert!(state.accepts(1));
+        assert!(!state.accepts(2));
+        assert_eq!(state.accepted_after(0), Some(Duration::from_millis(1700)));
+        assert_eq!(state.accepted_after(1), Some(Duration::from_millis(1510)));
+
+        // The last timestamp still applies once the message is emitted
+        state.push("B", create_message(1710)).unwrap();
+        assert!(state.try_match().is_some());
+        assert!(state.accepts(0));
+        assert!(state.accepts(1));
+        assert_eq!(state.accepted_after(1), Some(Duration::from_millis(1710)));
+    }
+
+    #[test]
+    fn test_raise_watermarks() {
+        let mut state = create_test_state(4, 100);
+        state.push("B", create_message(1800)).unwrap();
+
+        state.raise_watermarks(
+            Some(Duration::from_millis(1500)),
+            &[
+                Some(Duration::from_millis(1600)),
+                Some(Duration::from_millis(1700)),
+            ],
+        );
+        assert_eq!(state.commit_ts, Some(Duration::from_millis(1500)));
+        assert!(matches!(
+            state.push("A", create_message(1500)),
+            Err(PushError::LateMessage(_))
+        ));
+        assert!(matches!(
+            state.push("A", create_message(1550)),
+            Err(PushError::OutOfOrder(_))
+        ));
+        state.push("A", create_message(1650)).unwrap();
+
+        // Never lowered
+        state.raise_watermarks(Some(Duration::from_millis(1200)), &[None, None]);
+        assert_eq!(state.commit_ts, Some(Duration::from_millis(1500)));
+        assert_eq!(state.accepted_after(1), Some(Duration::from_millis(1800)));
+    }
 }
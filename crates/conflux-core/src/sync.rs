@@ -1,5 +1,5 @@
 use crate::{
-    Config, Feedback,
+    Config, Feedback, MatchPolicy,
     buffer::Buffer,
     staleness::StalenessDetector,
     state::State,
@@ -45,6 +45,8 @@ where
         buf_size,
         drop_policy,
         staleness_config,
+        match_policy,
+        optional,
     } = config;
 
     // Sanity check
@@ -63,6 +65,17 @@ where
         })
         .collect();
     ensure!(!buffers.is_empty());
+
+    // Mark optional streams; one must remain required to anchor groups
+    let mut deadlines = vec![None; buffers.len()];
+    for (index, deadline) in optional {
+        ensure!(index < buffers.len());
+        deadlines[index] = Some(deadline);
+    }
+    ensure!(deadlines.iter().any(Option::is_none));
+    if let MatchPolicy::Pivot(pivot) = match_policy {
+        ensure!(pivot < buffers.len() && deadlines[pivot].is_none());
+    }
     // println!("the buffer is shown as below \n {buffers:#?}");
 
     // Create the queue that pipes generated feedback messages.
@@ -88,6 +101,9 @@ where
         drop_policy,
         staleness_detector,
         space_notify: Arc::new(Notify::new()),
+        evicted: None,
+        match_policy,
+        deadlines,
     };
 
     // Construct output stream.
@@ -373,4 +389,47 @@ mod tests {
         let result = sync(empty_stream, keys, config);
         assert!(result.is_ok());
     }
+
+    #[tokio::test]
+    async fn test_config_all_streams_optional() {
+        let config = Config::basic(Some(Duration::from_millis(100)), None, 4)
+            .with_optional(0, Duration::from_millis(50))
+            .with_optional(1, Duration::from_millis(50));
+
+        let empty_stream = stream::empty::<eyre::Result<(&str, TestMessage)>>();
+        let keys = ["A", "B"];
+
+        let result = sync(empty_stream, keys, config);
+        assert!(result.is_err());
+    }
+
+    #[tokio::test]
+    async fn test_optional_stream_outage() {
+        let config = Config::basic(Some(Duration::from_millis(50)), None, 8)
+            .with_optional(1, Duration::from_millis(100));
+
+        // B drops out after its third message
+        let messages: Vec<_> = (0..10u64)
+            .flat_map(|i| {
+                let message = |data: &str| TestMessage {
+                    timestamp: Duration::from_millis(1000 + i * 100),
+                    data: data.to_string(),
+                };
+                let a = Some(Ok(("A", message("a"))));
+                let b = (i < 3).then(|| Ok(("B", message("b"))));
+                a.into_iter().chain(b)
+            })
+            .collect();
+
+        let (output, _feedback) = sync(stream::iter(messages), ["A", "B"], config).unwrap();
+        let groups: Vec<_> = output.map(|group| group.unwrap()).collect().await;
+
+        assert!(groups.len() >= 8);
+        assert!(groups[..3].iter().all(|group| group.len() == 2));
+        assert!(
+            groups[3..]
+                .iter()
+                .all(|group| group.len() == 1 && group.contains_key("A"))
+        );
+    }
 }